@@ -25,6 +25,8 @@
 #include <string.h>
 #include <math.h>
 #include <assert.h>
+#include <algorithm>
+#include <vector>
 
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
@@ -197,6 +199,14 @@ static bool stl_read(stl_file *stl, FILE *fp, int first_facet, bool first, Impor
 
   	char normal_buf[3][32];
 
+	// Binary facets are read in blocks of BINARY_BLOCK_FACETS to avoid one fread() call per 50 byte record.
+	static constexpr uint32_t BINARY_BLOCK_FACETS = 8192;
+	std::vector<char> block;
+	const char *block_ptr = nullptr;
+	const char *block_end = nullptr;
+	if (stl->stats.type == binary)
+		block.assign(size_t(BINARY_BLOCK_FACETS) * SIZEOF_STL_FACET, 0);
+
 	uint32_t facets_num = stl->stats.number_of_facets;
 	uint32_t unit = facets_num / LOAD_STL_UNIT_NUM + 1;
     for (uint32_t i = first_facet; i < facets_num; ++ i) {
@@ -215,8 +225,15 @@ static bool stl_read(stl_file *stl, FILE *fp, int first_facet, bool first, Impor
   
 
       		// Read a single facet from a binary .STL file. We assume little-endian architecture!
-      		if (fread(&facet, 1, SIZEOF_STL_FACET, fp) != SIZEOF_STL_FACET)
-      			return false;
+      		if (block_ptr == block_end) {
+      			size_t to_read = size_t(std::min(BINARY_BLOCK_FACETS, facets_num - i)) * SIZEOF_STL_FACET;
+      			if (fread(block.data(), 1, to_read, fp) != to_read)
+      				return false;
+      			block_ptr = block.data();
+      			block_end = block_ptr + to_read;
+      		}
+      		memcpy(&facet, block_ptr, SIZEOF_STL_FACET);
+      		block_ptr += SIZEOF_STL_FACET;
 
 
 #if BOOST_ENDIAN_BIG_BYTE
@@ -69,6 +69,8 @@ class _Item {
         Box bb; bool valid;
         BBCache(): valid(false) {}
     } bb_cache_;
+    mutable size_t shape_hash_ = 0;
+    mutable bool shape_hash_valid_ = false;
 
     int binid_{BIN_ID_UNSET}, priority_{0};
     bool fixed_{false};
@@ -316,6 +318,11 @@ public:
         return inflation_;
     }
 
+    /// The inflation applied to the raw shape, zero if not inflated.
+    inline Coord appliedInflation() const BP2D_NOEXCEPT {
+        return has_inflation_ ? inflation_ : Coord(0);
+    }
+
     inline void inflate(Coord distance) BP2D_NOEXCEPT
     {
         inflation(inflation() + distance);
@@ -394,6 +401,35 @@ public:
         return {bb.minCorner() + tr, bb.maxCorner() + tr };
     }
 
+    /**
+     * @brief Hash of the carried shape and of its inflation.
+     *
+     * Items with equal hashes and rotations have the same transformed shape up
+     * to their translation. The result is cached, subsequent calls will have
+     * very little cost.
+     */
+    inline size_t shapeHash() const {
+        if(!shape_hash_valid_) {
+            size_t h = std::hash<Coord>()(appliedInflation());
+            auto combine = [&h](Coord c) {
+                h ^= std::hash<Coord>()(c) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            };
+            auto combine_path = [&combine](auto from, auto to) {
+                combine(Coord(to - from));
+                for(auto it = from; it != to; ++it) {
+                    combine(getX(*it));
+                    combine(getY(*it));
+                }
+            };
+            combine_path(sl::cbegin(sh_), sl::cend(sh_));
+            for(auto& hole : sl::holes(sh_))
+                combine_path(hole.begin(), hole.end());
+            shape_hash_ = h;
+            shape_hash_valid_ = true;
+        }
+        return shape_hash_;
+    }
+
     inline Vertex referenceVertex() const {
         return rightmostTopVertex();
     }
@@ -452,6 +488,7 @@ private:
         inflate_cache_valid_ = false;
         bb_cache_.valid = false;
         convexity_ = Convexity::UNCHECKED;
+        shape_hash_valid_ = false;
     }
 
     static inline bool vsort(const Vertex& v1, const Vertex& v2)
@@ -8,6 +8,8 @@
 #include <iterator>
 #include <future>
 #include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 #ifndef NDEBUG
 #include <iostream>
@@ -26,6 +28,138 @@
 namespace libnest2d {
 namespace placers {
 
+/**
+ * @brief Cache of the no-fit polygons of pairs of items.
+ *
+ * The no-fit polygon of an orbiting item around a stationary item only depends
+ * on the shapes, inflations and rotations of the two items and moves along with
+ * the stationary item. When many copies of the same object are arranged or an
+ * item is tried on every bin, the same no-fit polygons are calculated over and
+ * over again. The cache stores them relative to the translation of the
+ * stationary item, keyed by the shapes and rotations of the two items. The
+ * distinct shapes are stored once, the shape hash only selects the candidates
+ * to compare, so that a hash collision never returns the nfp of another shape.
+ *
+ * Share one cache among the placers of all the bins by setting it in the
+ * placer configuration. The memory is released with the cache, so its lifetime
+ * should be limited to one nesting.
+ */
+template<class RawShape>
+class NfpCache {
+    using Item = _Item<RawShape>;
+    using Vertex = TPoint<RawShape>;
+
+    using Coord = TCoord<Vertex>;
+
+    struct Key {
+        // Indices into shapes_
+        size_t stationary_shape;
+        double stationary_rotation;
+        size_t orbiter_shape;
+        double orbiter_rotation;
+
+        bool operator==(const Key& other) const
+        {
+            return stationary_shape == other.stationary_shape &&
+                   stationary_rotation == other.stationary_rotation &&
+                   orbiter_shape == other.orbiter_shape &&
+                   orbiter_rotation == other.orbiter_rotation;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& k) const
+        {
+            size_t h = k.stationary_shape;
+            for(size_t v : { std::hash<double>()(k.stationary_rotation),
+                             k.orbiter_shape,
+                             std::hash<double>()(k.orbiter_rotation) })
+                h ^= v + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    struct Shape {
+        RawShape shape;
+        Coord inflation;
+    };
+
+    template<class Path>
+    static bool samePath(const Path& a, const Path& b)
+    {
+        if(a.end() - a.begin() != b.end() - b.begin()) return false;
+        for(auto ia = a.begin(), ib = b.begin(); ia != a.end(); ++ia, ++ib)
+            if(getX(*ia) != getX(*ib) || getY(*ia) != getY(*ib)) return false;
+        return true;
+    }
+
+    static bool sameShape(const Shape& shape, const Item& item)
+    {
+        const RawShape& raw = item.rawShape();
+        if(shape.inflation != item.appliedInflation() ||
+           !samePath(shapelike::contour(shape.shape), shapelike::contour(raw)) ||
+           shapelike::holeCount(shape.shape) != shapelike::holeCount(raw))
+            return false;
+        for(size_t i = 0; i < shapelike::holeCount(raw); ++i)
+            if(!samePath(shapelike::hole(shape.shape, i), shapelike::hole(raw, i)))
+                return false;
+        return true;
+    }
+
+    // Index of the shape of the item in shapes_, the shape is added if new.
+    // To be called with the mutex locked.
+    size_t shapeId(const Item& item)
+    {
+        auto range = shape_ids_.equal_range(item.shapeHash());
+        for(auto it = range.first; it != range.second; ++it)
+            if(sameShape(shapes_[it->second], item))
+                return it->second;
+        shapes_.push_back({ item.rawShape(), item.appliedInflation() });
+        shape_ids_.emplace(item.shapeHash(), shapes_.size() - 1);
+        return shapes_.size() - 1;
+    }
+
+    Key key(const Item& stationary, const Item& orbiter)
+    {
+        return { shapeId(stationary), double(stationary.rotation()),
+                 shapeId(orbiter), double(orbiter.rotation()) };
+    }
+
+    std::unordered_map<Key, RawShape, KeyHash> map_;
+    // Distinct shapes of the items, looked up by their shape hashes
+    std::vector<Shape> shapes_;
+    std::unordered_multimap<size_t, size_t> shape_ids_;
+    size_t lookups_ = 0, hits_ = 0;
+    mutable std::mutex mutex_;
+
+public:
+
+    /// Copy the cached nfp of the two items into nfp, return false if missing.
+    bool find(const Item& stationary, const Item& orbiter, RawShape& nfp)
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        ++lookups_;
+        auto it = map_.find(key(stationary, orbiter));
+        if(it == map_.end()) return false;
+        ++hits_;
+        nfp = it->second;
+        shapelike::translate(nfp, stationary.translation());
+        return true;
+    }
+
+    void insert(const Item& stationary, const Item& orbiter, const RawShape& nfp)
+    {
+        RawShape rel = nfp;
+        shapelike::translate(rel, Vertex{0, 0} - stationary.translation());
+        std::lock_guard<std::mutex> lk(mutex_);
+        map_.emplace(key(stationary, orbiter), std::move(rel));
+    }
+
+    size_t size() const { std::lock_guard<std::mutex> lk(mutex_); return map_.size(); }
+    size_t lookups() const { std::lock_guard<std::mutex> lk(mutex_); return lookups_; }
+    size_t hits() const { std::lock_guard<std::mutex> lk(mutex_); return hits_; }
+};
+
 template<class RawShape>
 struct NfpPConfig {
 
@@ -93,6 +227,15 @@ struct NfpPConfig {
      */
     bool parallel = true;
 
+    /**
+     * @brief Cache of the no-fit polygons shared by all the placers configured
+     * with this configuration, i.e. by all the bins of a nesting. (Optional)
+     *
+     * Without a cache the no-fit polygons are recalculated for every
+     * placement attempt.
+     */
+    std::shared_ptr<NfpCache<RawShape>> nfp_cache;
+
     /**
      * @brief before_packing Callback that is called just before a search for
      * a new item's position is started. You can use this to create various
@@ -598,9 +741,18 @@ private:
         }
         // /////////////////////////////////////////////////////////////////////
 
-        __parallel::enumerate(items_.begin(), items_.end(),
-                              [&nfps, &trsh](const Item& sh, size_t n)
+        // Only the nfps missing in the cache are calculated
+        NfpCache<RawShape> *cache = config_.nfp_cache.get();
+        std::vector<size_t> missing;
+        missing.reserve(items_.size());
+        for(size_t n = 0; n < items_.size(); ++n)
+            if(!cache || !cache->find(items_[n], trsh, nfps[n]))
+                missing.emplace_back(n);
+
+        __parallel::enumerate(missing.begin(), missing.end(),
+                              [this, &nfps, &trsh](size_t n, size_t)
         {
+            const Item& sh = items_[n];
             auto& fixedp = sh.transformedShape();
             auto& orbp = trsh.transformedShape();
             auto subnfp_r = noFitPolygon<NfpLevel::CONVEX_ONLY>(fixedp, orbp);
@@ -608,6 +760,10 @@ private:
             nfps[n] = subnfp_r.first;
         });
 
+        if(cache)
+            for(size_t n : missing)
+                cache->insert(items_[n], trsh, nfps[n]);
+
         RawShape innerNfp = nfpInnerRectBed(bed, trsh.transformedShape()).first;
         return nfp::subtract({innerNfp}, nfps);
     }
@@ -841,53 +997,76 @@ private:
                 using OptResult = opt::Result<double>;
                 using OptResults = std::vector<OptResult>;
 
-                // Local optimization with the four polygon corners as
-                // starting points
+                // Local optimization with the corners of the nfp contours and
+                // of their holes as starting points. The optimizations of all
+                // the contours run in a single parallel loop, the best result
+                // of each contour is then checked in the order of the contours.
+                struct Contour {
+                    unsigned ch;
+                    int hidx;
+                    size_t first, last; // range of the starting points
+                };
+
+                std::vector<Contour> contours;
+                std::vector<Optimum> starts;
                 for(unsigned ch = 0; ch < ecache.size(); ch++) {
                     auto& cache = ecache[ch];
+                    auto add_contour = [&contours, &starts, ch](int hidx, const std::vector<double>& corners) {
+                        contours.push_back({ch, hidx, starts.size(), starts.size() + corners.size()});
+                        for(double pos : corners)
+                            starts.emplace_back(pos, ch, hidx);
+                    };
+                    add_contour(-1, cache.corners());
+                    for(unsigned hidx = 0; hidx < cache.holeCount(); ++hidx)
+                        add_contour(int(hidx), cache.corners(hidx));
+                }
 
-                    OptResults results(cache.corners().size());
+                OptResults results(starts.size());
 
-                    auto& rofn = rawobjfunc;
-                    auto& nfpoint = getNfpPoint;
-                    float accuracy = config_.accuracy;
+                auto& rofn = rawobjfunc;
+                auto& nfpoint = getNfpPoint;
+                float accuracy = config_.accuracy;
 
-                    __parallel::enumerate(
-                                cache.corners().begin(),
-                                cache.corners().end(),
-                                [&results, &item, &rofn, &nfpoint, ch, accuracy]
-                                (double pos, size_t n)
-                    {
-                        Optimizer solver(accuracy);
-
-                        Item itemcpy = item;
-                        auto contour_ofn = [&rofn, &nfpoint, ch, &itemcpy]
-                                (double relpos)
-                        {
-                            Optimum op(relpos, ch);
-                            return rofn(nfpoint(op), itemcpy);
-                        };
-
-                        try {
-                            results[n] = solver.optimize_min(contour_ofn,
-                                            opt::initvals<double>(pos),
-                                            opt::bound<double>(0, 1.0)
-                                            );
-                        } catch(std::exception& e) {
-                            derr() << "ERROR: " << e.what() << "\n";
-                        }
-                    }, policy);
+                __parallel::enumerate(
+                            starts.begin(),
+                            starts.end(),
+                            [&results, &item, &rofn, &nfpoint, accuracy]
+                            (const Optimum& start, size_t n)
+                {
+                    Optimizer solver(accuracy);
 
-                    auto resultcomp =
-                            []( const OptResult& r1, const OptResult& r2 ) {
-                        return r1.score < r2.score;
+                    Item itemcpy = item;
+                    auto contour_ofn = [&rofn, &nfpoint, &start, &itemcpy]
+                            (double relpos)
+                    {
+                        Optimum op(relpos, start.nfpidx, start.hidx);
+                        return rofn(nfpoint(op), itemcpy);
                     };
 
-                    auto mr = *std::min_element(results.begin(), results.end(),
+                    try {
+                        results[n] = solver.optimize_min(contour_ofn,
+                                        opt::initvals<double>(start.relpos),
+                                        opt::bound<double>(0, 1.0)
+                                        );
+                    } catch(std::exception& e) {
+                        derr() << "ERROR: " << e.what() << "\n";
+                    }
+                }, policy);
+
+                auto resultcomp =
+                        []( const OptResult& r1, const OptResult& r2 ) {
+                    return r1.score < r2.score;
+                };
+
+                for(const Contour& contour : contours) {
+                    if(contour.first == contour.last) continue;
+
+                    auto mr = *std::min_element(results.begin() + contour.first,
+                                                results.begin() + contour.last,
                                                 resultcomp);
 
                     if(mr.score < best_score) {
-                        Optimum o(std::get<0>(mr.optimum), ch, -1);
+                        Optimum o(std::get<0>(mr.optimum), contour.ch, contour.hidx);
                         double miss = boundaryCheck(o);
                         if(miss <= 0) {
                             best_score = mr.score;
@@ -896,56 +1075,6 @@ private:
                             best_overfit = std::min(miss, best_overfit);
                         }
                     }
-
-                    for(unsigned hidx = 0; hidx < cache.holeCount(); ++hidx) {
-                        results.clear();
-                        results.resize(cache.corners(hidx).size());
-
-                        // TODO : use parallel for
-                        __parallel::enumerate(cache.corners(hidx).begin(),
-                                      cache.corners(hidx).end(),
-                                      [&results, &item, &nfpoint,
-                                       &rofn, ch, hidx, accuracy]
-                                      (double pos, size_t n)
-                        {
-                            Optimizer solver(accuracy);
-
-                            Item itmcpy = item;
-                            auto hole_ofn =
-                                    [&rofn, &nfpoint, ch, hidx, &itmcpy]
-                                    (double pos)
-                            {
-                                Optimum opt(pos, ch, hidx);
-                                return rofn(nfpoint(opt), itmcpy);
-                            };
-
-                            try {
-                                results[n] = solver.optimize_min(hole_ofn,
-                                                opt::initvals<double>(pos),
-                                                opt::bound<double>(0, 1.0)
-                                                );
-
-                            } catch(std::exception& e) {
-                                derr() << "ERROR: " << e.what() << "\n";
-                            }
-                        }, policy);
-
-                        auto hmr = *std::min_element(results.begin(),
-                                                    results.end(),
-                                                    resultcomp);
-
-                        if(hmr.score < best_score) {
-                            Optimum o(std::get<0>(hmr.optimum),
-                                      ch, hidx);
-                            double miss = boundaryCheck(o);
-                            if(miss <= 0.0) {
-                                best_score = hmr.score;
-                                optimum = o;
-                            } else {
-                                best_overfit = std::min(miss, best_overfit);
-                            }
-                        }
-                    }
                 }
 
                 if( best_score < global_score) {
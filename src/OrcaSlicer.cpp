@@ -176,6 +176,8 @@ typedef struct _sliced_info {
     std::vector<std::string> downward_machines;
 }sliced_info_t;
 std::vector<PrintBase::SlicingStatus> g_slicing_warnings;
+// The print objects report their warnings from the worker threads processing them.
+std::mutex g_slicing_warnings_mutex;
 
 #if defined(__linux__) || defined(__LINUX__)
 #define PIPE_BUFFER_SIZE 512
@@ -363,7 +365,10 @@ cli_callback_mgr_t g_cli_callback_mgr;
 void cli_status_callback(const PrintBase::SlicingStatus& slicing_status)
 {
     if (slicing_status.warning_step != -1) {
-        g_slicing_warnings.push_back(slicing_status);
+        {
+            std::scoped_lock<std::mutex> lock(g_slicing_warnings_mutex);
+            g_slicing_warnings.push_back(slicing_status);
+        }
         BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": percent=%1%, warning_step=%2%, message=%3%, message_type=%4%, flag=%5%")
             %slicing_status.percent %slicing_status.warning_step %slicing_status.text %(int)(slicing_status.message_type) %slicing_status.flags;
     }
@@ -375,6 +380,7 @@ void cli_status_callback(const PrintBase::SlicingStatus& slicing_status)
 void default_status_callback(const PrintBase::SlicingStatus& slicing_status)
 {
     if (slicing_status.warning_step != -1) {
+        std::scoped_lock<std::mutex> lock(g_slicing_warnings_mutex);
         g_slicing_warnings.push_back(slicing_status);
     }
     BOOST_LOG_TRIVIAL(debug) << __FUNCTION__ << boost::format(": percent=%1%, warning_step=%2%, message=%3%, message_type=%4%")%slicing_status.percent %slicing_status.warning_step %slicing_status.text %(int)(slicing_status.message_type);
@@ -1474,6 +1480,7 @@ int CLI::run(int argc, char **argv)
         load_assemble_list = load_assemble_list_option->value;
 
     bool allow_multicolor_oneplate = m_config.option<ConfigOptionBool>("allow_multicolor_oneplate", true)->value;
+    ArrangeStrategy arrange_strategy = m_config.option<ConfigOptionEnum<ArrangeStrategy>>("arrange_strategy", true)->value;
     const std::vector<int>  loaded_filament_ids  = m_config.option<ConfigOptionInts>("load_filament_ids", true)->values;
     const std::vector<int>  clone_objects  = m_config.option<ConfigOptionInts>("clone_objects", true)->values;
     //when load objects from stl/obj, the total used filaments set
@@ -4685,6 +4692,7 @@ int CLI::run(int argc, char **argv)
                 //Step-2:prepare the arrange params
                 arrange_cfg.allow_rotations = allow_rotations;
                 arrange_cfg.allow_multi_materials_on_same_plate = allow_multicolor_oneplate;
+                arrange_cfg.strategy = arrange_strategy;
                 arrange_cfg.avoid_extrusion_cali_region = avoid_extrusion_cali_region;
                 arrange_cfg.clearance_height_to_rod = height_to_rod;
                 arrange_cfg.clearance_height_to_lid = height_to_lid;
@@ -5135,6 +5143,7 @@ int CLI::run(int argc, char **argv)
                 //Step-2:prepare the arrange params
                 arrange_cfg.allow_rotations  = allow_rotations;
                 arrange_cfg.allow_multi_materials_on_same_plate = allow_multicolor_oneplate;
+                arrange_cfg.strategy = arrange_strategy;
                 arrange_cfg.avoid_extrusion_cali_region         = avoid_extrusion_cali_region;
                 arrange_cfg.clearance_height_to_rod             = height_to_rod;
                 arrange_cfg.clearance_height_to_lid             = height_to_lid;
@@ -5447,9 +5456,9 @@ int CLI::run(int argc, char **argv)
     }
 
     // loop through action options
-    bool export_to_3mf = false, load_slicedata = false, export_slicedata = false, export_slicedata_error = false;
+    bool export_to_3mf = false, load_slicedata = false, export_slicedata = false, export_slicedata_error = false, use_slicedata_cache = false;
     bool no_check = false;
-    std::string export_3mf_file, load_slice_data_dir, export_slice_data_dir, export_stls_dir;
+    std::string export_3mf_file, load_slice_data_dir, export_slice_data_dir, export_stls_dir, slicedata_cache_dir;
     std::vector<ThumbnailData*> calibration_thumbnails;
     std::vector<int> plate_object_count(partplate_list.get_plate_count(), 0);
     int max_slicing_time_per_plate = 0, max_triangle_count_per_plate = 0, sliced_plate = -1;
@@ -5472,7 +5481,7 @@ int CLI::run(int argc, char **argv)
         } else if (opt_key == "load_slicedata") {
             load_slicedata = true;
             load_slice_data_dir = m_config.opt_string(opt_key);
-            if (export_slicedata) {
+            if (export_slicedata || use_slicedata_cache) {
                 BOOST_LOG_TRIVIAL(error) << "should not set load_slicedata and export_slicedata together." << std::endl;
                 record_exit_reson(outfile_dir, CLI_INVALID_PARAMS, 0, cli_errors[CLI_INVALID_PARAMS], sliced_info);
                 flush_and_exit(CLI_INVALID_PARAMS);
@@ -5489,6 +5498,14 @@ int CLI::run(int argc, char **argv)
                 //record_exit_reson(outfile_dir, CLI_INVALID_PARAMS, 0, cli_errors[CLI_INVALID_PARAMS], sliced_info);
                 //flush_and_exit(CLI_INVALID_PARAMS);
             }
+        } else if (opt_key == "slicedata_cache") {
+            use_slicedata_cache = true;
+            slicedata_cache_dir = m_config.opt_string(opt_key);
+            if (load_slicedata || export_slicedata) {
+                BOOST_LOG_TRIVIAL(error) << "should not set slicedata_cache together with load_slicedata or export_slicedata." << std::endl;
+                record_exit_reson(outfile_dir, CLI_INVALID_PARAMS, 0, cli_errors[CLI_INVALID_PARAMS], sliced_info);
+                flush_and_exit(CLI_INVALID_PARAMS);
+            }
         } else if (opt_key == "export_settings") {
             //FIXME check for mixing the FFF / SLA parameters.
             // or better save fff_print_config vs. sla_print_config
@@ -5546,7 +5563,7 @@ int CLI::run(int argc, char **argv)
         } else if (opt_key == "export_slicedata") {
             export_slicedata = true;
             export_slice_data_dir = m_config.opt_string(opt_key);
-            if (load_slicedata) {
+            if (load_slicedata || use_slicedata_cache) {
                 BOOST_LOG_TRIVIAL(error) << "should not set load_slicedata and export_slicedata together." << std::endl;
                 record_exit_reson(outfile_dir, CLI_INVALID_PARAMS, 0, cli_errors[CLI_INVALID_PARAMS], sliced_info);
                 flush_and_exit(CLI_INVALID_PARAMS);
@@ -6071,6 +6088,12 @@ int CLI::run(int argc, char **argv)
                                         BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": finished print::process.";
                                     }
                                 }
+                                else if (use_slicedata_cache && (print->load_cached_data(slicedata_cache_dir, true) == 0)) {
+                                    //the objects not found in the cache are sliced by process()
+                                    BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": found objects in slicing cache " << slicedata_cache_dir << ", go on.";
+                                    print->process(nullptr, true);
+                                    BOOST_LOG_TRIVIAL(info) << "plate "<< index+1<< ": finished print::process.";
+                                }
                                 else {
                                     print->process(&time_using_cache);
                                     BOOST_LOG_TRIVIAL(info) << "print::process: first time_using_cache is " << time_using_cache << " secs.";
@@ -6182,6 +6205,12 @@ int CLI::run(int argc, char **argv)
                                         flush_and_exit(ret);
                                     }
                                 }
+                                if (use_slicedata_cache) {
+                                    //failing to update the cache is not fatal, the G-code is already exported
+                                    int ret = print->export_cached_data(slicedata_cache_dir, false, true);
+                                    if (ret)
+                                        BOOST_LOG_TRIVIAL(warning) << "plate "<< index+1<< ": update slicing cache " << slicedata_cache_dir << " error, ret=" << ret;
+                                }
                                 end_time = (long long)Slic3r::Utils::get_current_time_utc();
                                 sliced_plate_info.sliced_time = end_time - start_time;
                                 sliced_plate_info.sliced_time_with_cache = time_using_cache;
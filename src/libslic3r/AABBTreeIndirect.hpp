@@ -7,6 +7,8 @@
 #define slic3r_AABBTreeIndirect_hpp_
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <limits>
 #include <type_traits>
 #include <vector>
@@ -19,6 +21,11 @@
 // Definition of the ray intersection hit structure.
 #include <igl/Hit.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SLIC3R_AABBTREEINDIRECT_SSE2
+    #include <emmintrin.h>
+#endif
+
 namespace Slic3r {
 namespace AABBTreeIndirect {
 
@@ -260,6 +267,64 @@ namespace detail {
 		std::vector<igl::Hit>				 hits;
 	};
 
+	// Packet of rays traversing the tree together, see intersect_ray_packet_first_hit().
+	// The ray origins, inverse directions and parameter limits are stored as structure of arrays
+	// to test a bounding box against several rays at once, see ray_packet_box_intersect().
+	template<size_t APacketSize, typename AVertexType, typename AIndexedFaceType, typename ATreeType, typename AVectorType>
+	struct RayPacketIntersector {
+		static constexpr size_t PacketSize = APacketSize;
+		static_assert(PacketSize > 0 && PacketSize <= 32, "Ray packet masks are 32 bit.");
+		using VertexType 		= AVertexType;
+		using IndexedFaceType 	= AIndexedFaceType;
+		using TreeType			= ATreeType;
+		using VectorType 		= AVectorType;
+		using Scalar 			= typename VectorType::Scalar;
+
+		RayPacketIntersector(const std::vector<VertexType> &vertices, const std::vector<IndexedFaceType> &faces, const TreeType &tree,
+			const VectorType *origins, const VectorType *dirs, size_t num_rays, double eps) :
+			vertices(vertices), faces(faces), tree(tree), origins(origins), dirs(dirs), eps(eps)
+		{
+			assert(num_rays <= PacketSize);
+			for (size_t i = 0; i < PacketSize; ++ i) {
+				// Unused lanes never intersect a box: tmin = 0 > t_max.
+				const bool active = i < num_rays;
+				for (int axis = 0; axis < 3; ++ axis) {
+					origin[axis][i] = active ? origins[i](axis) : Scalar(0);
+					// Clamped to a finite value, so that a ray starting on a slab boundary of a box parallel to the slab
+					// does not produce 0 * inf = NaN in ray_packet_box_intersect().
+					invdir[axis][i] = active ? std::clamp(Scalar(1) / dirs[i](axis), - std::numeric_limits<Scalar>::max(), std::numeric_limits<Scalar>::max()) : Scalar(0);
+				}
+				t_max[i] = active ? std::numeric_limits<Scalar>::infinity() : - std::numeric_limits<Scalar>::infinity();
+				t_hit[i] = std::numeric_limits<double>::infinity();
+			}
+		}
+
+		// Shorten the ray to the first hit found so far. The ray-triangle tests run in double precision,
+		// t_max is rounded up to Scalar, so that no box containing a nearer hit is culled.
+		void set_first_hit(size_t ray_idx, double t) {
+			t_hit[ray_idx] = t;
+			Scalar t_rounded = Scalar(t);
+			t_max[ray_idx] = double(t_rounded) < t ? std::nextafter(t_rounded, std::numeric_limits<Scalar>::infinity()) : t_rounded;
+		}
+
+		const std::vector<VertexType> 		&vertices;
+		const std::vector<IndexedFaceType> 	&faces;
+		const TreeType 						&tree;
+
+		const VectorType					*origins;
+		const VectorType					*dirs;
+
+		Scalar 								 origin[3][PacketSize];
+		Scalar 								 invdir[3][PacketSize];
+		// Only intersections with parameter t <= t_max are of interest, updated by the first hit traversal.
+		Scalar 								 t_max[PacketSize];
+		// Parameter of the first hit found so far by the first hit traversal.
+		double 								 t_hit[PacketSize];
+
+		// epsilon for ray-triangle intersection, see intersect_triangle1()
+		const double  						 eps;
+	};
+
 	//FIXME implement SSE for float AABB trees with float ray queries.
 	// SSE/SSE2 is supported by any Intel/AMD x64 processor.
 	// SSE support requires 16 byte alignment of the AABB nodes, representing the bounding boxes with 4+4 floats,
@@ -371,13 +436,13 @@ namespace detail {
 	template<typename V, typename W>
     std::enable_if_t<! std::is_same<typename V::Scalar, double>::value && std::is_same<typename W::Scalar, double>::value, bool>
 	intersect_triangle(const V &origin, const V &dir, const W &v0, const W &v1, const W &v2, double &t, double &u, double &v, double eps) {
-        return intersect_triangle(origin.template cast<double>(), dir.template cast<double>(), v0, v1, v2, t, u, v, eps);
+        return intersect_triangle(origin.template cast<double>().eval(), dir.template cast<double>().eval(), v0, v1, v2, t, u, v, eps);
 	}
 
 	template<typename V, typename W>
     std::enable_if_t<! std::is_same<typename V::Scalar, double>::value && ! std::is_same<typename W::Scalar, double>::value, bool>
 	intersect_triangle(const V &origin, const V &dir, const W &v0, const W &v1, const W &v2, double &t, double &u, double &v, double eps) {
-	    return intersect_triangle(origin.template cast<double>(), dir.template cast<double>(), v0.template cast<double>(), v1.template cast<double>(), v2.template cast<double>(), t, u, v, eps);
+	    return intersect_triangle(origin.template cast<double>().eval(), dir.template cast<double>().eval(), v0.template cast<double>(), v1.template cast<double>(), v2.template cast<double>(), t, u, v, eps);
 	}
 
 	template<typename Tree>
@@ -470,6 +535,112 @@ namespace detail {
 		}
 	}
 
+	// Test a bounding box against all rays of a packet, returns a bit mask of the rays intersecting the box
+	// within their parameter range <0, t_max> and the smallest ray parameter at which these rays enter the box.
+	// Branch free slab test, four rays at a time with SSE for float packets.
+	// The test is conservative: Each of the slab parameters is calculated with a relative error below 2 ulp,
+	// therefore the exit parameter is enlarged by 8 ulp. A box intersected by a ray in exact arithmetic,
+	// or in the double precision of ray_box_intersect_invdir(), is never culled, so that the ray packet queries
+	// return the same hits as the single ray queries.
+	template<typename RayPacketIntersectorType, typename BoundingBoxType>
+	inline uint32_t ray_packet_box_intersect(const RayPacketIntersectorType &ray_intersector, const BoundingBoxType &box, typename RayPacketIntersectorType::Scalar &t_entry)
+	{
+		using Scalar = typename RayPacketIntersectorType::Scalar;
+		static constexpr size_t PacketSize = RayPacketIntersectorType::PacketSize;
+		static constexpr Scalar slack = Scalar(1) + Scalar(8) * std::numeric_limits<Scalar>::epsilon();
+		const Scalar bmin[3] { Scalar(box.min().x()), Scalar(box.min().y()), Scalar(box.min().z()) };
+		const Scalar bmax[3] { Scalar(box.max().x()), Scalar(box.max().y()), Scalar(box.max().z()) };
+		uint32_t mask = 0;
+#ifdef SLIC3R_AABBTREEINDIRECT_SSE2
+		if constexpr (std::is_same_v<Scalar, float> && PacketSize % 4 == 0) {
+			const __m128 inf   = _mm_set1_ps(std::numeric_limits<float>::infinity());
+			const __m128 scale = _mm_set1_ps(slack);
+			__m128       entry = inf;
+			for (size_t i = 0; i < PacketSize; i += 4) {
+				__m128 tmin = _mm_setzero_ps();
+				__m128 tmax = _mm_loadu_ps(ray_intersector.t_max + i);
+				for (int axis = 0; axis < 3; ++ axis) {
+					__m128 origin = _mm_loadu_ps(ray_intersector.origin[axis] + i);
+					__m128 invdir = _mm_loadu_ps(ray_intersector.invdir[axis] + i);
+					__m128 t0     = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmin[axis]), origin), invdir);
+					__m128 t1     = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bmax[axis]), origin), invdir);
+					tmin = _mm_max_ps(tmin, _mm_min_ps(t0, t1));
+					tmax = _mm_min_ps(tmax, _mm_max_ps(t0, t1));
+				}
+				// A negative tmax stays negative when enlarged, such box lies behind the ray origin.
+				__m128 intersects = _mm_cmple_ps(tmin, _mm_mul_ps(tmax, scale));
+				mask |= uint32_t(_mm_movemask_ps(intersects)) << i;
+				entry = _mm_min_ps(entry, _mm_or_ps(_mm_and_ps(intersects, tmin), _mm_andnot_ps(intersects, inf)));
+			}
+			entry   = _mm_min_ps(entry, _mm_shuffle_ps(entry, entry, _MM_SHUFFLE(2, 3, 0, 1)));
+			entry   = _mm_min_ps(entry, _mm_shuffle_ps(entry, entry, _MM_SHUFFLE(1, 0, 3, 2)));
+			t_entry = _mm_cvtss_f32(entry);
+			return mask;
+		}
+#endif // SLIC3R_AABBTREEINDIRECT_SSE2
+		t_entry = std::numeric_limits<Scalar>::infinity();
+		for (size_t i = 0; i < PacketSize; ++ i) {
+			Scalar tmin = 0;
+			Scalar tmax = ray_intersector.t_max[i];
+			for (int axis = 0; axis < 3; ++ axis) {
+				Scalar t0 = (bmin[axis] - ray_intersector.origin[axis][i]) * ray_intersector.invdir[axis][i];
+				Scalar t1 = (bmax[axis] - ray_intersector.origin[axis][i]) * ray_intersector.invdir[axis][i];
+				tmin = std::max(tmin, std::min(t0, t1));
+				tmax = std::min(tmax, std::max(t0, t1));
+			}
+			if (tmin <= tmax * slack) {
+				mask |= uint32_t(1) << i;
+				t_entry = std::min(t_entry, tmin);
+			}
+		}
+		return mask;
+	}
+
+	// Traverse the subtree of node_idx once for all rays of a packet, calling leaf_fn(face_idx, mask) for each leaf
+	// intersected by the rays in mask. The rays in mask have already been tested against the bounding box of node_idx.
+	// The child entered first by the rays is visited first, so that the first hit traversal may shorten
+	// the rays early and skip the farther nodes.
+    template<typename RayPacketIntersectorType, typename LeafFn>
+	static inline void intersect_ray_packet_recursive(RayPacketIntersectorType &ray_intersector, size_t node_idx, uint32_t mask, LeafFn &leaf_fn)
+	{
+		using Scalar = typename RayPacketIntersectorType::Scalar;
+		const auto &node = ray_intersector.tree.node(node_idx);
+		assert(node.is_valid());
+
+		if (node.is_leaf())
+			leaf_fn(node.idx, mask);
+		else {
+			// Left / right child node index.
+			size_t   left  = node_idx * 2 + 1;
+			size_t   right = left + 1;
+			Scalar   left_entry, right_entry;
+			uint32_t left_mask  = mask & ray_packet_box_intersect(ray_intersector, ray_intersector.tree.node(left).bbox,  left_entry);
+			uint32_t right_mask = mask & ray_packet_box_intersect(ray_intersector, ray_intersector.tree.node(right).bbox, right_entry);
+			if (right_mask != 0 && (left_mask == 0 || right_entry < left_entry)) {
+				std::swap(left, right);
+				std::swap(left_mask, right_mask);
+			}
+			if (left_mask != 0)
+				intersect_ray_packet_recursive(ray_intersector, left, left_mask, leaf_fn);
+			if (right_mask != 0) {
+				// The rays may have been shortened by the hits in the nearer child.
+				right_mask &= ray_packet_box_intersect(ray_intersector, ray_intersector.tree.node(right).bbox, right_entry);
+				if (right_mask != 0)
+					intersect_ray_packet_recursive(ray_intersector, right, right_mask, leaf_fn);
+			}
+		}
+	}
+
+	template<typename RayPacketIntersectorType>
+	inline bool intersect_ray_packet_triangle(const RayPacketIntersectorType &ray_intersector, size_t face_idx, size_t ray_idx, double &t, double &u, double &v)
+	{
+		auto face = ray_intersector.faces[face_idx];
+		return intersect_triangle(
+			ray_intersector.origins[ray_idx], ray_intersector.dirs[ray_idx],
+			ray_intersector.vertices[face(0)], ray_intersector.vertices[face(1)], ray_intersector.vertices[face(2)],
+			t, u, v, ray_intersector.eps) && t > 0.;
+	}
+
     // Real-time collision detection, Ericson, Chapter 5
     template<typename Vector>
     static inline Vector closest_point_to_triangle(const Vector &p, const Vector &a, const Vector &b, const Vector &c)
@@ -787,6 +958,110 @@ inline bool intersect_ray_all_hits(
 	return ! hits.empty();
 }
 
+// Find first intersections of a packet of up to PacketSize rays with indexed triangle set.
+// The rays are traced together through the tree, which pays off for coherent rays, for example rays sharing an origin:
+// The tree nodes are fetched once per packet, the ray-box tests run four rays at a time and the nearer child is visited first.
+// Returns the same hits as intersect_ray_first_hit() called for each ray separately. The ray-box tests are calculated
+// with VectorType::Scalar, but conservatively, see ray_packet_box_intersect(), the ray-triangle tests in double precision.
+// Returns a bit mask of the rays, which hit the triangle set.
+template<size_t PacketSize, typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+inline uint32_t intersect_ray_packet_first_hit(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::Tree over vertices & faces, bounding boxes built with the accuracy of vertices.
+	const TreeType 						&tree,
+	// Origins of the rays.
+	const VectorType					*origins,
+	// Directions of the rays.
+	const VectorType 					*dirs,
+	// Number of rays, at most PacketSize.
+	size_t 								 num_rays,
+	// First intersections of the rays with the indexed triangle set, num_rays items. Hits of rays not intersecting have id -1.
+	igl::Hit 							*hits,
+	// Epsilon for the ray-triangle intersection, it should be proportional to an average triangle edge length.
+	const double 						 eps = 0.000001)
+{
+	using Scalar = typename VectorType::Scalar;
+	for (size_t i = 0; i < num_rays; ++ i)
+		hits[i] = igl::Hit { -1, -1, 0.f, 0.f, std::numeric_limits<float>::infinity() };
+	if (tree.empty() || num_rays == 0)
+		return 0;
+
+	auto ray_intersector = detail::RayPacketIntersector<PacketSize, VertexType, IndexedFaceType, TreeType, VectorType>(
+		vertices, faces, tree, origins, dirs, num_rays, eps);
+	uint32_t hit_mask = 0;
+	auto leaf_fn = [&ray_intersector, hits, &hit_mask](size_t face_idx, uint32_t mask) {
+		for (size_t ray_idx = 0; ray_idx < PacketSize; ++ ray_idx) {
+			if ((mask & (uint32_t(1) << ray_idx)) == 0)
+				continue;
+		    double t, u, v;
+			if (detail::intersect_ray_packet_triangle(ray_intersector, face_idx, ray_idx, t, u, v) && t < ray_intersector.t_hit[ray_idx]) {
+                hits[ray_idx] = igl::Hit { int(face_idx), -1, float(u), float(v), float(t) };
+				ray_intersector.set_first_hit(ray_idx, t);
+				hit_mask |= uint32_t(1) << ray_idx;
+			}
+		}
+	};
+	Scalar   t_entry;
+	uint32_t mask = detail::ray_packet_box_intersect(ray_intersector, tree.node(0).bbox, t_entry);
+	if (mask != 0)
+		detail::intersect_ray_packet_recursive(ray_intersector, size_t(0), mask, leaf_fn);
+	return hit_mask;
+}
+
+// Find all intersections of a packet of up to PacketSize rays with indexed triangle set, see intersect_ray_packet_first_hit().
+// The output hits of each ray are sorted by the ray parameter.
+// Returns a bit mask of the rays, which hit the triangle set.
+template<size_t PacketSize, typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+inline uint32_t intersect_ray_packet_all_hits(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::Tree over vertices & faces, bounding boxes built with the accuracy of vertices.
+	const TreeType 						&tree,
+	// Origins of the rays.
+	const VectorType					*origins,
+	// Directions of the rays.
+	const VectorType 					*dirs,
+	// Number of rays, at most PacketSize.
+	size_t 								 num_rays,
+	// All intersections of each ray with the indexed triangle set sorted by parameter t, num_rays items.
+	std::vector<igl::Hit> 				*hits,
+	// Epsilon for the ray-triangle intersection, it should be proportional to an average triangle edge length.
+	const double 						 eps = 0.000001)
+{
+	using Scalar = typename VectorType::Scalar;
+	for (size_t i = 0; i < num_rays; ++ i)
+		hits[i].clear();
+	if (tree.empty() || num_rays == 0)
+		return 0;
+
+	auto ray_intersector = detail::RayPacketIntersector<PacketSize, VertexType, IndexedFaceType, TreeType, VectorType>(
+		vertices, faces, tree, origins, dirs, num_rays, eps);
+	uint32_t hit_mask = 0;
+	auto leaf_fn = [&ray_intersector, hits, &hit_mask](size_t face_idx, uint32_t mask) {
+		for (size_t ray_idx = 0; ray_idx < PacketSize; ++ ray_idx) {
+			if ((mask & (uint32_t(1) << ray_idx)) == 0)
+				continue;
+		    double t, u, v;
+			if (detail::intersect_ray_packet_triangle(ray_intersector, face_idx, ray_idx, t, u, v)) {
+                hits[ray_idx].emplace_back(igl::Hit{ int(face_idx), -1, float(u), float(v), float(t) });
+				hit_mask |= uint32_t(1) << ray_idx;
+			}
+		}
+	};
+	Scalar   t_entry;
+	uint32_t mask = detail::ray_packet_box_intersect(ray_intersector, tree.node(0).bbox, t_entry);
+	if (mask != 0)
+		detail::intersect_ray_packet_recursive(ray_intersector, size_t(0), mask, leaf_fn);
+	for (size_t i = 0; i < num_rays; ++ i)
+	    std::sort(hits[i].begin(), hits[i].end(), [](const auto &l, const auto &r) { return l.t < r.t; });
+	return hit_mask;
+}
+
 // Finding a closest triangle, its closest point and squared distance to the closest point
 // on a 3D indexed triangle set using a pre-built AABBTreeIndirect::Tree.
 // Closest point to triangle test will be performed with the accuracy of VectorType::Scalar
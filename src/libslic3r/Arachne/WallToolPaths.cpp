@@ -17,6 +17,10 @@
 #include "Utils.hpp"
 
 #include <boost/log/trivial.hpp>
+#include <boost/functional/hash.hpp>
+
+#include <chrono>
+#include <cstring>
 
 //#define ARACHNE_STITCH_PATCH_DEBUG
 
@@ -484,6 +488,29 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
     if (this->inset_count < 1)
         return toolpaths;
 
+    // Reuse the toolpaths of the same shape generated for another layer or island.
+    std::vector<int64_t> cache_key;
+    Point                cache_origin;
+    auto                 translate_to_outline = [this, &cache_origin]() {
+        for (VariableWidthLines &lines : toolpaths)
+            for (ExtrusionLine &line : lines)
+                for (ExtrusionJunction &junction : line.junctions)
+                    junction.p += cache_origin;
+        for (Polygon &polygon : inner_contour)
+            polygon.translate(cache_origin);
+    };
+    if (m_params.cache != nullptr) {
+        cache_key = this->cacheKey(cache_origin);
+        if (std::shared_ptr<const WallToolPathsCache::Entry> entry = m_params.cache->find(cache_key); entry) {
+            toolpaths     = entry->toolpaths;
+            inner_contour = entry->inner_contour;
+            translate_to_outline();
+            toolpaths_generated = true;
+            return toolpaths;
+        }
+    }
+    auto generate_start = std::chrono::steady_clock::now();
+
     const coord_t smallest_segment = m_params.wall_maximum_resolution;
     const coord_t allowed_distance = m_params.wall_maximum_deviation;
     const coord_t epsilon_offset = (allowed_distance / 2) - 1;
@@ -492,7 +519,12 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
 
     // Simplify outline for boost::voronoi consumption. Absolutely no self intersections or near-self intersections allowed:
     // TODO: Open question: Does this indeed fix all (or all-but-one-in-a-million) cases for manifold but otherwise possibly complex polygons?
-    Polygons prepared_outline = offset(offset(offset(outline, -epsilon_offset), epsilon_offset * 2), -epsilon_offset);
+    Polygons prepared_outline = outline;
+    if (m_params.cache != nullptr)
+        // The toolpaths of a cached shape are generated at the origin, so that a cache miss returns exactly what a later hit will.
+        for (Polygon &polygon : prepared_outline)
+            polygon.translate(-cache_origin);
+    prepared_outline = offset(offset(offset(prepared_outline, -epsilon_offset), epsilon_offset * 2), -epsilon_offset);
     simplify(prepared_outline, smallest_segment, allowed_distance);
     fixSelfIntersections(epsilon_offset, prepared_outline);
     removeDegenerateVerts(prepared_outline);
@@ -567,9 +599,100 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
                               return l.front().inset_idx < r.front().inset_idx;
                           }) && "WallToolPaths should be sorted from the outer 0th to inner_walls");
     toolpaths_generated = true;
+
+    if (m_params.cache != nullptr) {
+        auto entry = std::make_shared<WallToolPathsCache::Entry>();
+        entry->toolpaths     = toolpaths;
+        entry->inner_contour = inner_contour;
+        entry->generate_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - generate_start).count();
+        m_params.cache->insert(std::move(cache_key), std::move(entry));
+        translate_to_outline();
+    }
     return toolpaths;
 }
 
+std::vector<int64_t> WallToolPaths::cacheKey(Point &origin) const
+{
+    auto bits = [](double value) {
+        int64_t out;
+        static_assert(sizeof(out) == sizeof(value));
+        std::memcpy(&out, &value, sizeof(value));
+        return out;
+    };
+    std::vector<int64_t> key {
+        bead_width_0, bead_width_x, int64_t(inset_count), wall_0_inset, bits(layer_height), print_thin_walls, min_feature_size, min_bead_width,
+        bits(small_area_length), wall_transition_filter_deviation, bits(m_params.min_bead_width), bits(m_params.min_feature_size),
+        bits(m_params.min_length_factor), bits(m_params.wall_transition_length), bits(m_params.wall_transition_angle),
+        bits(m_params.wall_transition_filter_deviation), m_params.wall_distribution_count, m_params.is_top_or_bottom_layer,
+        m_params.wall_maximum_resolution, m_params.wall_maximum_deviation
+    };
+
+    // Only translated, the point order is kept: another starting point or order of the polygons produces other toolpaths.
+    origin = get_extents(outline).min;
+    size_t num_points = 0;
+    for (const Polygon &polygon : outline)
+        num_points += polygon.size();
+    key.reserve(key.size() + outline.size() + 2 * num_points);
+    for (const Polygon &polygon : outline) {
+        key.emplace_back(int64_t(polygon.size()));
+        for (const Point &pt : polygon.points) {
+            key.emplace_back(pt.x() - origin.x());
+            key.emplace_back(pt.y() - origin.y());
+        }
+    }
+    return key;
+}
+
+size_t WallToolPathsCache::KeyHash::operator()(const std::vector<int64_t> &key) const
+{
+    return boost::hash_range(key.begin(), key.end());
+}
+
+std::shared_ptr<const WallToolPathsCache::Entry> WallToolPathsCache::find(const std::vector<int64_t> &key)
+{
+    ++ m_lookups;
+    std::shared_ptr<const Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (auto it = m_entries.find(key); it != m_entries.end())
+            entry = it->second;
+    }
+    if (entry) {
+        ++ m_hits;
+        m_saved_us += int64_t(entry->generate_ms * 1000.);
+    }
+    return entry;
+}
+
+void WallToolPathsCache::insert(std::vector<int64_t> &&key, std::shared_ptr<const Entry> entry)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // The same shape may have been generated by another thread in the meantime, with the same toolpaths.
+    if (auto [it, inserted] = m_entries.try_emplace(std::move(key), std::move(entry)); inserted) {
+        m_order.emplace_back(&it->first);
+        if (m_order.size() > m_max_entries) {
+            m_entries.erase(m_entries.find(*m_order.front()));
+            m_order.pop_front();
+        }
+    }
+}
+
+WallToolPathsCache::Statistics WallToolPathsCache::statistics() const
+{
+    Statistics out;
+    out.lookups  = m_lookups;
+    out.hits     = m_hits;
+    out.saved_ms = double(m_saved_us) / 1000.;
+    return out;
+}
+
+void WallToolPathsCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_order.clear();
+}
+
 void WallToolPaths::stitchToolPaths(std::vector<VariableWidthLines> &toolpaths, const coord_t bead_width_x)
 {
     const coord_t stitch_distance = bead_width_x - 1; //In 0-width contours, junctions can cause up to 1-line-width gaps. Don't stitch more than 1 line width.
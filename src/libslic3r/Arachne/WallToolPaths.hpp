@@ -5,6 +5,10 @@
 #define CURAENGINE_WALLTOOLPATHS_H
 
 #include <memory>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
 #include <ankerl/unordered_dense.h>
 
 #include "BeadingStrategy/BeadingStrategyFactory.hpp"
@@ -20,6 +24,8 @@ inline coord_t    meshfix_maximum_resolution() { return scaled<coord_t>(0.5); }
 inline coord_t    meshfix_maximum_deviation() { return scaled<coord_t>(0.025); }
 inline coord_t    meshfix_maximum_extrusion_area_deviation() { return scaled<coord_t>(2.); }
 
+class WallToolPathsCache;
+
 class WallToolPathsParams
 {
 public:
@@ -34,6 +40,9 @@ public:
 
     coord_t wall_maximum_resolution = meshfix_maximum_resolution();
     coord_t wall_maximum_deviation  = meshfix_maximum_deviation();
+
+    // Optional cache of the generated toolpaths, shared by the WallToolPaths of the layers of an object.
+    WallToolPathsCache *cache = nullptr;
 };
 
 WallToolPathsParams make_paths_params(const int layer_id, const PrintObjectConfig &print_object_config, const PrintConfig &print_config);
@@ -126,6 +135,9 @@ protected:
     static void simplifyToolPaths(std::vector<VariableWidthLines>& toolpaths, const WallToolPathsParams& params);
 
 private:
+    // Key of the outline and of the parameters in WallToolPathsCache, the outline is translated to the origin.
+    std::vector<int64_t> cacheKey(Point &origin) const;
+
     const Polygons& outline; //<! A reference to the outline polygon that is the designated area
     coord_t bead_width_0; //<! The nominal or first extrusion line width with which libArachne generates its walls
     coord_t bead_width_x; //<! The subsequently extrusion line width with which libArachne generates its walls if WallToolPaths was called with the nominal_bead_width Constructor this is the same as bead_width_0
@@ -143,6 +155,57 @@ private:
     const WallToolPathsParams m_params;
 };
 
+/*!
+ * Cache of the toolpaths generated by WallToolPaths, keyed by the shape of the outline and by the generator parameters.
+ *
+ * Prismatic parts produce the same cross-section layer after layer, and a plate of identical parts produces the same
+ * island many times in a single layer. The key is the outline translated to the origin with its points in their order.
+ * The toolpaths of a cached shape are always generated at the origin and then translated to the position of the outline,
+ * so the result does not depend on whether it was found in the cache. The cache is thread safe and keeps at most
+ * max_entries shapes. Enabled by the wall_generator_cache option.
+ */
+class WallToolPathsCache
+{
+public:
+    explicit WallToolPathsCache(size_t max_entries = 1024) : m_max_entries(max_entries) {}
+
+    struct Statistics
+    {
+        size_t lookups { 0 };
+        size_t hits    { 0 };
+        // Time it took to generate the toolpaths reused by the cache hits.
+        double saved_ms { 0. };
+    };
+    Statistics statistics() const;
+    void       clear();
+
+private:
+    friend class WallToolPaths;
+
+    struct Entry
+    {
+        std::vector<VariableWidthLines> toolpaths;
+        Polygons                        inner_contour;
+        double                          generate_ms;
+    };
+    struct KeyHash
+    {
+        size_t operator()(const std::vector<int64_t> &key) const;
+    };
+
+    std::shared_ptr<const Entry> find(const std::vector<int64_t> &key);
+    void                         insert(std::vector<int64_t> &&key, std::shared_ptr<const Entry> entry);
+
+    const size_t                                                                            m_max_entries;
+    mutable std::mutex                                                                      m_mutex;
+    std::unordered_map<std::vector<int64_t>, std::shared_ptr<const Entry>, KeyHash>         m_entries;
+    // Insertion order of m_entries for eviction of the oldest entries.
+    std::deque<const std::vector<int64_t>*>                                                 m_order;
+    std::atomic<size_t>                                                                     m_lookups { 0 };
+    std::atomic<size_t>                                                                     m_hits { 0 };
+    std::atomic<int64_t>                                                                    m_saved_us { 0 };
+};
+
 } // namespace Slic3r::Arachne
 
 #endif // CURAENGINE_WALLTOOLPATHS_H
@@ -9,7 +9,10 @@
 #include <libnest2d/selections/firstfit.hpp>
 #include <libnest2d/utils/rotcalipers.hpp>
 
+#include <map>
 #include <numeric>
+#include <optional>
+#include <set>
 #include <ClipperUtils.hpp>
 
 #include <boost/geometry/index/rtree.hpp>
@@ -305,6 +308,9 @@ void fill_config(PConf& pcfg, const ArrangeParams &params) {
     // Allow parallel execution.
     pcfg.parallel = params.parallel;
 
+    // Share the no-fit polygons among the plates and among the copies of the same object.
+    pcfg.nfp_cache = std::make_shared<typename decltype(pcfg.nfp_cache)::element_type>();
+
     // BBS: excluded regions in BBS bed
     for (auto& poly : params.excluded_regions)
         process_arrangeable(poly, pcfg.m_excluded_regions);
@@ -827,6 +833,9 @@ public:
         m_item_count += size_t(to - from);
         m_pck.execute(from, to);
         m_item_count = 0;
+        if (m_pconf.nfp_cache)
+            BOOST_LOG_TRIVIAL(debug) << "arrange nfp cache: " << m_pconf.nfp_cache->size() << " nfps, "
+                                     << m_pconf.nfp_cache->hits() << " hits of " << m_pconf.nfp_cache->lookups() << " lookups";
     }
 
     PConfig& config() { return m_pconf; }
@@ -1085,6 +1094,262 @@ static void process_arrangeable(const ArrangePolygon &arrpoly,
     item.filament_temp_type = arrpoly.filament_temp_type;
 }
 
+// Arrange the items by their bounding boxes into horizontal shelves of the
+// beds. Each item is tried on the open shelves of the current bed, then on a new
+// shelf above them, then on the next bed. The fixed items of a bed and the
+// excluded regions are obstacles which the shelves skip.
+static void shelf_arrange(std::vector<Item> &shapes, std::vector<Item> &excludes, const Box &bin, const ArrangeParams &params)
+{
+    auto overlaps = [](const Box &a, const Box &b) {
+        return a.minCorner().x() < b.maxCorner().x() && b.minCorner().x() < a.maxCorner().x() &&
+               a.minCorner().y() < b.maxCorner().y() && b.minCorner().y() < a.maxCorner().y();
+    };
+
+    std::vector<Item> regions;
+    for (const ArrangePolygon &region : params.excluded_regions)
+        process_arrangeable(region, regions);
+
+    std::vector<Box> common_obstacles;
+    for (const Item &region : regions)
+        common_obstacles.emplace_back(region.boundingBox());
+
+    std::map<int, std::vector<Box>> fixed_obstacles;
+    std::map<int, std::vector<int>> fixed_temp_types;
+    int last_fixed_bed = -1;
+    for (const Item &itm : excludes)
+        if (itm.binId() >= 0) {
+            fixed_obstacles[itm.binId()].emplace_back(itm.boundingBox());
+            if (!itm.is_virt_object)
+                fixed_temp_types[itm.binId()].emplace_back(itm.filament_temp_type);
+            last_fixed_bed = std::max(last_fixed_bed, itm.binId());
+        }
+
+    // Lay the items flat: the height of a shelf is given by its first item
+    for (Item &itm : shapes) {
+        itm.binId(UNARRANGED);
+        if (params.allow_rotations) {
+            itm.rotation(min_area_boundingbox_rotation(itm.transformedShape()));
+            Box bb = itm.boundingBox();
+            if (bb.height() > bb.width())
+                itm.rotate(PI / 2.);
+
+            bb = itm.boundingBox();
+            if (bb.width() > bin.width() || bb.height() > bin.height())
+                itm.rotate(fit_into_box_rotation(itm.transformedShape(), bin));
+        }
+    }
+
+    // Items printed with high and low temperature filaments must not share a bed (see Print::is_filaments_compatible()),
+    // therefore each group of compatible items is shelved onto beds of its own.
+    struct Group { int temp_type; std::vector<size_t> items; };
+    std::vector<Group> groups;
+    {
+        auto has_temp_type = [&shapes](int temp_type) {
+            return std::any_of(shapes.begin(), shapes.end(), [temp_type](const Item &itm) { return itm.filament_temp_type == temp_type; });
+        };
+        bool  has_high = has_temp_type(FilamentTempType::HighTemp);
+        bool  has_low  = has_temp_type(FilamentTempType::LowTemp);
+        Group high_group{has_high ? FilamentTempType::HighTemp : has_low ? FilamentTempType::LowTemp : FilamentTempType::Undefine, {}};
+        Group low_group{FilamentTempType::LowTemp, {}};
+        for (size_t i = 0; i < shapes.size(); ++i)
+            (has_high && shapes[i].filament_temp_type == FilamentTempType::LowTemp ? low_group : high_group).items.emplace_back(i);
+        for (Group *group : {&high_group, &low_group})
+            if (!group->items.empty())
+                groups.emplace_back(std::move(*group));
+    }
+
+    for (Group &group : groups)
+        std::stable_sort(group.items.begin(), group.items.end(), [&shapes](size_t i1, size_t i2) {
+            const Item &itm1 = shapes[i1], &itm2 = shapes[i2];
+            if (itm1.priority() != itm2.priority())
+                return itm1.priority() > itm2.priority();
+            if (itm1.bed_temp != itm2.bed_temp)
+                return itm1.bed_temp > itm2.bed_temp;
+            return itm1.boundingBox().height() > itm2.boundingBox().height();
+        });
+
+    struct Shelf { coord_t y, height, x; };
+
+    struct Bed {
+        int                     idx;
+        std::vector<Shelf>      shelves;
+        coord_t                 next_y;
+        std::vector<Box>        obstacles;
+    };
+
+    auto open_bed = [&](int idx) {
+        Bed bed{idx, {}, bin.minCorner().y(), common_obstacles};
+        auto it = fixed_obstacles.find(idx);
+        if (it != fixed_obstacles.end())
+            bed.obstacles.insert(bed.obstacles.end(), it->second.begin(), it->second.end());
+        return bed;
+    };
+
+    // A group does not use the beds filled by the previous groups, nor the beds with fixed items of incompatible filaments.
+    std::set<int> used_beds;
+    auto bed_accepts = [&](int idx, int temp_type) {
+        if (used_beds.count(idx) != 0)
+            return false;
+        auto it = fixed_temp_types.find(idx);
+        return it == fixed_temp_types.end() ||
+               std::all_of(it->second.begin(), it->second.end(), [temp_type](int t) { return Print::is_filaments_compatible({t, temp_type}); });
+    };
+
+    // Leftmost position from x in the row [y, y + h) where a box of width w
+    // does not collide with the obstacles of the bed.
+    auto find_x = [&bin, &overlaps](const Bed &bed, coord_t x, coord_t y, coord_t w, coord_t h) -> std::optional<coord_t> {
+        while (x + w <= bin.maxCorner().x()) {
+            Box  candidate{{x, y}, {x + w, y + h}};
+            auto hit = std::find_if(bed.obstacles.begin(), bed.obstacles.end(),
+                                    [&](const Box &o) { return overlaps(candidate, o); });
+            if (hit == bed.obstacles.end())
+                return x;
+            x = hit->maxCorner().x();
+        }
+        return {};
+    };
+
+    auto place = [&](Bed &bed, coord_t w, coord_t h) -> std::optional<Point> {
+        for (Shelf &shelf : bed.shelves)
+            if (h <= shelf.height)
+                if (auto x = find_x(bed, shelf.x, shelf.y, w, h)) {
+                    shelf.x = *x + w;
+                    return Point{*x, shelf.y};
+                }
+
+        coord_t y = bed.next_y;
+        while (y + h <= bin.maxCorner().y()) {
+            if (auto x = find_x(bed, bin.minCorner().x(), y, w, h)) {
+                bed.shelves.push_back({y, h, *x + w});
+                bed.next_y = y + h;
+                return Point{*x, y};
+            }
+
+            // The row is blocked, continue above the lowest obstacle in it
+            coord_t next_y = std::numeric_limits<coord_t>::max();
+            for (const Box &o : bed.obstacles)
+                if (o.minCorner().y() < y + h && o.maxCorner().y() > y)
+                    next_y = std::min(next_y, o.maxCorner().y());
+            if (next_y == std::numeric_limits<coord_t>::max())
+                break;
+            y = next_y;
+        }
+        return {};
+    };
+
+    size_t finished = 0;
+    for (const Group &group : groups) {
+        int first_bed = 0;
+        while (!bed_accepts(first_bed, group.temp_type))
+            ++first_bed;
+        Bed           bed = open_bed(first_bed);
+        std::set<int> group_beds;
+        for (size_t idx : group.items) {
+            if (params.stopcondition && params.stopcondition())
+                return;
+
+            Item &itm = shapes[idx];
+            Box   bb  = itm.boundingBox();
+            if (bb.width() > bin.width() || bb.height() > bin.height())
+                continue;
+
+            std::optional<Point> pos = place(bed, bb.width(), bb.height());
+            // Try the following beds until an empty one does not fit the item either
+            for (int next = bed.idx + 1; !pos; ++next) {
+                if (!bed_accepts(next, group.temp_type))
+                    continue;
+                Bed next_bed = open_bed(next);
+                pos          = place(next_bed, bb.width(), bb.height());
+                if (pos)
+                    bed = std::move(next_bed);
+                else if (next > last_fixed_bed)
+                    break;
+            }
+
+            if (!pos) {
+                BOOST_LOG_TRIVIAL(debug) << "shelf arrange: no place for " << itm.name;
+                continue;
+            }
+
+            itm.translate(*pos - bb.minCorner());
+            itm.binId(bed.idx);
+            group_beds.insert(bed.idx);
+
+            ++finished;
+            if (params.progressind)
+                params.progressind(unsigned(finished), itm.name);
+            if (params.on_packed) {
+                ArrangePolygon ap;
+                ap.bed_idx  = itm.binId();
+                ap.priority = itm.priority();
+                params.on_packed(ap);
+            }
+        }
+        used_beds.insert(group_beds.begin(), group_beds.end());
+    }
+
+    if (!params.do_final_align || !common_obstacles.empty())
+        return;
+
+    // Center the piles of the beds which have no obstacles
+    std::map<int, Box> piles;
+    for (const Item &itm : shapes)
+        if (itm.binId() >= 0 && fixed_obstacles.count(itm.binId()) == 0) {
+            auto it = piles.find(itm.binId());
+            if (it == piles.end())
+                piles.emplace(itm.binId(), itm.boundingBox());
+            else
+                it->second = sl::boundingBox(it->second, itm.boundingBox());
+        }
+
+    for (Item &itm : shapes) {
+        auto it = piles.find(itm.binId());
+        if (it != piles.end())
+            itm.translate(bin.center() - it->second.center());
+    }
+}
+
+// Rearrange the items of each bed packed by shelf_arrange with the nfp placer.
+// The shelf result of a bed is kept if the nfp placer can not fit all its items.
+template<class BinT>
+static void refine_shelf_arrangement(std::vector<Item> &shapes, std::vector<Item> &excludes, const BinT &bin, const ArrangeParams &params)
+{
+    std::map<int, std::vector<size_t>> beds;
+    for (size_t i = 0; i < shapes.size(); ++i)
+        if (shapes[i].binId() >= 0)
+            beds[shapes[i].binId()].emplace_back(i);
+
+    for (const auto &[bed_idx, indices] : beds) {
+        if (params.stopcondition && params.stopcondition())
+            break;
+
+        std::vector<Item> bed_items, bed_fixed;
+        bed_items.reserve(indices.size());
+        for (size_t i : indices) {
+            bed_items.emplace_back(shapes[i]);
+            bed_items.back().binId(UNARRANGED);
+        }
+        for (const Item &itm : excludes)
+            if (itm.binId() == bed_idx) {
+                bed_fixed.emplace_back(itm);
+                bed_fixed.back().binId(0);
+            }
+
+        _arrange(bed_items, bed_fixed, bin, params, params.progressind, params.stopcondition);
+
+        if (std::any_of(bed_items.begin(), bed_items.end(), [](const Item &itm) { return itm.binId() != 0; })) {
+            BOOST_LOG_TRIVIAL(debug) << "shelf arrange: keeping the shelves of bed " << bed_idx;
+            continue;
+        }
+
+        for (size_t k = 0; k < indices.size(); ++k) {
+            Item &itm = shapes[indices[k]];
+            itm.rotation(bed_items[k].rotation());
+            itm.translation(bed_items[k].translation());
+        }
+    }
+}
+
 template<class Fn> auto call_with_bed(const Points &bed, Fn &&fn)
 {
     if (bed.empty())
@@ -1135,7 +1400,21 @@ void arrange(ArrangePolygons &      arrangables,
 
     for (Item &itm : fixeditems) itm.inflate(scaled(-2. * EPSILON));
 
-    _arrange(items, fixeditems, to_nestbin(bed), params, params.progressind, params.stopcondition);
+    if constexpr (std::is_same_v<BedT, BoundingBox>) {
+        // The shelves do not model the clearances of sequential printing nor limit the filaments of a bed,
+        // the nfp placer takes care of these.
+        bool shelf = params.strategy != ArrangeStrategy::Nfp && !params.is_seq_print && params.allow_multi_materials_on_same_plate;
+        if (params.strategy != ArrangeStrategy::Nfp && !shelf)
+            BOOST_LOG_TRIVIAL(info) << "shelf arrange: sequential printing or a single material per plate requested, arranging with the nfp placer";
+        if (shelf) {
+            shelf_arrange(items, fixeditems, to_nestbin(bed), params);
+            if (params.strategy == ArrangeStrategy::ShelfRefined)
+                refine_shelf_arrangement(items, fixeditems, to_nestbin(bed), params);
+            for (Item &itm : items) itm.inflation(0);
+        } else
+            _arrange(items, fixeditems, to_nestbin(bed), params, params.progressind, params.stopcondition);
+    } else
+        _arrange(items, fixeditems, to_nestbin(bed), params, params.progressind, params.stopcondition);
 
     for(size_t i = 0; i < items.size(); ++i) {
         Point tr = items[i].translation();
@@ -122,6 +122,8 @@ struct ArrangeParams {
 
     bool do_final_align = true;
 
+    ArrangeStrategy strategy = ArrangeStrategy::Nfp;
+
     //BBS: add specific arrange params
     bool  allow_multi_materials_on_same_plate = true;
     bool  avoid_extrusion_cali_region         = true;
@@ -172,6 +174,7 @@ struct ArrangeParams {
         ret += "\"clearance_height_to_lid\":" + std::to_string(clearance_height_to_lid) + ",";
         ret += "\"clearance_radius\":" + std::to_string(clearance_radius) + ",";
         ret += "\"printable_height\":" + std::to_string(printable_height) + ",";
+        ret += "\"strategy\":" + std::to_string(int(strategy)) + ",";
         return ret;
     }
 
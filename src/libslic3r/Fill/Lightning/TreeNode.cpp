@@ -7,131 +7,162 @@
 
 namespace Slic3r::FillLightning {
 
-coord_t Node::getWeightedDistance(const Point& unsupported_location, const coord_t& supporting_radius) const
+coord_t NodeArena::getWeightedDistance(NodeIdx node, const Point& unsupported_location, const coord_t& supporting_radius) const
 {
     constexpr coord_t min_valence_for_boost = 0;
     constexpr coord_t max_valence_for_boost = 4;
     constexpr coord_t valence_boost_multiplier = 4;
 
-    const size_t valence = (!m_is_root) + m_children.size();
+    const Node&   n = m_nodes[node];
+    const size_t valence = (!n.m_is_root) + n.m_children.size();
     const coord_t valence_boost = (min_valence_for_boost < valence && valence < max_valence_for_boost) ? valence_boost_multiplier * supporting_radius : 0;
-    const auto dist_here = coord_t((getLocation() - unsupported_location).cast<double>().norm());
+    const auto dist_here = coord_t((n.m_p - unsupported_location).cast<double>().norm());
     return dist_here - valence_boost;
 }
 
-bool Node::hasOffspring(const NodeSPtr& to_be_checked) const
+bool NodeArena::hasOffspring(NodeIdx node, NodeIdx to_be_checked) const
 {
-    if (to_be_checked == shared_from_this())
+    if (to_be_checked == node)
         return true;
 
-    for (auto& child_ptr : m_children)
-        if (child_ptr->hasOffspring(to_be_checked)) 
+    for (NodeIdx child : m_nodes[node].m_children)
+        if (hasOffspring(child, to_be_checked))
             return true;
 
     return false;
 }
 
-NodeSPtr Node::addChild(const Point& child_loc)
+NodeIdx NodeArena::addChild(NodeIdx parent, const Point& child_loc)
 {
-    assert(m_p != child_loc);
-    NodeSPtr child = Node::create(child_loc);
-    return addChild(child);
+    assert(m_nodes[parent].m_p != child_loc);
+    NodeIdx child = this->create(child_loc);
+    return addChild(parent, child);
 }
 
-NodeSPtr Node::addChild(NodeSPtr& new_child)
+NodeIdx NodeArena::addChild(NodeIdx parent, NodeIdx new_child)
 {
-    assert(new_child != shared_from_this());
+    assert(new_child != parent);
     //assert(p != new_child->p); // NOTE: No problem for now. Issue to solve later. Maybe even afetr final. Low prio.
-    m_children.push_back(new_child);
-    new_child->m_parent = shared_from_this();
-    new_child->m_is_root = false;
+    m_nodes[parent].m_children.push_back(new_child);
+    Node &child = m_nodes[new_child];
+    child.m_parent  = parent;
+    child.m_is_root = false;
     return new_child;
 }
 
-void Node::propagateToNextLayer(
-    std::vector<NodeSPtr>& next_trees,
+void NodeArena::propagateToNextLayer(
+    NodeIdx node,
+    NodeArena& next_nodes,
+    std::vector<NodeIdx>& next_trees,
     const Polygons& next_outlines,
     const EdgeGrid::Grid& outline_locator,
     const coord_t prune_distance,
     const coord_t smooth_magnitude,
     const coord_t max_remove_colinear_dist) const
 {
-    auto tree_below = deepCopy();
-    tree_below->prune(prune_distance);
-    tree_below->straighten(smooth_magnitude, max_remove_colinear_dist);
-    if (tree_below->realign(next_outlines, outline_locator, next_trees))
+    assert(&next_nodes != this);
+    NodeIdx tree_below = deepCopy(node, next_nodes);
+    next_nodes.prune(tree_below, prune_distance);
+    next_nodes.straighten(tree_below, smooth_magnitude, max_remove_colinear_dist);
+    if (next_nodes.realign(tree_below, next_outlines, outline_locator, next_trees))
         next_trees.push_back(tree_below);
 }
 
 // NOTE: Depth-first, as currently implemented.
 //       Skips the root (because that has no root itself), but all initial nodes will have the root point anyway.
-void Node::visitBranches(const std::function<void(const Point&, const Point&)>& visitor) const
+void NodeArena::visitBranches(NodeIdx node, const std::function<void(const Point&, const Point&)>& visitor) const
 {
-    for (const auto& node : m_children) {
-        assert(node->m_parent.lock() == shared_from_this());
-        visitor(m_p, node->m_p);
-        node->visitBranches(visitor);
+    for (NodeIdx child : m_nodes[node].m_children) {
+        assert(m_nodes[child].m_parent == node);
+        visitor(m_nodes[node].m_p, m_nodes[child].m_p);
+        visitBranches(child, visitor);
     }
 }
 
 // NOTE: Depth-first, as currently implemented.
-void Node::visitNodes(const std::function<void(NodeSPtr)>& visitor)
+void NodeArena::visitNodes(NodeIdx node, const std::function<void(NodeIdx)>& visitor) const
 {
-    visitor(shared_from_this());
-    for (const auto& node : m_children) {
-        assert(node->m_parent.lock() == shared_from_this());
-        node->visitNodes(visitor);
+    visitor(node);
+    for (NodeIdx child : m_nodes[node].m_children) {
+        assert(m_nodes[child].m_parent == node);
+        visitNodes(child, visitor);
     }
 }
 
-Node::Node(const Point& p, const std::optional<Point>& last_grounding_location /*= std::nullopt*/) : 
-    m_is_root(true), m_p(p), m_last_grounding_location(last_grounding_location)
-{}
-
-NodeSPtr Node::deepCopy() const
+NodeIdx NodeArena::deepCopy(NodeIdx node, NodeArena& dst) const
 {
-    NodeSPtr local_root = Node::create(m_p);
-    local_root->m_is_root = m_is_root;
-    if (m_is_root)
-    {
-        local_root->m_last_grounding_location = m_last_grounding_location.value_or(m_p);
+    const Node& src_node   = m_nodes[node];
+    NodeIdx     local_root = dst.create(src_node.m_p);
+    dst.m_nodes[local_root].m_is_root = src_node.m_is_root;
+    if (src_node.m_is_root)
+        dst.m_nodes[local_root].m_last_grounding_location = src_node.m_last_grounding_location.value_or(src_node.m_p);
+    dst.m_nodes[local_root].m_children.reserve(src_node.m_children.size());
+    for (NodeIdx child : src_node.m_children) {
+        // dst.create() may reallocate, thus the destination nodes are always accessed by index.
+        NodeIdx child_copy = deepCopy(child, dst);
+        dst.m_nodes[child_copy].m_parent = local_root;
+        dst.m_nodes[local_root].m_children.push_back(child_copy);
     }
-    local_root->m_children.reserve(m_children.size());
-    for (const auto& node : m_children)
-    {
-        NodeSPtr child = node->deepCopy();
-        child->m_parent = local_root;
-        local_root->m_children.push_back(child);
+    return local_root;
+}
+
+NodeIdx NodeArena::copyTree(NodeIdx node, NodeArena& dst) const
+{
+    const Node& src_node   = m_nodes[node];
+    NodeIdx     local_root = NodeIdx(dst.m_nodes.size());
+    dst.m_nodes.emplace_back(src_node);
+    dst.m_nodes[local_root].m_parent = NoNode;
+    dst.m_nodes[local_root].m_children.clear();
+    for (NodeIdx child : src_node.m_children) {
+        NodeIdx child_copy = copyTree(child, dst);
+        dst.m_nodes[child_copy].m_parent = local_root;
+        dst.m_nodes[local_root].m_children.push_back(child_copy);
     }
     return local_root;
 }
 
-void Node::reroot(const NodeSPtr &new_parent)
+void NodeArena::compact(std::vector<NodeIdx>& tree_roots)
 {
-    if (! m_is_root) {
-        auto old_parent = m_parent.lock();
-        old_parent->reroot(shared_from_this());
-        m_children.push_back(old_parent);
+    size_t num_reachable = 0;
+    for (NodeIdx root : tree_roots)
+        visitNodes(root, [&num_reachable](NodeIdx) { ++ num_reachable; });
+    if (num_reachable == m_nodes.size())
+        return;
+
+    NodeArena compacted;
+    compacted.m_nodes.reserve(num_reachable);
+    for (NodeIdx &root : tree_roots)
+        root = copyTree(root, compacted);
+    m_nodes = std::move(compacted.m_nodes);
+}
+
+void NodeArena::reroot(NodeIdx node, NodeIdx new_parent)
+{
+    if (! m_nodes[node].m_is_root) {
+        NodeIdx old_parent = m_nodes[node].m_parent;
+        reroot(old_parent, node);
+        m_nodes[node].m_children.push_back(old_parent);
     }
 
-    if (new_parent) {
-        m_children.erase(std::remove(m_children.begin(), m_children.end(), new_parent), m_children.end());
-        m_is_root = false;
-        m_parent = new_parent;
+    Node &n = m_nodes[node];
+    if (new_parent != NoNode) {
+        n.m_children.erase(std::remove(n.m_children.begin(), n.m_children.end(), new_parent), n.m_children.end());
+        n.m_is_root = false;
+        n.m_parent  = new_parent;
     } else {
-        m_is_root = true;
-        m_parent.reset();
+        n.m_is_root = true;
+        n.m_parent  = NoNode;
     }
 }
 
-NodeSPtr Node::closestNode(const Point& loc)
+NodeIdx NodeArena::closestNode(NodeIdx node, const Point& loc) const
 {
-    NodeSPtr result = shared_from_this();
-    auto closest_dist2 = coord_t((m_p - loc).cast<double>().norm());
+    NodeIdx result = node;
+    auto closest_dist2 = coord_t((m_nodes[node].m_p - loc).cast<double>().norm());
 
-    for (const auto& child : m_children) {
-        NodeSPtr candidate_node = child->closestNode(loc);
-        const auto child_dist2 = coord_t((candidate_node->m_p - loc).cast<double>().norm());
+    for (NodeIdx child : m_nodes[node].m_children) {
+        NodeIdx candidate_node = closestNode(child, loc);
+        const auto child_dist2 = coord_t((m_nodes[candidate_node].m_p - loc).cast<double>().norm());
         if (child_dist2 < closest_dist2) {
             closest_dist2 = child_dist2;
             result = candidate_node;
@@ -163,7 +194,7 @@ bool lineSegmentPolygonsIntersection(const Point& a, const Point& b, const EdgeG
                 // End points of the line segment and their vector.
                 auto segment = grid.segment(*it_contour_and_segment);
                 if (Vec2d ip; Geometry::segment_segment_intersection(segment.first.cast<double>(), segment.second.cast<double>(), this->line_a, this->line_b, ip))
-                    if (double d = (this->intersection_pt - this->line_b).squaredNorm(); d < d2min) {
+                    if (double d = (ip - this->line_b).squaredNorm(); d < d2min) {
                         this->d2min = d;
                         this->intersection_pt = ip;
                     }
@@ -187,52 +218,57 @@ bool lineSegmentPolygonsIntersection(const Point& a, const Point& b, const EdgeG
     return false;
 }
 
-bool Node::realign(const Polygons& outlines, const EdgeGrid::Grid& outline_locator, std::vector<NodeSPtr>& rerooted_parts)
+bool NodeArena::realign(NodeIdx node, const Polygons& outlines, const EdgeGrid::Grid& outline_locator, std::vector<NodeIdx>& rerooted_parts)
 {
     if (outlines.empty())
         return false;
 
-    if (inside(outlines, m_p)) {
+    // realign() does not allocate nodes, thus references into m_nodes stay valid.
+    Node &n = m_nodes[node];
+    if (inside(outlines, n.m_p)) {
         // Only keep children that have an unbroken connection to here, realign will put the rest in rerooted parts due to recursion:
         Point coll;
         bool reground_me = false;
-        m_children.erase(std::remove_if(m_children.begin(), m_children.end(), [&](const NodeSPtr &child) {
-            bool connect_branch = child->realign(outlines, outline_locator, rerooted_parts);
+        n.m_children.erase(std::remove_if(n.m_children.begin(), n.m_children.end(), [&](NodeIdx child_idx) {
+            bool connect_branch = realign(child_idx, outlines, outline_locator, rerooted_parts);
+            Node &child = m_nodes[child_idx];
             // Find an intersection of the line segment from p to child->p, at maximum outline_locator.resolution() * 2 distance from p.
-            if (connect_branch && lineSegmentPolygonsIntersection(child->m_p, m_p, outline_locator, coll, outline_locator.resolution() * 2)) {
-                child->m_last_grounding_location.reset();
-                child->m_parent.reset();
-                child->m_is_root = true;
-                rerooted_parts.push_back(child);
+            if (connect_branch && lineSegmentPolygonsIntersection(child.m_p, n.m_p, outline_locator, coll, outline_locator.resolution() * 2)) {
+                child.m_last_grounding_location.reset();
+                child.m_parent = NoNode;
+                child.m_is_root = true;
+                rerooted_parts.push_back(child_idx);
                 reground_me = true;
                 connect_branch = false;
             }
             return ! connect_branch;
-        }), m_children.end());
+        }), n.m_children.end());
         if (reground_me)
-            m_last_grounding_location.reset();
+            n.m_last_grounding_location.reset();
         return true;
     }
 
     // 'Lift' any decendants out of this tree:
-    for (auto& child : m_children)
-        if (child->realign(outlines, outline_locator, rerooted_parts)) {
-            child->m_last_grounding_location = m_p;
-            child->m_parent.reset();
-            child->m_is_root = true;
-            rerooted_parts.push_back(child);
+    for (NodeIdx child_idx : n.m_children)
+        if (realign(child_idx, outlines, outline_locator, rerooted_parts)) {
+            Node &child = m_nodes[child_idx];
+            child.m_last_grounding_location = n.m_p;
+            child.m_parent = NoNode;
+            child.m_is_root = true;
+            rerooted_parts.push_back(child_idx);
         }
 
-    m_children.clear();
+    n.m_children.clear();
     return false;
 }
 
-void Node::straighten(const coord_t magnitude, const coord_t max_remove_colinear_dist)
+void NodeArena::straighten(NodeIdx node, const coord_t magnitude, const coord_t max_remove_colinear_dist)
 {
-    straighten(magnitude, m_p, 0, int64_t(max_remove_colinear_dist) * int64_t(max_remove_colinear_dist));
+    straighten(node, magnitude, m_nodes[node].m_p, 0, int64_t(max_remove_colinear_dist) * int64_t(max_remove_colinear_dist));
 }
 
-Node::RectilinearJunction Node::straighten(
+NodeArena::RectilinearJunction NodeArena::straighten(
+    NodeIdx node,
     const coord_t magnitude,
     const Point& junction_above,
     const coord_t accumulated_dist,
@@ -241,12 +277,14 @@ Node::RectilinearJunction Node::straighten(
     constexpr coord_t junction_magnitude_factor_numerator = 3;
     constexpr coord_t junction_magnitude_factor_denominator = 4;
 
+    // straighten() does not allocate nodes, thus references into m_nodes stay valid.
+    Node &n = m_nodes[node];
     const coord_t junction_magnitude = magnitude * junction_magnitude_factor_numerator / junction_magnitude_factor_denominator;
-    if (m_children.size() == 1)
+    if (n.m_children.size() == 1)
     {
-        auto child_p = m_children.front();
-        auto child_dist = coord_t((m_p - child_p->m_p).cast<double>().norm());
-        RectilinearJunction junction_below = child_p->straighten(magnitude, junction_above, accumulated_dist + child_dist, max_remove_colinear_dist2);
+        NodeIdx child_idx = n.m_children.front();
+        auto child_dist = coord_t((n.m_p - m_nodes[child_idx].m_p).cast<double>().norm());
+        RectilinearJunction junction_below = straighten(child_idx, magnitude, junction_above, accumulated_dist + child_dist, max_remove_colinear_dist2);
         coord_t total_dist_to_junction_below = junction_below.total_recti_dist;
         const Point& a = junction_above;
         Point        b = junction_below.junction_loc;
@@ -254,26 +292,28 @@ Node::RectilinearJunction Node::straighten(
         {
             Point ab = b - a;
             Point destination = (a.cast<int64_t>() + ab.cast<int64_t>() * int64_t(accumulated_dist) / std::max(int64_t(1), int64_t(total_dist_to_junction_below))).cast<coord_t>();
-            if ((destination - m_p).cast<int64_t>().squaredNorm() <= int64_t(magnitude) * int64_t(magnitude))
-                m_p = destination;
+            if ((destination - n.m_p).cast<int64_t>().squaredNorm() <= int64_t(magnitude) * int64_t(magnitude))
+                n.m_p = destination;
             else
-                m_p += ((destination - m_p).cast<double>().normalized() * magnitude).cast<coord_t>();
+                n.m_p += ((destination - n.m_p).cast<double>().normalized() * magnitude).cast<coord_t>();
         }
         { // remove nodes on linear segments
             constexpr coord_t close_enough = 10;
 
-            child_p = m_children.front(); //recursive call to straighten might have removed the child
-            const NodeSPtr& parent_node = m_parent.lock();
-            if (parent_node &&
-                (child_p->m_p - parent_node->m_p).cast<int64_t>().squaredNorm() < max_remove_colinear_dist2 &&
-                Line::distance_to_squared(m_p, parent_node->m_p, child_p->m_p) < close_enough * close_enough) {
-                child_p->m_parent = m_parent;
-                for (auto& sibling : parent_node->m_children)
-                { // find this node among siblings
-                    if (sibling == shared_from_this())
-                    {
-                        sibling = child_p; // replace this node by child
-                        break;
+            child_idx = n.m_children.front(); //recursive call to straighten might have removed the child
+            Node &child = m_nodes[child_idx];
+            if (n.m_parent != NoNode) {
+                Node &parent_node = m_nodes[n.m_parent];
+                if ((child.m_p - parent_node.m_p).cast<int64_t>().squaredNorm() < max_remove_colinear_dist2 &&
+                    Line::distance_to_squared(n.m_p, parent_node.m_p, child.m_p) < close_enough * close_enough) {
+                    child.m_parent = n.m_parent;
+                    for (NodeIdx& sibling : parent_node.m_children)
+                    { // find this node among siblings
+                        if (sibling == node)
+                        {
+                            sibling = child_idx; // replace this node by child
+                            break;
+                        }
                     }
                 }
             }
@@ -283,62 +323,64 @@ Node::RectilinearJunction Node::straighten(
     else
     {
         constexpr coord_t weight = 1000;
-        Point junction_moving_dir = ((junction_above - m_p).cast<double>().normalized() * weight).cast<coord_t>();
+        Point junction_moving_dir = ((junction_above - n.m_p).cast<double>().normalized() * weight).cast<coord_t>();
         bool prevent_junction_moving = false;
-        for (auto& child_p : m_children)
+        for (NodeIdx child_idx : n.m_children)
         {
-            const auto child_dist = coord_t((m_p - child_p->m_p).cast<double>().norm());
-            RectilinearJunction below = child_p->straighten(magnitude, m_p, child_dist, max_remove_colinear_dist2);
+            const auto child_dist = coord_t((n.m_p - m_nodes[child_idx].m_p).cast<double>().norm());
+            RectilinearJunction below = straighten(child_idx, magnitude, n.m_p, child_dist, max_remove_colinear_dist2);
 
-            junction_moving_dir += ((below.junction_loc - m_p).cast<double>().normalized() * weight).cast<coord_t>();
+            junction_moving_dir += ((below.junction_loc - n.m_p).cast<double>().normalized() * weight).cast<coord_t>();
             if (below.total_recti_dist < magnitude) // TODO: make configurable?
             {
                 prevent_junction_moving = true; // prevent flipflopping in branches due to straightening and junctoin moving clashing
             }
         }
-        if (junction_moving_dir != Point(0, 0) && ! m_children.empty() && ! m_is_root && ! prevent_junction_moving)
+        if (junction_moving_dir != Point(0, 0) && ! n.m_children.empty() && ! n.m_is_root && ! prevent_junction_moving)
         {
             auto junction_moving_dir_len = coord_t(junction_moving_dir.norm());
             if (junction_moving_dir_len > junction_magnitude)
             {
                 junction_moving_dir = junction_moving_dir * junction_magnitude / junction_moving_dir_len;
             }
-            m_p += junction_moving_dir;
+            n.m_p += junction_moving_dir;
         }
-        return RectilinearJunction{ accumulated_dist, m_p };
+        return RectilinearJunction{ accumulated_dist, n.m_p };
     }
 }
 
 // Prune the tree from the extremeties (leaf-nodes) until the pruning distance is reached.
-coord_t Node::prune(const coord_t& pruning_distance)
+coord_t NodeArena::prune(NodeIdx node, const coord_t& pruning_distance)
 {
     if (pruning_distance <= 0)
         return 0;
 
+    // prune() does not allocate nodes, thus references into m_nodes stay valid.
+    Node &n = m_nodes[node];
     coord_t max_distance_pruned = 0;
-    for (auto child_it = m_children.begin(); child_it != m_children.end(); ) {
-        auto& child = *child_it;
-        coord_t dist_pruned_child = child->prune(pruning_distance);
+    for (auto child_it = n.m_children.begin(); child_it != n.m_children.end(); ) {
+        Node &child = m_nodes[*child_it];
+        coord_t dist_pruned_child = prune(*child_it, pruning_distance);
         if (dist_pruned_child >= pruning_distance)
         { // pruning is finished for child; dont modify further
             max_distance_pruned = std::max(max_distance_pruned, dist_pruned_child);
             ++child_it;
         } else {
-            const Point a = getLocation();
-            const Point b = child->getLocation();
+            const Point a = n.m_p;
+            const Point b = child.m_p;
             const Point ba = a - b;
             const auto ab_len = coord_t(ba.cast<double>().norm());
-            if (dist_pruned_child + ab_len <= pruning_distance) { 
+            if (dist_pruned_child + ab_len <= pruning_distance) {
                 // we're still in the process of pruning
-                assert(child->m_children.empty() && "when pruning away a node all it's children must already have been pruned away");
+                assert(child.m_children.empty() && "when pruning away a node all it's children must already have been pruned away");
                 max_distance_pruned = std::max(max_distance_pruned, dist_pruned_child + ab_len);
-                child_it = m_children.erase(child_it);
+                child_it = n.m_children.erase(child_it);
             } else {
                 // pruning stops in between this node and the child
-                const Point n = b + (ba.cast<double>().normalized() * (pruning_distance - dist_pruned_child)).cast<coord_t>();
-                assert(std::abs((n - b).cast<double>().norm() + dist_pruned_child - pruning_distance) < 10 && "total pruned distance must be equal to the pruning_distance");
+                const Point pn = b + (ba.cast<double>().normalized() * (pruning_distance - dist_pruned_child)).cast<coord_t>();
+                assert(std::abs((pn - b).cast<double>().norm() + dist_pruned_child - pruning_distance) < 10 && "total pruned distance must be equal to the pruning_distance");
                 max_distance_pruned = std::max(max_distance_pruned, pruning_distance);
-                child->setLocation(n);
+                child.m_p = pn;
                 ++child_it;
             }
         }
@@ -347,36 +389,36 @@ coord_t Node::prune(const coord_t& pruning_distance)
     return max_distance_pruned;
 }
 
-void Node::convertToPolylines(Polylines &output, const coord_t line_overlap) const
+void NodeArena::convertToPolylines(NodeIdx node, Polylines &output, const coord_t line_overlap) const
 {
     Polylines result;
     result.emplace_back();
-    convertToPolylines(0, result);
+    convertToPolylines(node, 0, result);
     removeJunctionOverlap(result, line_overlap);
     append(output, std::move(result));
 }
 
-void Node::convertToPolylines(size_t long_line_idx, Polylines &output) const
+void NodeArena::convertToPolylines(NodeIdx node, size_t long_line_idx, Polylines &output) const
 {
-    if (m_children.empty()) {
-        output[long_line_idx].points.push_back(m_p);
+    const Node &n = m_nodes[node];
+    if (n.m_children.empty()) {
+        output[long_line_idx].points.push_back(n.m_p);
         return;
     }
-    size_t first_child_idx = rand() % m_children.size();
-    m_children[first_child_idx]->convertToPolylines(long_line_idx, output);
-    output[long_line_idx].points.push_back(m_p);
+    size_t first_child_idx = rand() % n.m_children.size();
+    convertToPolylines(n.m_children[first_child_idx], long_line_idx, output);
+    output[long_line_idx].points.push_back(n.m_p);
 
-    for (size_t idx_offset = 1; idx_offset < m_children.size(); idx_offset++) {
-        size_t child_idx = (first_child_idx + idx_offset) % m_children.size();
-        const Node& child = *m_children[child_idx];
+    for (size_t idx_offset = 1; idx_offset < n.m_children.size(); idx_offset++) {
+        size_t child_idx = (first_child_idx + idx_offset) % n.m_children.size();
         output.emplace_back();
         size_t child_line_idx = output.size() - 1;
-        child.convertToPolylines(child_line_idx, output);
-        output[child_line_idx].points.emplace_back(m_p);
+        convertToPolylines(n.m_children[child_idx], child_line_idx, output);
+        output[child_line_idx].points.emplace_back(n.m_p);
     }
 }
 
-void Node::removeJunctionOverlap(Polylines &result_lines, const coord_t line_overlap) const
+void NodeArena::removeJunctionOverlap(Polylines &result_lines, const coord_t line_overlap)
 {
     const coord_t reduction    = line_overlap;
     size_t        res_line_idx = 0;
@@ -413,27 +455,23 @@ void Node::removeJunctionOverlap(Polylines &result_lines, const coord_t line_ove
 }
 
 #ifdef LIGHTNING_TREE_NODE_DEBUG_OUTPUT
-void export_to_svg(const NodeSPtr &root_node, SVG &svg)
+void export_to_svg(const NodeArena &nodes, NodeIdx root_node, SVG &svg)
 {
-    for (const NodeSPtr &children : root_node->m_children) {
-        svg.draw(Line(root_node->getLocation(), children->getLocation()), "red");
-        export_to_svg(children, svg);
+    for (NodeIdx child : nodes[root_node].m_children) {
+        svg.draw(Line(nodes.getLocation(root_node), nodes.getLocation(child)), "red");
+        export_to_svg(nodes, child, svg);
     }
 }
 
-void export_to_svg(const std::string &path, const Polygons &contour, const std::vector<NodeSPtr> &root_nodes) {
+void export_to_svg(const std::string &path, const Polygons &contour, const NodeArena &nodes, const std::vector<NodeIdx> &root_nodes) {
     BoundingBox bbox = get_extents(contour);
 
     bbox.offset(SCALED_EPSILON);
     SVG svg(path, bbox);
     svg.draw_outline(contour, "blue");
 
-    for (const NodeSPtr &root_node: root_nodes) {
-        for (const NodeSPtr &children: root_node->m_children) {
-            svg.draw(Line(root_node->getLocation(), children->getLocation()), "red");
-            export_to_svg(children, svg);
-        }
-    }
+    for (NodeIdx root_node : root_nodes)
+        export_to_svg(nodes, root_node, svg);
 }
 #endif /* LIGHTNING_TREE_NODE_DEBUG_OUTPUT */
 
@@ -17,6 +17,7 @@
 #include <limits>
 #include <stdexcept>
 #include <iomanip>
+#include <atomic>
 
 #include <boost/assign.hpp>
 #include <boost/bimap.hpp>
@@ -728,6 +729,68 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
 
             bool empty() { return vertices.empty() || triangles.empty(); }
 
+            // <vertices> always precede <triangles>. A closed mesh has about twice as many triangles as vertices,
+            // so reserve for that up front instead of growing the six per-triangle vectors one reallocation at a time.
+            void reset_triangles()
+            {
+                triangles.clear();
+                size_t expected = 2 * vertices.size();
+                triangles.reserve(expected);
+                for (std::vector<std::string> *v : { &custom_supports, &custom_seam, &mmu_segmentation, &fuzzy_skin, &face_properties })
+                    v->reserve(v->size() + expected);
+            }
+
+            // Meshes hold millions of <vertex> and <triangle> elements, so their attributes are scanned
+            // in a single pass instead of being looked up one by one with bbs_get_attribute_value_xxx().
+            void append_vertex(const char** attributes, unsigned int num_attributes, float unit_factor)
+            {
+                Vec3f pt = Vec3f::Zero();
+                if (attributes != nullptr && num_attributes % 2 == 0)
+                    for (unsigned int a = 0; a < num_attributes; a += 2) {
+                        const char *key = attributes[a];
+                        if (key[0] >= 'x' && key[0] <= 'z' && key[1] == 0) {
+                            const char *text = attributes[a + 1];
+                            fast_float::from_chars(text, text + strlen(text), pt(key[0] - 'x'));
+                        }
+                    }
+                vertices.emplace_back(unit_factor * pt);
+            }
+
+            void append_triangle(const char** attributes, unsigned int num_attributes)
+            {
+                Vec3i32     v             = Vec3i32::Zero();
+                const char *supports      = nullptr;
+                const char *seam          = nullptr;
+                const char *mmu           = nullptr;
+                const char *fuzzy         = nullptr;
+                const char *face_property = nullptr;
+                if (attributes != nullptr && num_attributes % 2 == 0)
+                    for (unsigned int a = 0; a < num_attributes; a += 2) {
+                        const char *key  = attributes[a];
+                        const char *text = attributes[a + 1];
+                        if (key[0] == 'v' && key[1] >= '1' && key[1] <= '3' && key[2] == 0)
+                            boost::spirit::qi::parse(text, text + strlen(text), boost::spirit::qi::int_, v(key[1] - '1'));
+                        else if (::strcmp(key, CUSTOM_SUPPORTS_ATTR) == 0)
+                            supports = text;
+                        else if (::strcmp(key, CUSTOM_SEAM_ATTR) == 0)
+                            seam = text;
+                        else if (::strcmp(key, MMU_SEGMENTATION_ATTR) == 0)
+                            mmu = text;
+                        else if (::strcmp(key, CUSTOM_FUZZY_SKIN_ATTR) == 0)
+                            fuzzy = text;
+                        else if (::strcmp(key, FACE_PROPERTY_ATTR) == 0)
+                            face_property = text;
+                    }
+                triangles.emplace_back(v);
+                auto append = [](std::vector<std::string> &dst, const char *text) { if (text) dst.emplace_back(text); else dst.emplace_back(); };
+                append(custom_supports, supports);
+                append(custom_seam, seam);
+                append(mmu_segmentation, mmu);
+                append(fuzzy_skin, fuzzy);
+                // BBS
+                append(face_properties, face_property);
+            }
+
             // backup & restore
             void swap(Geometry& o) {
                 std::swap(vertices, o.vertices);
@@ -3653,10 +3716,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         // appends the vertex coordinates
         // missing values are set equal to ZERO
         if (m_curr_object)
-            m_curr_object->geometry.vertices.emplace_back(
-                m_unit_factor * bbs_get_attribute_value_float(attributes, num_attributes, X_ATTR),
-                m_unit_factor * bbs_get_attribute_value_float(attributes, num_attributes, Y_ATTR),
-                m_unit_factor * bbs_get_attribute_value_float(attributes, num_attributes, Z_ATTR));
+            m_curr_object->geometry.append_vertex(attributes, num_attributes, m_unit_factor);
         return true;
     }
 
@@ -3670,7 +3730,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
     {
         // reset current triangles
         if (m_curr_object)
-            m_curr_object->geometry.triangles.clear();
+            m_curr_object->geometry.reset_triangles();
         return true;
     }
 
@@ -3691,19 +3751,8 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
 
         // appends the triangle's vertices indices
         // missing values are set equal to ZERO
-        if (m_curr_object) {
-            m_curr_object->geometry.triangles.emplace_back(
-                bbs_get_attribute_value_int(attributes, num_attributes, V1_ATTR),
-                bbs_get_attribute_value_int(attributes, num_attributes, V2_ATTR),
-                bbs_get_attribute_value_int(attributes, num_attributes, V3_ATTR));
-
-            m_curr_object->geometry.custom_supports.push_back(bbs_get_attribute_value_string(attributes, num_attributes, CUSTOM_SUPPORTS_ATTR));
-            m_curr_object->geometry.custom_seam.push_back(bbs_get_attribute_value_string(attributes, num_attributes, CUSTOM_SEAM_ATTR));
-            m_curr_object->geometry.mmu_segmentation.push_back(bbs_get_attribute_value_string(attributes, num_attributes, MMU_SEGMENTATION_ATTR));
-            m_curr_object->geometry.fuzzy_skin.push_back(bbs_get_attribute_value_string(attributes, num_attributes, CUSTOM_FUZZY_SKIN_ATTR));
-            // BBS
-            m_curr_object->geometry.face_properties.push_back(bbs_get_attribute_value_string(attributes, num_attributes, FACE_PROPERTY_ATTR));
-        }
+        if (m_curr_object)
+            m_curr_object->geometry.append_triangle(attributes, num_attributes);
         return true;
     }
 
@@ -5338,10 +5387,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         // appends the vertex coordinates
         // missing values are set equal to ZERO
         if (current_object)
-            current_object->geometry.vertices.emplace_back(
-                object_unit_factor * bbs_get_attribute_value_float(attributes, num_attributes, X_ATTR),
-                object_unit_factor * bbs_get_attribute_value_float(attributes, num_attributes, Y_ATTR),
-                object_unit_factor * bbs_get_attribute_value_float(attributes, num_attributes, Z_ATTR));
+            current_object->geometry.append_vertex(attributes, num_attributes, object_unit_factor);
         return true;
     }
 
@@ -5355,7 +5401,7 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
     {
         // reset current triangles
         if (current_object)
-            current_object->geometry.triangles.clear();
+            current_object->geometry.reset_triangles();
         return true;
     }
 
@@ -5376,19 +5422,8 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
 
         // appends the triangle's vertices indices
         // missing values are set equal to ZERO
-        if (current_object) {
-            current_object->geometry.triangles.emplace_back(
-                bbs_get_attribute_value_int(attributes, num_attributes, V1_ATTR),
-                bbs_get_attribute_value_int(attributes, num_attributes, V2_ATTR),
-                bbs_get_attribute_value_int(attributes, num_attributes, V3_ATTR));
-
-            current_object->geometry.custom_supports.push_back(bbs_get_attribute_value_string(attributes, num_attributes, CUSTOM_SUPPORTS_ATTR));
-            current_object->geometry.custom_seam.push_back(bbs_get_attribute_value_string(attributes, num_attributes, CUSTOM_SEAM_ATTR));
-            current_object->geometry.mmu_segmentation.push_back(bbs_get_attribute_value_string(attributes, num_attributes, MMU_SEGMENTATION_ATTR));
-            current_object->geometry.fuzzy_skin.push_back(bbs_get_attribute_value_string(attributes, num_attributes, CUSTOM_FUZZY_SKIN_ATTR));
-            // BBS
-            current_object->geometry.face_properties.push_back(bbs_get_attribute_value_string(attributes, num_attributes, FACE_PROPERTY_ATTR));
-        }
+        if (current_object)
+            current_object->geometry.append_triangle(attributes, num_attributes);
         return true;
     }
 
@@ -6862,31 +6897,45 @@ void PlateData::parse_filament_info(GCodeProcessorResult *result)
         _add_relationships_file_to_archive(archive, MODEL_RELS_FILE, object_paths, {"http://schemas.microsoft.com/3dmanufacturing/2013/01/3dmodel"});
 
         if (!m_from_backup_save) {
-            boost::mutex mutex;
-            tbb::parallel_for(tbb::blocked_range<size_t>(0, objects_data.size(), 1), [this, &mutex, &model, objects = model.objects, &objects_data, &object_paths, main = &archive, project](const tbb::blocked_range<size_t>& range) {
+            // Serialize and deflate every object model into its own heap archive on the TBB pool, then copy the
+            // compressed entries into the main archive in object order, so the output does not depend on
+            // the thread count or on which object finished first.
+            std::vector<std::pair<void*, size_t>> object_archives(objects_data.size(), { nullptr, 0 });
+            std::atomic<bool> object_result = true;
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, objects_data.size(), 1), [this, &model, objects = model.objects, &objects_data, &object_paths, &object_archives, &object_result, project](const tbb::blocked_range<size_t>& range) {
                 for (size_t i = range.begin(); i < range.end(); ++i) {
                     auto iter = objects_data.find(objects[i]);
                     ObjectToObjectDataMap objects_data2;
                     objects_data2.insert(*iter);
-                    auto & object = *iter->second.object;
                     mz_zip_archive archive;
                     mz_zip_zero_struct(&archive);
                     mz_zip_writer_init_heap(&archive, 0, 1024 * 1024);
                     CNumericLocalesSetter locales_setter;
-                    _add_model_file_to_archive(object_paths[i], archive, model, objects_data2, nullptr, project);
+                    if (!_add_model_file_to_archive(object_paths[i], archive, model, objects_data2, nullptr, project))
+                        object_result = false;
                     iter->second = objects_data2.begin()->second;
-                    void *ppBuf; size_t pSize;
-                    mz_zip_writer_finalize_heap_archive(&archive, &ppBuf, &pSize);
+                    if (!mz_zip_writer_finalize_heap_archive(&archive, &object_archives[i].first, &object_archives[i].second))
+                        object_result = false;
                     mz_zip_writer_end(&archive);
-                    mz_zip_zero_struct(&archive);
-                    mz_zip_reader_init_mem(&archive, ppBuf, pSize, 0);
-                    {
-                        boost::unique_lock l(mutex);
-                        mz_zip_writer_add_from_zip_reader(main, &archive, 0);
-                    }
-                    mz_zip_reader_end(&archive);
                 }
             });
+
+            for (std::pair<void*, size_t> &object_archive : object_archives) {
+                if (object_archive.first == nullptr)
+                    continue;
+                mz_zip_archive object_zip;
+                mz_zip_zero_struct(&object_zip);
+                if (!mz_zip_reader_init_mem(&object_zip, object_archive.first, object_archive.second, 0) ||
+                    !mz_zip_writer_add_from_zip_reader(&archive, &object_zip, 0))
+                    object_result = false;
+                mz_zip_reader_end(&object_zip);
+                mz_free(object_archive.first);
+            }
+
+            if (!object_result) {
+                add_error("Unable to add object model files to archive");
+                return false;
+            }
         }
 
         return true;
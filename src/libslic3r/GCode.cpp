@@ -3543,82 +3543,37 @@ size_t GCode::get_extruder_id(unsigned int filament_id) const
     return 0;
 }
 
-// Process all layers of all objects (non-sequential mode) with a parallel pipeline:
-// Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
-// and export G-code into file.
-void GCode::process_layers(
-    const Print                                                         &print,
-    const ToolOrdering                                                  &tool_ordering,
-    const std::vector<const PrintInstance*>                             &print_object_instances_ordering,
-    const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
-    GCodeOutputStream                                                   &output_stream)
+template<typename GeneratorFilter>
+void GCode::run_layer_filters(const GeneratorFilter &generator, size_t num_layers, GCodeOutputStream &output_stream)
 {
-    // The pipeline is variable: The vase mode filter is optional.
-    size_t layer_to_print_idx = 0;
-    const auto generator = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> LayerResult {
-            if (layer_to_print_idx >= layers_to_print.size()) {
-                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
-                    fc.stop();
-                    return {};
-                } else {
-                    // Pressure equalizer need insert empty input. Because it returns one layer back.
-                    // Insert NOP (no operation) layer;
-                    ++layer_to_print_idx;
-                    return LayerResult::make_nop_layer_result();
-                }
-            } else {
-                const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[layer_to_print_idx++];
-                const LayerTools& layer_tools = tool_ordering.tools_for_layer(layer.first);
-                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
-                if (m_wipe_tower && layer_tools.has_wipe_tower)
-                    m_wipe_tower->next_layer();
-                //BBS
-                check_placeholder_parser_failed();
-                print.throw_if_canceled();
-                return this->process_layer(print, layer.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, tool_ordering.get_most_used_extruder(), size_t(-1));
-            }
-        });
     if (m_spiral_vase) {
         float nozzle_diameter  = EXTRUDER_CONFIG(nozzle_diameter);
         float max_xy_smoothing = m_config.get_abs_value("spiral_mode_max_xy_smoothing", nozzle_diameter);
         this->m_spiral_vase->set_max_xy_smoothing(max_xy_smoothing);
     }
     const auto spiral_mode = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [&spiral_mode = *this->m_spiral_vase.get(), &layers_to_print](LayerResult in) -> LayerResult {
-        	if (in.nop_layer_result)
+        [&spiral_mode = *this->m_spiral_vase.get(), num_layers](LayerResult in) -> LayerResult {
+            if (in.nop_layer_result)
                 return in;
-                
             spiral_mode.enable(in.spiral_vase_enable);
-            bool last_layer = in.layer_id == layers_to_print.size() - 1;
-            return { spiral_mode.process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush};
+            bool last_layer = in.layer_id == num_layers - 1;
+            in.gcode = spiral_mode.process_layer(std::move(in.gcode), last_layer);
+            return in;
         });
     const auto pressure_equalizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
         [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
             return pressure_equalizer->process_layer(std::move(in));
         });
-    const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in) -> std::string {
-        	if (in.nop_layer_result)
-                return in.gcode;
-            return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+    const auto cooling = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in) -> LayerResult {
+            if (in.nop_layer_result)
+                return in;
+            in.gcode = cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
+            return in;
         });
-    const auto pa_processor_filter = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-            [&pa_processor = *this->m_pa_processor](std::string in) -> std::string {
-                return pa_processor.process_layer(std::move(in));
-            }
-        );
-    
-    const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
-    );
-
-    const auto fan_mover = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-            [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer](std::string in)->std::string {
-
-        CNumericLocalesSetter locales_setter;
-
-        if (config.fan_speedup_time.value != 0 || config.fan_kickstart.value > 0) {
+    const auto fan_mover = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer](LayerResult in) -> LayerResult {
+            CNumericLocalesSetter locales_setter;
             if (fan_mover.get() == nullptr)
                 fan_mover.reset(new Slic3r::FanMover(
                     writer,
@@ -3628,21 +3583,93 @@ void GCode::process_layers(
                     config.fan_speedup_overhangs.value,
                     (float)config.fan_kickstart.value));
             //flush as it's a whole layer
-            return fan_mover->process_gcode(in, true);
-        }
-        return in;
-    });
+            in.gcode = fan_mover->process_gcode(in.gcode, true);
+            return in;
+        });
+    const auto pa_processor_filter = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [&pa_processor = *this->m_pa_processor](LayerResult in) -> LayerResult {
+            in.gcode = pa_processor.process_layer(std::move(in.gcode));
+            return in;
+        });
+    const auto output = tbb::make_filter<LayerResult, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&output_stream](LayerResult in) { output_stream.write(in.gcode); });
+
+    // Only insert the filters which have any work to do for this print, so that the layer G-code is not scanned
+    // line by line by a filter just to be passed through unchanged.
+    const bool fan_mover_enabled = m_config.fan_speedup_time.value != 0 || m_config.fan_kickstart.value > 0;
+    // Adaptive PA tags are only emitted for filaments with adaptive pressure advance enabled.
+    // The adaptive PA processor is not applied in spiral vase mode.
+    bool pa_processor_enabled = false;
+    if (! m_spiral_vase)
+        for (size_t i = 0; i < m_config.adaptive_pressure_advance.values.size() && ! pa_processor_enabled; ++ i)
+            pa_processor_enabled = m_config.adaptive_pressure_advance.get_at(i) && m_config.enable_pressure_advance.get_at(i);
 
     // The pipeline elements are joined using const references, thus no copying is performed.
-    if (m_spiral_vase && m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & spiral_mode & pressure_equalizer & cooling & fan_mover & output);
-    else if (m_spiral_vase)
-    	tbb::parallel_pipeline(12, generator & spiral_mode & cooling & fan_mover & output);
-    else if	(m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & pressure_equalizer & cooling & fan_mover & pa_processor_filter & output);
-    else
-    	tbb::parallel_pipeline(12, generator & cooling & fan_mover & pa_processor_filter & output);
+    auto pipeline = generator;
+    if (m_spiral_vase)
+        pipeline = pipeline & spiral_mode;
+    if (m_pressure_equalizer)
+        pipeline = pipeline & pressure_equalizer;
+    pipeline = pipeline & cooling;
+    if (fan_mover_enabled)
+        pipeline = pipeline & fan_mover;
+    if (pa_processor_enabled)
+        pipeline = pipeline & pa_processor_filter;
+    tbb::parallel_pipeline(12, pipeline & output);
+}
 
+// Process all layers of all objects (non-sequential mode) with a parallel pipeline:
+// Generate G-code, run the filters (vase mode, cooling buffer), run the G-code analyser
+// and export G-code into file.
+void GCode::process_layers(
+    const Print                                                         &print,
+    const ToolOrdering                                                  &tool_ordering,
+    const std::vector<const PrintInstance*>                             &print_object_instances_ordering,
+    const std::vector<std::pair<coordf_t, std::vector<LayerToPrint>>>   &layers_to_print,
+    GCodeOutputStream                                                   &output_stream)
+{
+    // The pipeline is variable: The vase mode filter is optional.
+    // Index of the layer to process and the prefetched data of its object layers.
+    using LayerToProcess = std::pair<size_t, std::vector<PrefetchedLayer>>;
+    size_t layer_to_print_idx = 0;
+    const auto layer_selector = tbb::make_filter<void, size_t>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> size_t {
+            // Pressure equalizer need insert empty input. Because it returns one layer back.
+            if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
+                fc.stop();
+                return 0;
+            }
+            return layer_to_print_idx ++;
+        });
+    // Assigning extrusions to islands and building the avoid crossing perimeters boundaries only read the layer geometry,
+    // thus they run in parallel for the layers ahead of the serial G-code generator. The number of the pipeline tokens
+    // bounds the number of layers prefetched.
+    const auto island_collector = tbb::make_filter<size_t, LayerToProcess>(slic3r_tbb_filtermode::parallel,
+        [&print, &layers_to_print](size_t idx) -> LayerToProcess {
+            LayerToProcess out { idx, {} };
+            if (idx < layers_to_print.size())
+                for (const LayerToPrint &layer : layers_to_print[idx].second)
+                    out.second.emplace_back(prefetch_layer(print, layer));
+            return out;
+        });
+    const auto generator = tbb::make_filter<LayerToProcess, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &print, &tool_ordering, &print_object_instances_ordering, &layers_to_print](LayerToProcess in) -> LayerResult {
+            if (in.first >= layers_to_print.size()) {
+                // Insert NOP (no operation) layer for the pressure equalizer;
+                return LayerResult::make_nop_layer_result();
+            } else {
+                const std::pair<coordf_t, std::vector<LayerToPrint>>& layer = layers_to_print[in.first];
+                const LayerTools& layer_tools = tool_ordering.tools_for_layer(layer.first);
+                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(in.first + 1)));
+                if (m_wipe_tower && layer_tools.has_wipe_tower)
+                    m_wipe_tower->next_layer();
+                //BBS
+                check_placeholder_parser_failed();
+                print.throw_if_canceled();
+                return this->process_layer(print, layer.second, in.second, layer_tools, &layer == &layers_to_print.back(), &print_object_instances_ordering, tool_ordering.get_most_used_extruder(), size_t(-1));
+            }
+        });
+    this->run_layer_filters(layer_selector & island_collector & generator, layers_to_print.size(), output_stream);
 }
 
 // Process all layers of a single object instance (sequential mode) with a parallel pipeline:
@@ -3658,88 +3685,45 @@ void GCode::process_layers(
     const bool                               prime_extruder)
 {
     // The pipeline is variable: The vase mode filter is optional.
+    // Index of the layer to process and the prefetched data of its object layer.
+    using LayerToProcess = std::pair<size_t, std::vector<PrefetchedLayer>>;
     size_t layer_to_print_idx = 0;
-    const auto generator = tbb::make_filter<void, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [this, &print, &tool_ordering, &layers_to_print, &layer_to_print_idx, single_object_idx, prime_extruder](tbb::flow_control& fc) -> LayerResult {
-            if (layer_to_print_idx >= layers_to_print.size()) {
-                if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
-                    fc.stop();
-                    return {};
-                } else {
-                    // Pressure equalizer need insert empty input. Because it returns one layer back.
-                    // Insert NOP (no operation) layer;
-                    ++layer_to_print_idx;
-                    return LayerResult::make_nop_layer_result();
-                }
+    const auto layer_selector = tbb::make_filter<void, size_t>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &layers_to_print, &layer_to_print_idx](tbb::flow_control& fc) -> size_t {
+            // Pressure equalizer need insert empty input. Because it returns one layer back.
+            if (layer_to_print_idx == layers_to_print.size() + (m_pressure_equalizer ? 1 : 0)) {
+                fc.stop();
+                return 0;
+            }
+            return layer_to_print_idx ++;
+        });
+    // Assigning extrusions to islands and building the avoid crossing perimeters boundaries only read the layer geometry,
+    // thus they run in parallel for the layers ahead of the serial G-code generator. The number of the pipeline tokens
+    // bounds the number of layers prefetched.
+    const auto island_collector = tbb::make_filter<size_t, LayerToProcess>(slic3r_tbb_filtermode::parallel,
+        [&print, &layers_to_print](size_t idx) -> LayerToProcess {
+            LayerToProcess out { idx, {} };
+            if (idx < layers_to_print.size()) {
+                const LayerToPrint &layer = layers_to_print[idx];
+                out.second.emplace_back(prefetch_layer(print, layer));
+            }
+            return out;
+        });
+    const auto generator = tbb::make_filter<LayerToProcess, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &print, &tool_ordering, &layers_to_print, single_object_idx, prime_extruder](LayerToProcess in) -> LayerResult {
+            if (in.first >= layers_to_print.size()) {
+                // Insert NOP (no operation) layer for the pressure equalizer;
+                return LayerResult::make_nop_layer_result();
             } else {
-                LayerToPrint &layer = layers_to_print[layer_to_print_idx ++];
-                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(layer_to_print_idx)));
+                LayerToPrint &layer = layers_to_print[in.first];
+                print.set_status(80, Slic3r::format(_(L("Generating G-code: layer %1%")), std::to_string(in.first + 1)));
                 //BBS
                 check_placeholder_parser_failed();
                 print.throw_if_canceled();
-                return this->process_layer(print, { std::move(layer) }, tool_ordering.tools_for_layer(layer.print_z()), &layer == &layers_to_print.back(), nullptr, tool_ordering.get_most_used_extruder(), single_object_idx, prime_extruder);
+                return this->process_layer(print, { std::move(layer) }, in.second, tool_ordering.tools_for_layer(layer.print_z()), &layer == &layers_to_print.back(), nullptr, tool_ordering.get_most_used_extruder(), single_object_idx, prime_extruder);
             }
         });
-    if (m_spiral_vase) {
-        float nozzle_diameter  = EXTRUDER_CONFIG(nozzle_diameter);
-        float max_xy_smoothing = m_config.get_abs_value("spiral_mode_max_xy_smoothing", nozzle_diameter);
-        this->m_spiral_vase->set_max_xy_smoothing(max_xy_smoothing);
-    }
-    const auto spiral_mode = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [&spiral_mode = *this->m_spiral_vase.get(), &layers_to_print](LayerResult in)->LayerResult {
-            if (in.nop_layer_result)
-                return in;
-            spiral_mode.enable(in.spiral_vase_enable);
-            bool last_layer = in.layer_id == layers_to_print.size() - 1;
-            return { spiral_mode.process_layer(std::move(in.gcode), last_layer), in.layer_id, in.spiral_vase_enable, in.cooling_buffer_flush };
-        });
-    const auto pressure_equalizer = tbb::make_filter<LayerResult, LayerResult>(slic3r_tbb_filtermode::serial_in_order,
-        [pressure_equalizer = this->m_pressure_equalizer.get()](LayerResult in) -> LayerResult {
-             return pressure_equalizer->process_layer(std::move(in));
-        });
-    const auto cooling = tbb::make_filter<LayerResult, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&cooling_buffer = *this->m_cooling_buffer.get()](LayerResult in)->std::string {
-            if (in.nop_layer_result)
-                return in.gcode;
-            return cooling_buffer.process_layer(std::move(in.gcode), in.layer_id, in.cooling_buffer_flush);
-        });
-    const auto pa_processor_filter = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&pa_processor = *this->m_pa_processor](std::string in) -> std::string {
-            return pa_processor.process_layer(std::move(in));
-        }
-    );
-    
-    const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
-        [&output_stream](std::string s) { output_stream.write(s); }
-    );
-
-    const auto fan_mover = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
-        [&fan_mover = this->m_fan_mover, &config = this->config(), &writer = this->m_writer](std::string in)->std::string {
-
-        if (config.fan_speedup_time.value != 0 || config.fan_kickstart.value > 0) {
-            if (fan_mover.get() == nullptr)
-                fan_mover.reset(new Slic3r::FanMover(
-                    writer,
-                    std::abs((float)config.fan_speedup_time.value),
-                    config.fan_speedup_time.value > 0,
-                    config.use_relative_e_distances.value,
-                    config.fan_speedup_overhangs.value,
-                    (float)config.fan_kickstart.value));
-            //flush as it's a whole layer
-            return fan_mover->process_gcode(in, true);
-        }
-        return in;
-    });
-
-    // The pipeline elements are joined using const references, thus no copying is performed.
-    if (m_spiral_vase && m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & spiral_mode & pressure_equalizer & cooling & fan_mover & output);
-    else if (m_spiral_vase)
-    	tbb::parallel_pipeline(12, generator & spiral_mode & cooling & fan_mover & output);
-    else if	(m_pressure_equalizer)
-        tbb::parallel_pipeline(12, generator & pressure_equalizer & cooling & fan_mover & pa_processor_filter & output);
-    else
-    	tbb::parallel_pipeline(12, generator & cooling & fan_mover & pa_processor_filter & output);
+    this->run_layer_filters(layer_selector & island_collector & generator, layers_to_print.size(), output_stream);
 }
 
 std::string GCode::placeholder_parser_process(const std::string &name, const std::string &templ, unsigned int current_filament_id, const DynamicConfig *config_override)
@@ -4329,6 +4313,64 @@ std::string GCode::generate_skirt(const Print &print,
     return gcode;
 }
 
+// Assign the perimeter and infill extrusion collections of a layer to the islands (Layer::lslices) they start in.
+// Only the layer geometry is accessed, thus this may run in parallel for multiple layers ahead of GCode::process_layer().
+GCode::LayerIslands GCode::collect_layer_islands(const Layer &layer)
+{
+    LayerIslands out;
+    size_t n_slices = layer.lslices.size();
+    const std::vector<BoundingBox> &layer_surface_bboxes = layer.lslices_bboxes;
+    // Traverse the slices in an increasing order of bounding box size, so that the islands inside another islands are tested first,
+    // so we can just test a point inside ExPolygon::contour and we may skip testing the holes.
+    std::vector<size_t> slices_test_order;
+    slices_test_order.reserve(n_slices);
+    for (size_t i = 0; i < n_slices; ++ i)
+        slices_test_order.emplace_back(i);
+    std::sort(slices_test_order.begin(), slices_test_order.end(), [&layer_surface_bboxes](size_t i, size_t j) {
+        const Vec2d s1 = layer_surface_bboxes[i].size().cast<double>();
+        const Vec2d s2 = layer_surface_bboxes[j].size().cast<double>();
+        return s1.x() * s1.y() < s2.x() * s2.y();
+    });
+    auto point_inside_surface = [&layer, &layer_surface_bboxes](const size_t i, const Point &point) {
+        const BoundingBox &bbox = layer_surface_bboxes[i];
+        return point(0) >= bbox.min(0) && point(0) < bbox.max(0) &&
+               point(1) >= bbox.min(1) && point(1) < bbox.max(1) &&
+               layer.lslices[i].contour.contains(point);
+    };
+    auto island_of = [n_slices, &slices_test_order, &point_inside_surface](const ExtrusionEntity *ee) {
+        const auto *extrusions = static_cast<const ExtrusionEntityCollection*>(ee);
+        if (! extrusions->entities.empty())
+            for (size_t i : slices_test_order)
+                if (point_inside_surface(i, extrusions->first_point()))
+                    return i;
+        // extrusions->first_point does not fit inside any slice
+        return n_slices;
+    };
+
+    out.fills.assign(layer.regions().size(), {});
+    out.perimeters.assign(layer.regions().size(), {});
+    for (size_t region_id = 0; region_id < layer.regions().size(); ++ region_id)
+        if (const LayerRegion *layerm = layer.regions()[region_id]; layerm != nullptr) {
+            out.fills[region_id].reserve(layerm->fills.entities.size());
+            for (const ExtrusionEntity *ee : layerm->fills.entities)
+                out.fills[region_id].emplace_back(island_of(ee));
+            out.perimeters[region_id].reserve(layerm->perimeters.entities.size());
+            for (const ExtrusionEntity *ee : layerm->perimeters.entities)
+                out.perimeters[region_id].emplace_back(island_of(ee));
+        }
+    return out;
+}
+
+GCode::PrefetchedLayer GCode::prefetch_layer(const Print &print, const LayerToPrint &layer)
+{
+    PrefetchedLayer out;
+    if (layer.object_layer)
+        out.islands = collect_layer_islands(*layer.object_layer);
+    if (print.config().reduce_crossing_wall && layer.layer() != nullptr)
+        out.avoid_crossing_perimeters = AvoidCrossingPerimeters::prepare_layer(*layer.layer());
+    return out;
+}
+
 // In sequential mode, process_layer is called once per each object and its copy,
 // therefore layers will contain a single entry and single_object_instance_idx will point to the copy of the object.
 // In non-sequential mode, process_layer is called per each print_z height with all object and support layers accumulated.
@@ -4338,6 +4380,8 @@ LayerResult GCode::process_layer(
     const Print                    			&print,
     // Set of object & print layers of the same PrintObject and with the same print_z.
     const std::vector<LayerToPrint> 		&layers,
+    // Islands of the extrusions of layers, one item per layers item.
+    const std::vector<PrefetchedLayer>      &prefetched_layers,
     const LayerTools        		        &layer_tools,
     const bool                               last_layer,
     // Pairs of PrintObject index and its instance index.
@@ -4779,24 +4823,10 @@ LayerResult GCode::process_layer(
             //   option
             // (Still, we have to keep track of regions because we need to apply their config)
             size_t n_slices = layer.lslices.size();
-            const std::vector<BoundingBox> &layer_surface_bboxes = layer.lslices_bboxes;
-            // Traverse the slices in an increasing order of bounding box size, so that the islands inside another islands are tested first,
-            // so we can just test a point inside ExPolygon::contour and we may skip testing the holes.
-            std::vector<size_t> slices_test_order;
-            slices_test_order.reserve(n_slices);
-            for (size_t i = 0; i < n_slices; ++ i)
-                slices_test_order.emplace_back(i);
-            std::sort(slices_test_order.begin(), slices_test_order.end(), [&layer_surface_bboxes](size_t i, size_t j) {
-                const Vec2d s1 = layer_surface_bboxes[i].size().cast<double>();
-                const Vec2d s2 = layer_surface_bboxes[j].size().cast<double>();
-                return s1.x() * s1.y() < s2.x() * s2.y();
-            });
-            auto point_inside_surface = [&layer, &layer_surface_bboxes](const size_t i, const Point &point) {
-                const BoundingBox &bbox = layer_surface_bboxes[i];
-                return point(0) >= bbox.min(0) && point(0) < bbox.max(0) &&
-                       point(1) >= bbox.min(1) && point(1) < bbox.max(1) &&
-                       layer.lslices[i].contour.contains(point);
-            };
+            // Islands of the extrusions were already collected by collect_layer_islands(), possibly in parallel with other layers.
+            assert(prefetched_layers.size() == layers.size());
+            const LayerIslands &islands_of_layer = prefetched_layers[&layer_to_print - layers.data()].islands;
+            assert(islands_of_layer.fills.size() == layer.regions().size() && islands_of_layer.perimeters.size() == layer.regions().size());
 
             for (size_t region_id = 0; region_id < layer.regions().size(); ++ region_id) {
                 const LayerRegion *layerm = layer.regions()[region_id];
@@ -4811,10 +4841,13 @@ LayerResult GCode::process_layer(
                 // The process is almost the same for perimeters and infills - we will do it in a cycle that repeats twice:
                 std::vector<unsigned int> printing_extruders;
                 for (const ObjectByExtruder::Island::Region::Type entity_type : { ObjectByExtruder::Island::Region::INFILL, ObjectByExtruder::Island::Region::PERIMETERS }) {
-                    for (const ExtrusionEntity *ee : (entity_type == ObjectByExtruder::Island::Region::INFILL) ? layerm->fills.entities : layerm->perimeters.entities) {
+                    const bool                 is_infill = entity_type == ObjectByExtruder::Island::Region::INFILL;
+                    const ExtrusionEntitiesPtr &entities = is_infill ? layerm->fills.entities : layerm->perimeters.entities;
+                    const std::vector<size_t>  &entity_islands = is_infill ? islands_of_layer.fills[region_id] : islands_of_layer.perimeters[region_id];
+                    for (size_t entity_idx = 0; entity_idx < entities.size(); ++ entity_idx) {
                         // extrusions represents infill or perimeter extrusions of a single island.
-                        assert(dynamic_cast<const ExtrusionEntityCollection*>(ee) != nullptr);
-                        const auto *extrusions = static_cast<const ExtrusionEntityCollection*>(ee);
+                        assert(dynamic_cast<const ExtrusionEntityCollection*>(entities[entity_idx]) != nullptr);
+                        const auto *extrusions = static_cast<const ExtrusionEntityCollection*>(entities[entity_idx]);
                         if (extrusions->entities.empty()) // This shouldn't happen but first_point() would fail.
                             continue;
 
@@ -4854,19 +4887,11 @@ LayerResult GCode::process_layer(
                                 extruder,
                                 &layer_to_print - layers.data(),
                                 layers.size(), n_slices+1);
-                            for (size_t i = 0; i <= n_slices; ++ i) {
-                                bool   last = i == n_slices;
-                                size_t island_idx = last ? n_slices : slices_test_order[i];
-                                if (// extrusions->first_point does not fit inside any slice
-                                    last ||
-                                    // extrusions->first_point fits inside ith slice
-                                    point_inside_surface(island_idx, extrusions->first_point())) {
-                                    if (islands[island_idx].by_region.empty())
-                                        islands[island_idx].by_region.assign(print.num_print_regions(), ObjectByExtruder::Island::Region());
-                                    islands[island_idx].by_region[region.print_region_id()].append(entity_type, extrusions, entity_overrides);
-                                    break;
-                                }
-                            }
+                            // n_slices if extrusions->first_point does not fit inside any slice.
+                            const size_t island_idx = entity_islands[entity_idx];
+                            if (islands[island_idx].by_region.empty())
+                                islands[island_idx].by_region.assign(print.num_print_regions(), ObjectByExtruder::Island::Region());
+                            islands[island_idx].by_region[region.print_region_id()].append(entity_type, extrusions, entity_overrides);
                         }
                     }
                 }
@@ -5195,7 +5220,7 @@ LayerResult GCode::process_layer(
                 m_layer = layer_to_print.layer();
                 m_object_layer_over_raft = object_layer_over_raft;
                 if (m_config.reduce_crossing_wall)
-                    m_avoid_crossing_perimeters.init_layer(*m_layer);
+                    m_avoid_crossing_perimeters.init_layer(*m_layer, prefetched_layers[instance_to_print.layer_id].avoid_crossing_perimeters);
 
                 if (this->config().gcode_label_objects) {
                     gcode += std::string("; printing object ") + instance_to_print.print_object.model_object()->name +
@@ -6107,6 +6132,15 @@ void GCode::GCodeOutputStream::close()
     }
 }
 
+void GCode::GCodeOutputStream::write(const std::string &what)
+{
+    if (! what.empty()) {
+        // writes string to file
+        fwrite(what.data(), 1, what.size(), this->f);
+        m_processor.process_buffer(what);
+    }
+}
+
 void GCode::GCodeOutputStream::write(const char *what)
 {
     if (what != nullptr) {
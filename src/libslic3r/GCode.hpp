@@ -165,6 +165,9 @@ public:
     static const std::vector<std::string>& get() { return Colors; }
 };
 
+// G-code of a single layer together with the per-layer flags driving the post-processing filters.
+// LayerResult is the only type flowing through the GCode::process_layers() pipeline, it is moved from one filter
+// to the next one and it is only converted to plain text when written into the output stream.
 struct LayerResult {
     std::string gcode;
     size_t      layer_id;
@@ -317,7 +320,7 @@ private:
         void close();
 
         // Write a string into a file.
-        void write(const std::string& what) { this->write(what.c_str()); }
+        void write(const std::string& what);
         void write(const char* what);
 
         // Write a string into a file.
@@ -345,10 +348,30 @@ private:
         const Layer& layer,
         unsigned int extruder_id);
 
+    // Index of the island (Layer::lslices) in which each perimeter / infill extrusion collection of a layer starts,
+    // lslices.size() if it starts outside of all islands. Indexed by region id, then by the index of the extrusion
+    // collection in LayerRegion::fills / LayerRegion::perimeters.
+    struct LayerIslands {
+        std::vector<std::vector<size_t>> fills;
+        std::vector<std::vector<size_t>> perimeters;
+    };
+    static LayerIslands collect_layer_islands(const Layer &layer);
+
+    // Data of a LayerToPrint depending on the layer geometry only, see prefetch_layer().
+    struct PrefetchedLayer {
+        LayerIslands                           islands;
+        // Only set if reduce_crossing_wall is enabled.
+        AvoidCrossingPerimeters::LayerDataPtr  avoid_crossing_perimeters;
+    };
+    // Only reads the layer geometry, thus it may run in parallel for the layers ahead of process_layer().
+    static PrefetchedLayer prefetch_layer(const Print &print, const LayerToPrint &layer);
+
     LayerResult process_layer(
         const Print                     &print,
         // Set of object & print layers of the same PrintObject and with the same print_z.
         const std::vector<LayerToPrint> &layers,
+        // One item per layers item, see prefetch_layer().
+        const std::vector<PrefetchedLayer> &prefetched_layers,
         const LayerTools  				&layer_tools,
         const bool                       last_layer,
 		// Pairs of PrintObject index and its instance index.
@@ -380,6 +403,11 @@ private:
         GCodeOutputStream                       &output_stream,
         // BBS
         const bool                               prime_extruder = false);
+    // Chain the post-processing filters enabled for this print (vase mode, pressure equalizer, cooling buffer,
+    // fan mover, adaptive PA) behind the G-code generator filter and run the pipeline.
+    // Filters that are disabled for this print are not inserted into the pipeline at all.
+    template<typename GeneratorFilter>
+    void run_layer_filters(const GeneratorFilter &generator, size_t num_layers, GCodeOutputStream &output_stream);
 
     //BBS
     void check_placeholder_parser_failed();
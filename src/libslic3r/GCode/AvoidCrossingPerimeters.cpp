@@ -1244,12 +1244,17 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     Vec2d startf = start.cast<double>();
     Vec2d endf   = end  .cast<double>();
 
-    const ExPolygons               &lslices          = gcodegen.layer()->lslices;
-    const std::vector<BoundingBox> &lslices_bboxes   = gcodegen.layer()->lslices_bboxes;
+    static const LayerData          empty_layer_data {};
+    const LayerData                &layer_data       = m_layer_data ? *m_layer_data : empty_layer_data;
     bool                            is_support_layer = (dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr);
-    if (!use_external && (is_support_layer || (!m_lslices_offset.empty() && !any_expolygon_contains(m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslice, travel)))) {
-        // Initialize m_internal only when it is necessary.
-        if (m_internal.boundaries.empty()) {
+    if (!use_external && (is_support_layer || (!layer_data.lslices_offset.empty() && !any_expolygon_contains(layer_data.lslices_offset, layer_data.lslices_offset_bboxes, layer_data.grid_lslice, travel)))) {
+        const Boundary *internal = &m_internal;
+        if (layer_data.has_internal && layer_data.layer == gcodegen.layer() &&
+            (layer_data.internal.boundaries.empty() || (layer_data.internal.bbox.contains(startf) && layer_data.internal.bbox.contains(endf)))) {
+            // Prepared by init_layer(), possibly in parallel ahead of the G-code generator.
+            internal = &layer_data.internal;
+        } else if (m_internal.boundaries.empty()) {
+            // Initialize m_internal only when it is necessary.
             init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer(), get_perimeter_spacing(*gcodegen.layer()))), {start, end});
         } else if (!(m_internal.bbox.contains(startf) && m_internal.bbox.contains(endf))) {
             // check if start and end are in bbox, if not, merge start and end points to bbox
@@ -1257,8 +1262,8 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
             init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer(), get_perimeter_spacing(*gcodegen.layer()))), {start, end});
         }
 
-        if (!m_internal.boundaries.empty()) {
-            travel_intersection_count = avoid_perimeters(m_internal, start, end, *gcodegen.layer(), result_pl);
+        if (!internal->boundaries.empty()) {
+            travel_intersection_count = avoid_perimeters(*internal, start, end, *gcodegen.layer(), result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
@@ -1308,33 +1313,52 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     } else if (max_detour_length_exceeded) {
         *could_be_wipe_disabled = false;
     } else
-        *could_be_wipe_disabled = !need_wipe(gcodegen, m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslice, travel, result_pl, travel_intersection_count);
+        *could_be_wipe_disabled = !need_wipe(gcodegen, layer_data.lslices_offset, layer_data.lslices_offset_bboxes, layer_data.grid_lslice, travel, result_pl, travel_intersection_count);
 
     return result_pl;
 }
 
 // ************************************* AvoidCrossingPerimeters::init_layer() *****************************************
 
-void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+AvoidCrossingPerimeters::LayerDataPtr AvoidCrossingPerimeters::prepare_layer(const Layer &layer, bool with_internal_boundary)
 {
-    m_internal.clear();
-    m_external.clear();
+    auto out = std::make_shared<LayerData>();
+    out->layer = &layer;
 
-    m_lslices_offset.clear();
-    m_lslices_offset_bboxes.clear();
     for (auto coeff : {0.6f, 0.5f, 0.45f}) {
-        m_lslices_offset = offset_ex(layer.lslices, -get_external_perimeter_width(layer) * coeff);
-        if (!m_lslices_offset.empty()) break;
-    }    
-    m_lslices_offset_bboxes.reserve(m_lslices_offset.size());
-    for (const auto &ex_polygon : m_lslices_offset) m_lslices_offset_bboxes.emplace_back(get_extents(ex_polygon));
+        out->lslices_offset = offset_ex(layer.lslices, -get_external_perimeter_width(layer) * coeff);
+        if (!out->lslices_offset.empty()) break;
+    }
+    out->lslices_offset_bboxes.reserve(out->lslices_offset.size());
+    for (const auto &ex_polygon : out->lslices_offset) out->lslices_offset_bboxes.emplace_back(get_extents(ex_polygon));
 
     BoundingBox bbox_slice(get_extents(layer.lslices));
     bbox_slice.offset(SCALED_EPSILON);
 
-    m_grid_lslice.set_bbox(bbox_slice);
+    out->grid_lslice.set_bbox(bbox_slice);
     //FIXME 1mm grid?
-    m_grid_lslice.create(m_lslices_offset, coord_t(scale_(1.)));
+    out->grid_lslice.create(out->lslices_offset, coord_t(scale_(1.)));
+
+    if (with_internal_boundary) {
+        // Without the travel end points the bounding box is only inflated by its radius. travel_to() falls back
+        // to building its own boundary for the travels leaving it.
+        if (Polygons boundary = to_polygons(get_boundary(layer, get_perimeter_spacing(layer))); !boundary.empty())
+            init_boundary(&out->internal, std::move(boundary), {});
+        out->has_internal = true;
+    }
+    return out;
+}
+
+void AvoidCrossingPerimeters::init_layer(const Layer &layer, LayerDataPtr layer_data)
+{
+    m_internal.clear();
+    m_external.clear();
+
+    // init_layer() is called for each printed instance, thus keep the structures if they are already there.
+    if (layer_data && layer_data->layer == &layer)
+        m_layer_data = std::move(layer_data);
+    else if (! m_layer_data || m_layer_data->layer != &layer)
+        m_layer_data = prepare_layer(layer, false);
 }
 
 #if 0
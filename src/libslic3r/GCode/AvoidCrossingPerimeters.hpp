@@ -5,6 +5,8 @@
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
 
+#include <memory>
+
 namespace Slic3r {
 
 // Forward declarations.
@@ -24,7 +26,15 @@ public:
     bool        disabled_once() const   { return m_disabled_once; }
     void        reset_once_modifiers()  { m_use_external_mp_once = false; m_disabled_once = false; }
 
-    void        init_layer(const Layer &layer);
+    struct LayerData;
+    using LayerDataPtr = std::shared_ptr<const LayerData>;
+
+    // Compute the structures depending on the layer geometry only. The computation does not touch
+    // the AvoidCrossingPerimeters state, thus it may run in parallel for the layers ahead of the G-code generator.
+    // If with_internal_boundary is false, the internal boundary is left to be built on demand by travel_to().
+    static LayerDataPtr prepare_layer(const Layer &layer, bool with_internal_boundary = true);
+    // If layer_data is empty or it was prepared for another layer, it is computed here.
+    void        init_layer(const Layer &layer, LayerDataPtr layer_data = {});
 
     Polyline    travel_to(const GCode& gcodegen, const Point& point)
     {
@@ -51,6 +61,19 @@ public:
         }
     };
 
+    struct LayerData {
+        const Layer             *layer { nullptr };
+        // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
+        ExPolygons               lslices_offset;
+        std::vector<BoundingBox> lslices_offset_bboxes;
+        // Used for detection of line or polyline is inside of any polygon.
+        EdgeGrid::Grid           grid_lslice;
+        // Boundary for travels inside object, its bounding box is inflated by its radius to cover most of the travels.
+        // Only valid if has_internal is set.
+        Boundary                 internal;
+        bool                     has_internal { false };
+    };
+
 private:
     bool           m_use_external_mp { false };
     // just for the next travel move
@@ -59,12 +82,9 @@ private:
     // we enable it by default for the first travel move in print
     bool           m_disabled_once { true };
 
-    // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
-    ExPolygons               m_lslices_offset;
-    std::vector<BoundingBox> m_lslices_offset_bboxes;
-    // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid m_grid_lslice;
-    // Store all needed data for travels inside object
+    // Structures of the current layer, shared with the pipeline stage that prepared them.
+    LayerDataPtr   m_layer_data;
+    // Store all needed data for travels inside object, used if the travel is not covered by m_layer_data->internal.
     Boundary m_internal;
     // Store all needed data for travels outside object
     Boundary m_external;
@@ -1,11 +1,11 @@
 #include "ConflictChecker.hpp"
 
 #include <tbb/parallel_for.h>
-#include <tbb/concurrent_vector.h>
 
-#include <map>
+#include <algorithm>
 #include <functional>
 #include <atomic>
+#include <unordered_map>
 
 namespace Slic3r {
 
@@ -139,6 +139,28 @@ LineWithIDs LinesBucketQueue::getCurLines() const
     return lines;
 }
 
+LinesBucketRanges LinesBucketQueue::getCurRanges() const
+{
+    LinesBucketRanges ranges;
+    for (const LinesBucket &bucket : line_buckets) {
+        if (bucket.valid()) {
+            auto [b, e] = bucket.curRange();
+            ranges.push_back({&bucket, b, e});
+        }
+    }
+    return ranges;
+}
+
+LineWithIDs LinesBucketQueue::getLinesOfRanges(const LinesBucketRanges &ranges)
+{
+    LineWithIDs lines;
+    for (const LinesBucketRange &range : ranges) {
+        LineWithIDs tmpLines = range.bucket->lines(range.begin, range.end);
+        lines.insert(lines.end(), tmpLines.begin(), tmpLines.end());
+    }
+    return lines;
+}
+
 void getExtrusionPathsFromEntity(const ExtrusionEntityCollection *entity, ExtrusionPaths &paths)
 {
     std::function<void(const ExtrusionEntityCollection *, ExtrusionPaths &)> getExtrusionPathImpl = [&](const ExtrusionEntityCollection *entity, ExtrusionPaths &paths) {
@@ -197,21 +219,77 @@ ObjectExtrusions getAllLayersExtrusionPathsFromObject(PrintObject *obj)
     return oe;
 }
 
+namespace RasterizationImpl {
+// Test the lines1 against the lines2 inside the box, where the bounding boxes of their objects overlap.
+static ConflictComputeOpt find_inter_of_lines_in_box(const LineWithIDs &lines, const std::vector<int> &lines1, const std::vector<int> &lines2, const BoundingBox &box)
+{
+    const IndexPair minVoxel = point_map_grid_index(box.min, scale_(1), scale_(1));
+    const IndexPair maxVoxel = point_map_grid_index(box.max, scale_(1), scale_(1));
+    auto voxelInBox = [&minVoxel, &maxVoxel](const IndexPair &voxel) {
+        return voxel.first >= minVoxel.first && voxel.first <= maxVoxel.first && voxel.second >= minVoxel.second && voxel.second <= maxVoxel.second;
+    };
+    auto lineInBox = [&box](const Line &line) {
+        return std::max(line.a.x(), line.b.x()) >= box.min.x() && std::min(line.a.x(), line.b.x()) <= box.max.x() &&
+               std::max(line.a.y(), line.b.y()) >= box.min.y() && std::min(line.a.y(), line.b.y()) <= box.max.y();
+    };
+
+    std::vector<std::pair<IndexPair, int>> voxelToLine;
+    for (int idx : lines1)
+        if (lineInBox(lines[idx]._line))
+            for (const IndexPair &voxel : line_rasterization(lines[idx]._line))
+                if (voxelInBox(voxel)) voxelToLine.emplace_back(voxel, idx);
+    if (voxelToLine.empty()) { return {}; }
+    std::sort(voxelToLine.begin(), voxelToLine.end());
+
+    for (int idx : lines2) {
+        const LineWithID &l1 = lines[idx];
+        if (!lineInBox(l1._line)) continue;
+        for (const IndexPair &voxel : line_rasterization(l1._line)) {
+            if (!voxelInBox(voxel)) continue;
+            auto it = std::lower_bound(voxelToLine.begin(), voxelToLine.end(), voxel, [](const auto &l, const IndexPair &r) { return l.first < r; });
+            for (; it != voxelToLine.end() && it->first == voxel; ++it) {
+                const LineWithID &l2 = lines[it->second];
+                if (auto interRes = ConflictChecker::line_intersect(l1, l2); interRes.has_value()) { return interRes; }
+            }
+        }
+    }
+    return {};
+}
+} // namespace RasterizationImpl
+
 ConflictComputeOpt ConflictChecker::find_inter_of_lines(const LineWithIDs &lines)
 {
     using namespace RasterizationImpl;
-    std::map<IndexPair, std::vector<int>> indexToLine;
 
+    // Lines of a single object never conflict, thus group the lines by object first.
+    struct LinesGroup
+    {
+        const void *     id;
+        BoundingBox      bbox;
+        std::vector<int> lines;
+    };
+    std::vector<LinesGroup>                 groups;
+    std::unordered_map<const void *, size_t> idToGroup;
     for (int i = 0; i < lines.size(); ++i) {
-        const LineWithID &l1      = lines[i];
-        auto              indexes = line_rasterization(l1._line);
-        for (auto index : indexes) {
-            const auto &possibleIntersectIdxs = indexToLine[index];
-            for (auto possibleIntersectIdx : possibleIntersectIdxs) {
-                const LineWithID &l2 = lines[possibleIntersectIdx];
-                if (auto interRes = line_intersect(l1, l2); interRes.has_value()) { return interRes; }
-            }
-            indexToLine[index].push_back(i);
+        const LineWithID &line = lines[i];
+        auto [it, inserted]    = idToGroup.try_emplace(line._id, groups.size());
+        if (inserted) { groups.push_back({line._id, BoundingBox(line._line.a, line._line.a), {}}); }
+        LinesGroup &group = groups[it->second];
+        group.bbox.min    = group.bbox.min.cwiseMin(line._line.a).cwiseMin(line._line.b);
+        group.bbox.max    = group.bbox.max.cwiseMax(line._line.a).cwiseMax(line._line.b);
+        group.lines.push_back(i);
+    }
+    if (groups.size() < 2) { return {}; }
+
+    // Sweep along X over the bounding boxes of the objects, only the overlapping ones are tested line by line.
+    std::sort(groups.begin(), groups.end(), [](const LinesGroup &l, const LinesGroup &r) { return l.bbox.min.x() < r.bbox.min.x(); });
+    for (size_t i = 0; i < groups.size(); ++i) {
+        const LinesGroup &g1 = groups[i];
+        for (size_t j = i + 1; j < groups.size() && groups[j].bbox.min.x() <= g1.bbox.max.x(); ++j) {
+            const LinesGroup &g2 = groups[j];
+            if (g2.bbox.min.y() > g1.bbox.max.y() || g2.bbox.max.y() < g1.bbox.min.y()) continue;
+            BoundingBox overlap(g1.bbox.min.cwiseMax(g2.bbox.min), g1.bbox.max.cwiseMin(g2.bbox.max));
+            if (auto interRes = find_inter_of_lines_in_box(lines, g1.lines, g2.lines, overlap); interRes.has_value()) { return interRes; }
         }
     }
     return {};
@@ -259,32 +337,32 @@ ConflictResultOpt ConflictChecker::find_inter_of_lines_in_diff_objs(PrintObjectP
         }
     }
 
-    std::vector<LineWithIDs> layersLines;
-    std::vector<float>       bottomZs;
+    // Only the piles of the layers are collected serially, their lines are collected by the parallel workers.
+    std::vector<LinesBucketRanges> layersRanges;
+    std::vector<float>             bottomZs;
     while (conflictQueue.valid()) {
-        LineWithIDs lines = conflictQueue.getCurLines();
-        float curBottomZ = conflictQueue.getCurrBottomZ();
-        bottomZs.push_back(curBottomZ);
-        layersLines.push_back(std::move(lines));
+        layersRanges.push_back(conflictQueue.getCurRanges());
+        bottomZs.push_back(conflictQueue.getCurrBottomZ());
     }
 
-    bool                                                          find = false;
-    tbb::concurrent_vector<std::pair<ConflictComputeResult, float>> conflict;
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, layersLines.size()), [&](tbb::blocked_range<size_t> range) {
-        for (size_t i = range.begin(); i < range.end(); i++) {
-            auto interRes = find_inter_of_lines(layersLines[i]);
-            if (interRes.has_value()) {
-                find = true;
-                conflict.emplace_back(interRes.value(), bottomZs[i]);
+    // Report the lowest conflict, the layers above an already found conflict are skipped.
+    std::atomic<size_t>             conflictLayer(layersRanges.size());
+    std::vector<ConflictComputeOpt> conflicts(layersRanges.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layersRanges.size()), [&](tbb::blocked_range<size_t> range) {
+        for (size_t i = range.begin(); i < range.end() && i < conflictLayer.load(std::memory_order_relaxed); i++) {
+            conflicts[i] = find_inter_of_lines(LinesBucketQueue::getLinesOfRanges(layersRanges[i]));
+            if (conflicts[i].has_value()) {
+                for (size_t lowest = conflictLayer.load(); i < lowest && !conflictLayer.compare_exchange_weak(lowest, i););
                 break;
             }
         }
     });
 
+    bool find = conflictLayer < layersRanges.size();
     if (find) {
-        const void *ptr1           = conflict[0].first._obj1;
-        const void *ptr2           = conflict[0].first._obj2;
-        float       conflictPrintZ = conflict[0].second;
+        const void *ptr1           = conflicts[conflictLayer]->_obj1;
+        const void *ptr2           = conflicts[conflictLayer]->_obj2;
+        float       conflictPrintZ = bottomZs[conflictLayer];
         if (wtdptr.has_value()) {
             const FakeWipeTower *wtdp = wtdptr.value();
             if (ptr1 == wtdp || ptr2 == wtdp) {
@@ -83,6 +83,10 @@ public:
     LineWithIDs curLines() const
     {
         auto [b, e] = curRange();
+        return lines(b, e);
+    }
+    LineWithIDs lines(int b, int e) const
+    {
         LineWithIDs lines;
         for (int i = b; i < e; ++i) {
             for (const ExtrusionPath &path : _piles[i].paths) {
@@ -102,6 +106,16 @@ public:
     friend bool operator==(const LinesBucket &left, const LinesBucket &right) { return left._curBottomZ == right._curBottomZ; }
 };
 
+// Piles [begin, end) of a bucket to be converted to lines later, possibly in parallel.
+struct LinesBucketRange
+{
+    const LinesBucket *bucket;
+    int                begin;
+    int                end;
+};
+
+using LinesBucketRanges = std::vector<LinesBucketRange>;
+
 struct LinesBucketPtrComp
 {
     bool operator()(const LinesBucket *left, const LinesBucket *right) { return *left > *right; }
@@ -118,6 +132,9 @@ public:
     bool        valid() const { return line_bucket_ptr_queue.empty() == false; }
     float       getCurrBottomZ();
     LineWithIDs getCurLines() const;
+    // Same as getCurLines(), but the lines are only collected by getLinesOfRanges().
+    LinesBucketRanges getCurRanges() const;
+    static LineWithIDs getLinesOfRanges(const LinesBucketRanges &ranges);
 };
 
 void getExtrusionPathsFromEntity(const ExtrusionEntityCollection *entity, ExtrusionPaths &paths);
@@ -144,6 +161,7 @@ using ConflictObjName = std::optional<std::pair<std::string, std::string>>;
 struct ConflictChecker
 {
     static ConflictResultOpt  find_inter_of_lines_in_diff_objs(PrintObjectPtrs objs, std::optional<const FakeWipeTower *> wtdptr);
+    // Only the lines of objects with overlapping bounding boxes are rasterized and tested against each other.
     static ConflictComputeOpt find_inter_of_lines(const LineWithIDs &lines);
     static ConflictComputeOpt line_intersect(const LineWithID &l1, const LineWithID &l2);
 };
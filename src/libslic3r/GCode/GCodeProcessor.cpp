@@ -623,14 +623,19 @@ public:
     enum class EWriteType { BySize, ByTime };
 
 private:
-    static void update_lines_ends_and_out_file_pos(const std::string& out_string, std::vector<size_t>& lines_ends, size_t* out_file_pos)
+    // Record the end of each line of out_buffer starting at begin, out_file_pos being the file offset of out_buffer[begin].
+    static void update_lines_ends_and_out_file_pos(const std::string& out_buffer, size_t begin, std::vector<size_t>& lines_ends, size_t* out_file_pos)
     {
-        for (size_t i = 0; i < out_string.size(); ++i) {
-            if (out_string[i] == '\n')
-                lines_ends.emplace_back((out_file_pos != nullptr) ? *out_file_pos + i + 1 : i + 1);
+        const size_t pos       = (out_file_pos != nullptr) ? *out_file_pos : 0;
+        const char  *begin_ptr = out_buffer.data() + begin;
+        const char  *end       = out_buffer.data() + out_buffer.size();
+        for (const char *c = begin_ptr; c != end;) {
+            c = GCodeReader::find_end_of_line(c, end);
+            if (c != end && *c++ == '\n')
+                lines_ends.emplace_back(pos + size_t(c - begin_ptr));
         }
         if (out_file_pos != nullptr)
-            *out_file_pos += out_string.size();
+            *out_file_pos += out_buffer.size() - begin;
     }
 
     struct LineData
@@ -826,46 +831,43 @@ public:
         if (m_lines.empty())
             return;
 
-        // collect lines to write into a single string
-        std::string out_string;
-        if (!m_lines.empty()) {
-            if (m_write_type == EWriteType::ByTime) {
-                while (m_lines.front().times[Normal] < m_times[Normal] - backtrace_time) {
-                    const LineData& data = m_lines.front();
-                    out_string += data.line;
-                    m_size -= data.line.length();
-                    m_lines.pop_front();
+        // collect lines to write into the output buffer
+        const size_t out_begin = m_out_buffer.size();
+        if (m_write_type == EWriteType::ByTime) {
+            while (!m_lines.empty() && m_lines.front().times[Normal] < m_times[Normal] - backtrace_time) {
+                const LineData& data = m_lines.front();
+                m_out_buffer += data.line;
+                m_size -= data.line.length();
+                m_lines.pop_front();
 #ifndef NDEBUG
-                    m_statistics.remove_line();
+                m_statistics.remove_line();
 #endif // NDEBUG
+            }
+        } else {
+            if (m_size > 65535) {
+                while (!m_lines.empty()) {
+                    m_out_buffer += m_lines.front().line;
+                    m_lines.pop_front();
                 }
-            } else {
-                if (m_size > 65535) {
-                    while (!m_lines.empty()) {
-                        out_string += m_lines.front().line;
-                        m_lines.pop_front();
-                    }
-                    m_size = 0;
+                m_size = 0;
 #ifndef NDEBUG
-                    m_statistics.remove_all_lines();
+                m_statistics.remove_all_lines();
 #endif // NDEBUG
-                }
             }
         }
 
-        {
-            write_to_file(out, out_string, result, out_path);
-            update_lines_ends_and_out_file_pos(out_string, result.lines_ends, &m_out_file_pos);
-        }
+        update_lines_ends_and_out_file_pos(m_out_buffer, out_begin, result.lines_ends, &m_out_file_pos);
+        if (m_out_buffer.size() >= OutBufferSize)
+            write_to_file(out, out_path);
     }
 
     // flush the current content of the cache to file
     void flush(FilePtr& out, GCodeProcessorResult& result, const std::string& out_path)
     {
-        // collect lines to flush into a single string
-        std::string out_string;
+        // collect lines to flush into the output buffer
+        const size_t out_begin = m_out_buffer.size();
         while (!m_lines.empty()) {
-            out_string += m_lines.front().line;
+            m_out_buffer += m_lines.front().line;
             m_lines.pop_front();
         }
         m_size = 0;
@@ -873,10 +875,8 @@ public:
         m_statistics.remove_all_lines();
 #endif // NDEBUG
 
-        {
-            write_to_file(out, out_string, result, out_path);
-            update_lines_ends_and_out_file_pos(out_string, result.lines_ends, &m_out_file_pos);
-        }
+        update_lines_ends_and_out_file_pos(m_out_buffer, out_begin, result.lines_ends, &m_out_file_pos);
+        write_to_file(out, out_path);
     }
 
     void synchronize_moves(GCodeProcessorResult& result) const
@@ -894,19 +894,24 @@ public:
     size_t get_size() const { return m_size; }
 
 private:
-    void write_to_file(FilePtr& out, const std::string& out_string, GCodeProcessorResult& result, const std::string& out_path)
+    // ExportLines::write() is called once per processed line and usually releases only a line or two,
+    // so the released lines are collected into m_out_buffer and handed to fwrite() in large chunks.
+    static constexpr size_t OutBufferSize = 1024 * 1024;
+
+    void write_to_file(FilePtr& out, const std::string& out_path)
     {
-        if (!out_string.empty()) {
-            if (true) {
-                fwrite((const void*) out_string.c_str(), 1, out_string.length(), out.f);
-                if (ferror(out.f)) {
-                    out.close();
-                    boost::nowide::remove(out_path.c_str());
-                    throw Slic3r::RuntimeError("GCode processor post process export failed.\nIs the disk full?");
-                }
+        if (!m_out_buffer.empty()) {
+            fwrite((const void*)m_out_buffer.data(), 1, m_out_buffer.length(), out.f);
+            m_out_buffer.clear();
+            if (ferror(out.f)) {
+                out.close();
+                boost::nowide::remove(out_path.c_str());
+                throw Slic3r::RuntimeError("GCode processor post process export failed.\nIs the disk full?");
             }
         }
     }
+
+    std::string m_out_buffer;
 };
 
 void GCodeProcessor::run_post_process()
@@ -1327,14 +1332,15 @@ void GCodeProcessor::run_post_process()
             size_t cnt_read = ::fread(buffer.data(), 1, buffer.size(), in.f);
             if (::ferror(in.f))
                 throw Slic3r::RuntimeError(std::string("GCode processor post process export failed.\nError while reading from file.\n"));
-            bool eof       = cnt_read == 0;
-            auto it        = buffer.begin();
-            auto it_bufend = buffer.begin() + cnt_read;
+            bool        eof       = cnt_read == 0;
+            const char *it        = buffer.data();
+            const char *it_bufend = buffer.data() + cnt_read;
             while (it != it_bufend || (eof && ! gcode_line.empty())) {
-                // Find end of line.
-                bool eol    = false;
-                auto it_end = it;
-                for (; it_end != it_bufend && ! (eol = *it_end == '\r' || *it_end == '\n'); ++ it_end) ;
+                // Find end of line, zero bytes are kept as a part of the line.
+                const char *it_end = it;
+                while ((it_end = GCodeReader::find_end_of_line(it_end, it_bufend)) != it_bufend && *it_end == 0)
+                    ++ it_end;
+                bool eol = it_end != it_bufend;
                 // End of line is indicated also if end of file was reached.
                 eol |= eof && it_end == it_bufend;
                 gcode_line.insert(gcode_line.end(), it, it_end);
@@ -2554,7 +2560,8 @@ void GCodeProcessor::process_file(const std::string& filename, std::function<voi
     m_result.id = ++s_result_id;
     initialize_result_moves();
     size_t parse_line_callback_cntr = 10000;
-    m_parser.parse_file(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
+    // The lines are tokenized in parallel ahead of the serial processing of the moves.
+    m_parser.parse_file_parallel(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
         if (-- parse_line_callback_cntr == 0) {
             // Don't call the cancel_callback() too often, do it every at every 10000'th line.
             parse_line_callback_cntr = 10000;
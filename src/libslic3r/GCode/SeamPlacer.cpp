@@ -8,6 +8,7 @@
 #include <boost/log/trivial.hpp>
 #include <random>
 #include <algorithm>
+#include <array>
 #include <queue>
 
 #include "libslic3r/AABBTreeLines.hpp"
@@ -149,12 +150,18 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
 
   bool model_contains_negative_parts = negative_volumes_start_index < triangles.indices.size();
 
+  // Rays cast from a sample point are traced through the AABB tree together in packets sharing the origin.
+  static constexpr size_t ray_packet_size = 4;
+
   std::vector<float> result(samples.positions.size());
   tbb::parallel_for(tbb::blocked_range<size_t>(0, result.size()),
                     [&triangles, &precomputed_sample_directions, model_contains_negative_parts, negative_volumes_start_index,
                      &raycasting_tree, &result, &samples, seam_position](tbb::blocked_range<size_t> r) {
                       // Maintaining hits memory outside of the loop, so it does not have to be reallocated for each query.
-                      std::vector<igl::Hit> hits;
+                      std::array<std::vector<igl::Hit>, ray_packet_size> hits;
+                      std::array<igl::Hit, ray_packet_size> first_hits;
+                      std::array<Vec3f, ray_packet_size> ray_origins;
+                      std::array<Vec3f, ray_packet_size> ray_dirs;
                       for (size_t s_idx = r.begin(); s_idx < r.end(); ++s_idx) {
                         result[s_idx] = 1.0f;
                         constexpr float decrease_step = 1.0f
@@ -171,43 +178,42 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                         Frame f;
                         f.set_from_z(normal);
 
-                        for (const auto &dir : precomputed_sample_directions) {
-                          Vec3f final_ray_dir = (f.to_world(dir));
+                        //TODO improve logic for order based boolean operations - consider order of volumes
+                        // if casting from negative volume face, invert direction, change start pos
+                        const bool casting_from_negative_volume = model_contains_negative_parts &&
+                                                                  samples.triangle_indices[s_idx] >= negative_volumes_start_index;
+                        ray_origins.fill(casting_from_negative_volume ? Vec3f(center - normal * 0.01f) : Vec3f(center + normal * 0.01f)); // start above surface.
+
+                        for (size_t first_ray = 0; first_ray < precomputed_sample_directions.size(); first_ray += ray_packet_size) {
+                          const size_t num_rays = std::min(ray_packet_size, precomputed_sample_directions.size() - first_ray);
+                          for (size_t i = 0; i < num_rays; ++i) {
+                            ray_dirs[i] = f.to_world(precomputed_sample_directions[first_ray + i]);
+                            if (casting_from_negative_volume)
+                              ray_dirs[i] = -ray_dirs[i];
+                          }
                           if (!model_contains_negative_parts) {
-                            igl::Hit hitpoint;
-                            // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
-                            // direction.
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            bool hit = AABBTreeIndirect::intersect_ray_first_hit(triangles.vertices,
-                                                                                 triangles.indices, raycasting_tree, ray_origin_d, final_ray_dir_d, hitpoint);
-                            if (hit && its_face_normal(triangles, hitpoint.id).dot(final_ray_dir) <= 0) {
-                              result[s_idx] -= decrease_step;
-                            }
-                          } else { //TODO improve logic for order based boolean operations - consider order of volumes
-                            bool casting_from_negative_volume = samples.triangle_indices[s_idx]
-                                                                >= negative_volumes_start_index;
-
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
-                              final_ray_dir = -1.0 * final_ray_dir;
-                              ray_origin_d = (center - normal * 0.01f).cast<double>();
-                            }
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
-                                                                                     triangles.indices, raycasting_tree,
-                                                                                     ray_origin_d, final_ray_dir_d, hits);
-                            if (some_hit) {
+                            uint32_t hit_mask = AABBTreeIndirect::intersect_ray_packet_first_hit<ray_packet_size>(triangles.vertices,
+                                                    triangles.indices, raycasting_tree, ray_origins.data(), ray_dirs.data(), num_rays, first_hits.data());
+                            for (size_t i = 0; i < num_rays; ++i)
+                              if ((hit_mask & (uint32_t(1) << i)) && its_face_normal(triangles, first_hits[i].id).dot(ray_dirs[i]) <= 0) {
+                                result[s_idx] -= decrease_step;
+                              }
+                          } else {
+                            AABBTreeIndirect::intersect_ray_packet_all_hits<ray_packet_size>(triangles.vertices,
+                                triangles.indices, raycasting_tree, ray_origins.data(), ray_dirs.data(), num_rays, hits.data());
+                            for (size_t i = 0; i < num_rays; ++i) {
+                              if (hits[i].empty())
+                                continue;
                               int counter = 0;
                               // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
                               //  It cannot be inside model, and it cannot be inside negative volume
-                              for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
-                                Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
-                                if (hits[hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
-                                  counter -= sgn(face_normal.dot(final_ray_dir)); // if volume face aligns with ray dir, we are leaving negative space
-                                                                                               // which in reverse hit analysis means, that we are entering negative space :) and vice versa
+                              for (int hit_index = int(hits[i].size()) - 1; hit_index >= 0; --hit_index) {
+                                Vec3f face_normal = its_face_normal(triangles, hits[i][hit_index].id);
+                                if (hits[i][hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
+                                  counter -= sgn(face_normal.dot(ray_dirs[i])); // if volume face aligns with ray dir, we are leaving negative space
+                                                                                 // which in reverse hit analysis means, that we are entering negative space :) and vice versa
                                 } else {
-                                  counter += sgn(face_normal.dot(final_ray_dir));
+                                  counter += sgn(face_normal.dot(ray_dirs[i]));
                                 }
                               }
                               if (counter == 0) {
@@ -14,6 +14,30 @@
 #include <Shiny/Shiny.h>
 #include <fast_float/fast_float.h>
 
+#include <atomic>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SLIC3R_GCODEREADER_SSE2
+    #include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+    #include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 namespace Slic3r {
 
 void GCodeReader::apply_config(const GCodeConfig &config)
@@ -26,7 +50,56 @@ void GCodeReader::apply_config(const DynamicPrintConfig &config)
     m_config.apply(config, true);
 }
 
-const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command)
+// Index of the lowest set bit of a non-zero mask.
+static inline int lowest_bit_set(unsigned int mask)
+{
+    assert(mask != 0);
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward(&idx, mask);
+    return int(idx);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+const char* GCodeReader::find_end_of_line(const char *begin, const char *end)
+{
+    const char *c = begin;
+#ifdef __AVX2__
+    {
+        const __m256i cr   = _mm256_set1_epi8('\r');
+        const __m256i lf   = _mm256_set1_epi8('\n');
+        const __m256i zero = _mm256_setzero_si256();
+        for (; end - c >= 32; c += 32) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c));
+            unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, cr), _mm256_cmpeq_epi8(chunk, lf)), _mm256_cmpeq_epi8(chunk, zero)));
+            if (mask != 0)
+                return c + lowest_bit_set(mask);
+        }
+    }
+#endif
+#ifdef SLIC3R_GCODEREADER_SSE2
+    {
+        const __m128i cr   = _mm_set1_epi8('\r');
+        const __m128i lf   = _mm_set1_epi8('\n');
+        const __m128i zero = _mm_setzero_si128();
+        for (; end - c >= 16; c += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c));
+            unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, lf)), _mm_cmpeq_epi8(chunk, zero)));
+            if (mask != 0)
+                return c + lowest_bit_set(mask);
+        }
+    }
+#endif
+    // Scalar tail, also the fallback for platforms without SSE2.
+    for (; c < end && ! is_end_of_line(*c); ++ c) ;
+    return c;
+}
+
+const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command) const
 {
     PROFILE_FUNC();
 
@@ -82,11 +155,10 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
                 c = skip_word(c);
         }
     }
-    
-    if (gline.has(E) && m_config.use_relative_e_distances)
-        m_position[E] = 0;
 
-    // Skip the rest of the line.
+    // Skip the rest of the line, usually a comment.
+    c = find_end_of_line(c, end);
+    // The line may continue past end if the caller did not terminate it there.
     for (; ! is_end_of_line(*c); ++ c);
 
     // Copy the raw string including the comment, without the trailing newlines.
@@ -142,11 +214,14 @@ bool GCodeReader::parse_file_raw_internal(const std::string &filename, ParseLine
         auto it_bufend = buffer.begin() + cnt_read;
         while (it != it_bufend || (eof && ! gcode_line.empty())) {
             // Find end of line.
-            bool eol    = false;
-            auto it_end = it;
-            for (; it_end != it_bufend && ! (eol = *it_end == '\r' || *it_end == '\n'); ++ it_end)
-                if (*it_end == '\n')
-                    line_end_callback(file_pos + (it_end - buffer.begin()) + 1);
+            const char *pbegin  = buffer.data() + (it - buffer.begin());
+            const char *pbufend = buffer.data() + cnt_read;
+            const char *pend    = find_end_of_line(pbegin, pbufend);
+            // Skip zero characters, they do not terminate a line read from a file.
+            while (pend != pbufend && *pend == 0)
+                pend = find_end_of_line(pend + 1, pbufend);
+            auto it_end = it + (pend - pbegin);
+            bool eol    = it_end != it_bufend;
             // End of line is indicated also if end of file was reached.
             eol |= eof && it_end == it_bufend;
             if (eol) {
@@ -215,6 +290,111 @@ bool GCodeReader::parse_file(const std::string &file, callback_t callback, std::
     return ret;
 }
 
+bool GCodeReader::parse_file_parallel(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends)
+{
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  before parse_file_parallel %1%") % file.c_str();
+    lines_ends.clear();
+
+    FilePtr in{ boost::nowide::fopen(file.c_str(), "rb") };
+    if (in.f == nullptr)
+        return false;
+
+    // A block of whole lines read from the file, the last line of the file may not be terminated by a newline.
+    struct Block {
+        // Zero terminated, the tokenized lines point into this buffer.
+        std::vector<char>                                buffer;
+        // File position of the start of the buffer.
+        size_t                                           file_pos { 0 };
+        std::vector<GCodeLine>                           lines;
+        std::vector<std::pair<const char*, const char*>> commands;
+        std::vector<size_t>                              lines_ends;
+    };
+
+    // Read the input stream 640kB at a time and split it into blocks of whole lines.
+    static constexpr const size_t read_size = 65536 * 10;
+    std::vector<char>  remainder;
+    size_t             file_pos  = 0;
+    bool               eof       = false;
+    bool               failed    = false;
+    std::atomic<bool>  cancelled { false };
+    const auto reader = tbb::make_filter<void, std::shared_ptr<Block>>(slic3r_tbb_filtermode::serial_in_order,
+        [&](tbb::flow_control &fc) -> std::shared_ptr<Block> {
+            auto block = std::make_shared<Block>();
+            for (;;) {
+                if (eof || cancelled) {
+                    fc.stop();
+                    return {};
+                }
+                size_t old_size = remainder.size();
+                remainder.resize(old_size + read_size);
+                size_t cnt_read = ::fread(remainder.data() + old_size, 1, read_size, in.f);
+                remainder.resize(old_size + cnt_read);
+                if (::ferror(in.f)) {
+                    failed = true;
+                    fc.stop();
+                    return {};
+                }
+                eof = cnt_read == 0;
+                // Cut the data read so far after the last newline, the rest will be completed by the next read.
+                auto it_last_eol = std::find(remainder.rbegin(), remainder.rend(), '\n');
+                size_t block_size = eof ? remainder.size() : size_t(remainder.rend() - it_last_eol);
+                if (block_size > 0) {
+                    block->buffer.assign(remainder.begin(), remainder.begin() + block_size);
+                    block->buffer.emplace_back(0);
+                    block->file_pos = file_pos;
+                    remainder.erase(remainder.begin(), remainder.begin() + block_size);
+                    file_pos += block_size;
+                    return block;
+                }
+            }
+        });
+    const auto tokenizer = tbb::make_filter<std::shared_ptr<Block>, std::shared_ptr<Block>>(slic3r_tbb_filtermode::parallel,
+        [this](std::shared_ptr<Block> block) -> std::shared_ptr<Block> {
+            CNumericLocalesSetter locales_setter;
+            const char *begin = block->buffer.data();
+            const char *end   = begin + block->buffer.size() - 1;
+            for (const char *it = begin; it != end;) {
+                // Find end of line.
+                const char *it_end = find_end_of_line(it, end);
+                // Skip zero characters, they do not terminate a line read from a file.
+                while (it_end != end && *it_end == 0)
+                    it_end = find_end_of_line(it_end + 1, end);
+                const char *line_begin = skip_whitespaces(it);
+                if (std::toupper(*line_begin) == 'N')
+                    line_begin = skip_whitespaces(skip_word(line_begin));
+                block->lines.emplace_back();
+                block->commands.emplace_back();
+                this->parse_line_internal(line_begin, it_end, block->lines.back(), block->commands.back());
+                // Skip EOL.
+                it = it_end;
+                if (it != end && *it == '\r')
+                    ++ it;
+                if (it != end && *it == '\n') {
+                    ++ it;
+                    block->lines_ends.emplace_back(block->file_pos + (it - begin));
+                }
+            }
+            return block;
+        });
+    const auto consumer = tbb::make_filter<std::shared_ptr<Block>, void>(slic3r_tbb_filtermode::serial_in_order,
+        [this, &callback, &lines_ends, &cancelled](std::shared_ptr<Block> block) {
+            // The callback may run on any of the TBB worker threads and it may parse numbers with the C library functions.
+            CNumericLocalesSetter locales_setter;
+            for (size_t i = 0; i < block->lines.size() && m_parsing; ++ i)
+                this->process_parsed_line(block->lines[i], block->commands[i], callback);
+            if (m_parsing)
+                append(lines_ends, std::move(block->lines_ends));
+            else
+                // The callback wishes to exit.
+                cancelled = true;
+        });
+
+    m_parsing = true;
+    tbb::parallel_pipeline(12, reader & tokenizer & consumer);
+    BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(":  finished parse_file_parallel %1%") % file.c_str();
+    return ! failed;
+}
+
 bool GCodeReader::parse_file_raw(const std::string &filename, raw_line_callback_t line_callback)
 {
     return this->parse_file_raw_internal(filename,
@@ -130,8 +130,7 @@ public:
     {
         std::pair<const char*, const char*> cmd;
         const char *line_end = parse_line_internal(ptr, end, gline, cmd);
-        callback(*this, gline);
-        update_coordinates(gline, cmd);
+        this->process_parsed_line(gline, cmd, callback);
         return line_end;
     }
 
@@ -144,12 +143,18 @@ public:
     // Collect positions of line ends in the binary G-code to be used by the G-code viewer when memory mapping and displaying section of G-code
     // as an overlay in the 3D scene.
     bool parse_file(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends);
+    // Same as parse_file() collecting the line ends, but the lines are tokenized by multiple threads ahead of the callback.
+    // The callback is still called from a single thread for all the lines in the order of the file.
+    bool parse_file_parallel(const std::string &file, callback_t callback, std::vector<size_t> &lines_ends);
     // Just read the G-code file line by line, calls callback (const char *begin, const char *end). Returns false if reading the file failed.
     bool parse_file_raw(const std::string &file, raw_line_callback_t callback);
 
     // To be called by the callback to stop parsing.
     void quit_parsing() { m_parsing = false; }
 
+    // Find the first '\r', '\n' or zero terminator in <begin, end), returns end if there is none. Vectorized with SSE2 / AVX2 if available.
+    static const char* find_end_of_line(const char *begin, const char *end);
+
     float& x()       { return m_position[X]; }
     float  x() const { return m_position[X]; }
     float& y()       { return m_position[Y]; }
@@ -177,8 +182,18 @@ private:
     template<typename ParseLineCallback, typename LineEndCallback>
     bool        parse_file_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback);
 
-    const char* parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command);
+    // Tokenize a single line. Does not modify the state of the reader, thus it may be called from multiple threads.
+    const char* parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command) const;
     void        update_coordinates(GCodeLine &gline, std::pair<const char*, const char*> &command);
+    // Update the reader state with a line tokenized by parse_line_internal() and pass the line to the callback.
+    template<typename Callback>
+    void        process_parsed_line(GCodeLine &gline, std::pair<const char*, const char*> &command, Callback &callback)
+    {
+        if (gline.has(E) && m_config.use_relative_e_distances)
+            m_position[E] = 0;
+        callback(*this, gline);
+        update_coordinates(gline, command);
+    }
 
     static bool         is_whitespace(char c)           { return c == ' ' || c == '\t'; }
     static bool         is_end_of_line(char c)          { return c == '\r' || c == '\n' || c == 0; }
@@ -1,5 +1,8 @@
 #include "Orient.hpp"
 #include "Geometry.hpp"
+#include "QuadricEdgeCollapse.hpp"
+#include <atomic>
+#include <memory>
 #include <numeric>
 #include <ClipperUtils.hpp>
 #include <boost/geometry/index/rtree.hpp>
@@ -53,6 +56,9 @@ namespace orientation {
 
 
 
+// Thrown by AutoOrienter when OrientParams::stopcondition requests to stop
+class OrientCanceledException : public std::exception {};
+
 // A class encapsulating the libnest2d Nester class and extending it with other
 // management and spatial index structures for acceleration.
 class AutoOrienter {
@@ -64,10 +70,6 @@ public:
     Eigen::MatrixXf normals, normals_quantize, normals_hull, normals_hull_quantize;
     Eigen::VectorXf areas, areas_hull;
     Eigen::VectorXf is_apperance; // whether a facet is outer apperance
-    Eigen::MatrixXf z_projected;
-    Eigen::VectorXf z_max, z_max_hull;  // max of projected z
-    Eigen::VectorXf z_median;  // median of projected z
-    Eigen::VectorXf z_mean;  // mean of projected z
     std::vector<Vec3f> face_normals;
     std::vector<Vec3f> face_normals_hull;
     OrientParams params;
@@ -76,6 +78,18 @@ public:
     std::vector< Vec3f> orientations;  // Vec3f == stl_normal
     std::function<void(unsigned)> progressind = { };  // default empty indicator function
 
+    // Decimated copy of a high poly mesh, which scores the candidate orientations
+    TriangleMesh proxy_mesh;
+    std::unique_ptr<AutoOrienter> proxy;
+
+    // Facets of the mesh and of its convex hull projected to an orientation
+    struct Projection {
+        Eigen::MatrixXf z_projected;
+        Eigen::VectorXf z_max, z_max_hull;  // max of projected z
+        Eigen::VectorXf z_median;  // median of projected z
+        Eigen::VectorXf z_mean;  // mean of projected z
+    };
+
 public:
     AutoOrienter(OrientMesh* orient_mesh_,
                  const OrientParams           &params_,
@@ -92,12 +106,21 @@ public:
         // std::cout << orient_mesh->name << ", angle=" << orient_mesh->overhang_angle << ", params.ASCENT=" << params.ASCENT;
 
         preprocess();
+        create_proxy();
     }
 
     AutoOrienter(TriangleMesh* mesh_)
     {
         mesh = mesh_;
         preprocess();
+        create_proxy();
+    }
+
+    AutoOrienter(TriangleMesh* mesh_, const OrientParams &params_)
+    {
+        mesh = mesh_;
+        params = params_;
+        preprocess();
     }
 
     struct VecHash {
@@ -128,17 +151,16 @@ public:
         if (progressind)
             progressind(30);
 
+        std::vector<Vec3f> candidates = refine_candidates();
+        std::vector<CostItems> costs = evaluate(candidates);
+
         std::unordered_map<Vec3f, CostItems, VecHash> results;
         BOOST_LOG_TRIVIAL(info) << CostItems::field_names();
         std::cout << CostItems::field_names() << std::endl;
-        for (int i = 0; i < orientations.size();i++) {
-            Vec3f orientation = -orientations[i];
-
-            project_vertices(orientation);
-
-            auto cost_items = get_features(orientation, params.min_volume);
+        for (int i = 0; i < candidates.size();i++) {
+            Vec3f orientation = -candidates[i];
 
-            float unprintability = target_function(cost_items, params.min_volume);
+            auto& cost_items = costs[i];
 
             results[orientation] = cost_items;
 
@@ -178,6 +200,71 @@ public:
         return best_orientation.cast<double>();
     }
 
+    // Score the candidate orientations, each of them is projected independently.
+    std::vector<CostItems> evaluate(const std::vector<Vec3f>& candidates) const
+    {
+        std::vector<CostItems> costs(candidates.size());
+        auto evaluate_candidate = [this, &candidates, &costs](size_t i) {
+            Vec3f orientation = -candidates[i];
+            costs[i] = get_features(orientation, project_vertices(orientation), params.min_volume);
+            target_function(costs[i], params.min_volume);
+        };
+
+        if (params.parallel)
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, candidates.size()), [&evaluate_candidate](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i != range.end(); ++i)
+                    evaluate_candidate(i);
+            });
+        else
+            for (size_t i = 0; i < candidates.size(); ++i)
+                evaluate_candidate(i);
+
+        return costs;
+    }
+
+    // Without a proxy all the orientations are candidates. Otherwise all of
+    // them are scored on the proxy and only the best ones and the original
+    // orientation are left to be scored on the full mesh.
+    std::vector<Vec3f> refine_candidates() const
+    {
+        if (!proxy || int(orientations.size()) <= params.proxy_refine_count)
+            return orientations;
+
+        std::vector<CostItems> proxy_costs = proxy->evaluate(orientations);
+        std::vector<size_t> order(orientations.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin() + 1, order.end(), [&proxy_costs](size_t i1, size_t i2) {
+            return proxy_costs[i1].unprintability < proxy_costs[i2].unprintability;
+        });
+        order.resize(std::max(params.proxy_refine_count, 0) + 1);
+        std::sort(order.begin(), order.end());
+
+        std::vector<Vec3f> candidates;
+        candidates.reserve(order.size());
+        for (size_t i : order)
+            candidates.emplace_back(orientations[i]);
+        return candidates;
+    }
+
+    void create_proxy()
+    {
+        if (params.proxy_facets <= 0 || mesh->facets_count() <= params.proxy_facets)
+            return;
+
+        // The decimation of a huge mesh takes seconds, let it be canceled
+        auto throw_on_cancel = [this]() {
+            if (params.stopcondition && params.stopcondition())
+                throw OrientCanceledException();
+        };
+        indexed_triangle_set its = mesh->its;
+        its_quadric_edge_collapse(its, uint32_t(params.proxy_facets), nullptr, throw_on_cancel);
+        proxy_mesh = TriangleMesh(std::move(its));
+
+        OrientParams proxy_params = params;
+        proxy_params.proxy_facets = 0;
+        proxy = std::make_unique<AutoOrienter>(&proxy_mesh, proxy_params);
+    }
+
     void preprocess()
     {
         int count_apperance = 0;
@@ -316,36 +403,38 @@ public:
         }
     }
 
-    void project_vertices(Vec3f orientation)
+    Projection project_vertices(const Vec3f& orientation) const
     {
+        Projection proj;
         int face_count = mesh->facets_count();
-        auto its = mesh->its;
-        z_projected.resize(face_count, 3);
-        z_max.resize(face_count, 1);
-        z_median.resize(face_count, 1);
-        z_mean.resize(face_count, 1);
+        const indexed_triangle_set& its = mesh->its;
+        proj.z_projected.resize(face_count, 3);
+        proj.z_max.resize(face_count, 1);
+        proj.z_median.resize(face_count, 1);
+        proj.z_mean.resize(face_count, 1);
         for (size_t i = 0; i < face_count; i++)
         {
             float z0 = its.get_vertex(i,0).dot(orientation);
             float z1 = its.get_vertex(i,1).dot(orientation);
             float z2 = its.get_vertex(i,2).dot(orientation);
-            z_projected(i, 0) = z0;
-            z_projected(i, 1) = z1;
-            z_projected(i, 2) = z2;
-            z_max(i) = MAX3(z0,z1,z2);
-            z_median(i) = MEDIAN3(z0,z1,z2);
-            z_mean(i) = (z0 + z1 + z2) / 3;
+            proj.z_projected(i, 0) = z0;
+            proj.z_projected(i, 1) = z1;
+            proj.z_projected(i, 2) = z2;
+            proj.z_max(i) = MAX3(z0,z1,z2);
+            proj.z_median(i) = MEDIAN3(z0,z1,z2);
+            proj.z_mean(i) = (z0 + z1 + z2) / 3;
         }
 
-        z_max_hull.resize(mesh_convex_hull.facets_count(), 1);
-        its = mesh_convex_hull.its;
-        for (size_t i = 0; i < z_max_hull.rows(); i++)
+        const indexed_triangle_set& its_hull = mesh_convex_hull.its;
+        proj.z_max_hull.resize(mesh_convex_hull.facets_count(), 1);
+        for (size_t i = 0; i < proj.z_max_hull.rows(); i++)
         {
-            float z0 = its.get_vertex(i,0).dot(orientation);
-            float z1 = its.get_vertex(i,1).dot(orientation);
-            float z2 = its.get_vertex(i,2).dot(orientation);
-            z_max_hull(i) = MAX3(z0, z1, z2);
+            float z0 = its_hull.get_vertex(i,0).dot(orientation);
+            float z1 = its_hull.get_vertex(i,1).dot(orientation);
+            float z2 = its_hull.get_vertex(i,2).dot(orientation);
+            proj.z_max_hull(i) = MAX3(z0, z1, z2);
         }
+        return proj;
     }
 
     static Eigen::VectorXi argsort(const Eigen::VectorXf& vec, std::string order="ascend")
@@ -372,8 +461,13 @@ public:
     }
 
     // previously calc_overhang
-    CostItems get_features(Vec3f orientation, bool min_volume = true)
+    CostItems get_features(const Vec3f& orientation, const Projection& proj, bool min_volume = true) const
     {
+        const Eigen::MatrixXf& z_projected = proj.z_projected;
+        const Eigen::VectorXf& z_max = proj.z_max;
+        const Eigen::VectorXf& z_max_hull = proj.z_max_hull;
+        const Eigen::VectorXf& z_mean = proj.z_mean;
+
         CostItems costs;
         costs.area_total = mesh->bounding_box().area();
         costs.radius = mesh->bounding_box().radius();
@@ -448,7 +542,7 @@ public:
         return costs;
     }
 
-    float target_function(CostItems& costs, bool min_volume)
+    float target_function(CostItems& costs, bool min_volume) const
     {
         float cost=0;
         float bottom = costs.bottom;//std::min(costs.bottom, params.BOTTOM_MAX);
@@ -479,22 +573,34 @@ void _orient(OrientMeshs& meshs_,
     {
         for (size_t i = 0; i != meshs_.size(); ++i) {
             auto& mesh_ = meshs_[i];
-            progressfn(i, mesh_.name);
+            if (progressfn)
+                progressfn(i, mesh_.name);
             //auto progressfn_i = [&](unsigned cnt) {progressfn(cnt, "Orienting " + mesh_.name); };
-            AutoOrienter orienter(&mesh_, params, /*progressfn_i*/{}, stopfn);
-            mesh_.orientation = orienter.process();
+            try {
+                AutoOrienter orienter(&mesh_, params, /*progressfn_i*/{}, stopfn);
+                mesh_.orientation = orienter.process();
+            } catch (const OrientCanceledException &) {
+                return;
+            }
             Geometry::rotation_from_two_vectors(mesh_.orientation, { 0,0,1 }, mesh_.axis, mesh_.angle, &mesh_.rotation_matrix);
             BOOST_LOG_TRIVIAL(info) << std::fixed << std::setprecision(3) << "v,phi: " << mesh_.axis.transpose() << ", " << mesh_.angle;
             //flush_logs();
         }
     }
     else {
-        tbb::parallel_for(tbb::blocked_range<size_t>(0, meshs_.size()), [&meshs_, &params, progressfn, stopfn](const tbb::blocked_range<size_t>& range) {
+        std::atomic<unsigned> finished{0};
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, meshs_.size()), [&meshs_, &params, &finished, progressfn, stopfn](const tbb::blocked_range<size_t>& range) {
             for (size_t i = range.begin(); i != range.end(); ++i) {
                 auto& mesh_ = meshs_[i];
-                progressfn(i, mesh_.name);
-                AutoOrienter orienter(&mesh_, params, {}, stopfn);
-                mesh_.orientation = orienter.process();
+                try {
+                    AutoOrienter orienter(&mesh_, params, {}, stopfn);
+                    mesh_.orientation = orienter.process();
+                } catch (const OrientCanceledException &) {
+                    return;
+                }
+                // The meshes finish out of order, report how many of them are done.
+                if (progressfn)
+                    progressfn(++finished, mesh_.name);
                 Geometry::rotation_from_two_vectors(mesh_.orientation, { 0,0,1 }, mesh_.axis, mesh_.angle, &mesh_.rotation_matrix);
                 mesh_.euler_angles = Geometry::extract_euler_angles(mesh_.rotation_matrix);
                 BOOST_LOG_TRIVIAL(debug) << "rotation_from_two_vectors: " << mesh_.orientation << "; " << mesh_.axis << "; " << mesh_.angle << "; euler: " << mesh_.euler_angles.transpose();
@@ -76,6 +76,15 @@ struct OrientParamsArea {
     bool min_volume = false;
     Eigen::Vector3f fun_dir;
 
+    /// Meshes with more facets score the candidate orientations on a proxy
+    /// decimated to this many facets. Zero disables the proxy, which is the
+    /// default: there are only a few tens of candidates, and decimating a mesh
+    /// takes longer than scoring all of them on the full mesh.
+    int proxy_facets = 0;
+    /// Number of the best candidates scored on the proxy, which are scored
+    /// again on the full mesh.
+    int proxy_refine_count = 4;
+
     /// Allow parallel execution.
     bool parallel = true;
 
@@ -124,8 +133,16 @@ struct OrientParams {
     bool min_volume = false;
     Eigen::Vector3f fun_dir;
 
+    /// Meshes with more facets score the candidate orientations on a proxy
+    /// decimated to this many facets. Zero disables the proxy, which is the
+    /// default: there are only a few tens of candidates, and decimating a mesh
+    /// takes longer than scoring all of them on the full mesh.
+    int proxy_facets = 0;
+    /// Number of the best candidates scored on the proxy, which are scored
+    /// again on the full mesh.
+    int proxy_refine_count = 4;
 
-    /// Allow parallel execution.
+    /// Allow parallel execution of the objects and of their candidate orientations.
     bool parallel = false;
 
     /// Progress indicator callback called when an object gets packed.
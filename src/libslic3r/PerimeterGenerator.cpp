@@ -17,6 +17,8 @@
 #include <cassert>
 #include <unordered_set>
 #include <thread>
+
+#include <tbb/parallel_for.h>
 #include "libslic3r/AABBTreeLines.hpp"
 #include "Print.hpp"
 static const int overhang_sampling_number = 6;
@@ -1084,35 +1086,49 @@ std::tuple<std::vector<ExtrusionPaths>, Polygons> generate_extra_perimeters_over
     return {extra_perims, diff(inset_overhang_area, inset_overhang_area_left_unfilled)};
 }
 
-void PerimeterGenerator::apply_extra_perimeters(ExPolygons &infill_area)
+void PerimeterGenerator::generate_extra_perimeters(const ExPolygons &infill_area, IslandOutput &out) const
 {
     if (!m_spiral_vase && this->lower_slices != nullptr && this->config->detect_overhang_wall && this->config->extra_perimeters_on_overhangs &&
         this->config->wall_loops > 0 && this->layer_id > this->object_config->raft_layers) {
         // Generate extra perimeters on overhang areas, and cut them to these parts only, to save print time and material
-        auto [extra_perimeters, filled_area] = generate_extra_perimeters_over_overhangs(infill_area, this->lower_slices_polygons(),
-                                                                                        this->config->wall_loops, this->overhang_flow,
-                                                                                        this->m_scaled_resolution, *this->object_config,
-                                                                                        *this->print_config);
-        if (!extra_perimeters.empty()) {
-            ExtrusionEntityCollection *this_islands_perimeters = static_cast<ExtrusionEntityCollection *>(this->loops->entities.back());
-            ExtrusionEntityCollection  new_perimeters{};
-            new_perimeters.no_sort = this_islands_perimeters->no_sort;
-            for (const ExtrusionPaths &paths : extra_perimeters) {
-                new_perimeters.append(paths);
-            }
-            new_perimeters.append(this_islands_perimeters->entities);
-            this_islands_perimeters->swap(new_perimeters);
-
-            SurfaceCollection orig_surfaces = *this->fill_surfaces;
-            this->fill_surfaces->clear();
-            for (const auto &surface : orig_surfaces.surfaces) {
-                auto new_surfaces = diff_ex({surface.expolygon}, filled_area);
-                this->fill_surfaces->append(new_surfaces, surface);
-            }
+        std::tie(out.extra_perimeters, out.extra_perimeters_filled_area) =
+            generate_extra_perimeters_over_overhangs(infill_area, this->lower_slices_polygons(), this->config->wall_loops, this->overhang_flow,
+                                                     this->m_scaled_resolution, *this->object_config, *this->print_config);
+    }
+}
+
+void PerimeterGenerator::apply_extra_perimeters(std::vector<ExtrusionPaths> &&extra_perimeters, const Polygons &filled_area)
+{
+    if (!extra_perimeters.empty()) {
+        ExtrusionEntityCollection *this_islands_perimeters = static_cast<ExtrusionEntityCollection *>(this->loops->entities.back());
+        ExtrusionEntityCollection  new_perimeters{};
+        new_perimeters.no_sort = this_islands_perimeters->no_sort;
+        for (ExtrusionPaths &paths : extra_perimeters) {
+            new_perimeters.append(std::move(paths));
+        }
+        new_perimeters.append(std::move(this_islands_perimeters->entities));
+        this_islands_perimeters->swap(new_perimeters);
+
+        SurfaceCollection orig_surfaces = *this->fill_surfaces;
+        this->fill_surfaces->clear();
+        for (const auto &surface : orig_surfaces.surfaces) {
+            auto new_surfaces = diff_ex({surface.expolygon}, filled_area);
+            this->fill_surfaces->append(new_surfaces, surface);
         }
     }
 }
 
+// Append the outputs of an island in the same order as if the islands were processed serially.
+void PerimeterGenerator::append_island_output(IslandOutput &&out)
+{
+    if (!out.loops.empty())
+        this->loops->append(std::move(out.loops));
+    this->gap_fill->append(std::move(out.gap_fill.entities));
+    this->fill_surfaces->append(std::move(out.fill_surfaces), stInternal);
+    this->apply_extra_perimeters(std::move(out.extra_perimeters), out.extra_perimeters_filled_area);
+    append(*this->fill_no_overlap, std::move(out.fill_no_overlap));
+}
+
 // Reorient loop direction
 static void reorient_perimeters(ExtrusionEntityCollection &entities, bool steep_overhang_contour, bool steep_overhang_hole, bool reverse_internal_only)
 {
@@ -1219,8 +1235,11 @@ void PerimeterGenerator::process_classic()
     for (const Surface &surface : all_surfaces)
         surface_exp.push_back(surface.expolygon);
     std::vector<size_t> surface_order = chain_expolygons(surface_exp);
-    for (size_t order_idx = 0; order_idx < surface_order.size(); order_idx++) {
+    std::vector<IslandOutput> island_outputs(surface_order.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, surface_order.size()), [&](const tbb::blocked_range<size_t> &range) {
+    for (size_t order_idx = range.begin(); order_idx < range.end(); ++ order_idx) {
         const Surface &surface = all_surfaces[surface_order[order_idx]];
+        IslandOutput  &out     = island_outputs[order_idx];
         // detect how many perimeters must be generated for this island
         int loop_number = this->config->wall_loops + surface.extra_perimeters - 1;  // 0-indexed loops
         int sparse_infill_density = this->config->sparse_infill_density.value;
@@ -1566,7 +1585,7 @@ void PerimeterGenerator::process_classic()
             
             // append perimeters for this slice as a collection
             if (! entities.empty())
-                this->loops->append(entities);
+                out.loops = std::move(entities);
 
         } // for each loop of an island
 
@@ -1620,7 +1639,7 @@ void PerimeterGenerator::process_classic()
                 //FIXME Vojtech: This grows by a rounded extrusion width, not by line spacing,
                 // therefore it may cover the area, but no the volume.
                 last = diff_ex(last, gap_fill.polygons_covered_by_width(10.f));
-                this->gap_fill->append(std::move(gap_fill.entities));
+                out.gap_fill.append(std::move(gap_fill.entities));
 
 			}
         }
@@ -1667,9 +1686,8 @@ void PerimeterGenerator::process_classic()
         if (!top_fills.empty()) {
             infill_exp = union_ex(infill_exp, offset_ex(top_infill_exp, double(top_infill_peri_overlap)));
         }
-        this->fill_surfaces->append(infill_exp, stInternal);
-
-        apply_extra_perimeters(infill_exp);
+        generate_extra_perimeters(infill_exp, out);
+        out.fill_surfaces = std::move(infill_exp);
 
         // BBS: get the no-overlap infill expolygons
         {
@@ -1685,10 +1703,14 @@ void PerimeterGenerator::process_classic()
                     double(-inset - infill_peri_overlap));
             if (!top_fills.empty())
                 polyWithoutOverlap = union_ex(polyWithoutOverlap, top_infill_exp);
-            this->fill_no_overlap->insert(this->fill_no_overlap->end(), polyWithoutOverlap.begin(), polyWithoutOverlap.end());
+            out.fill_no_overlap = std::move(polyWithoutOverlap);
         }
 
     } // for each island
+    });
+
+    for (IslandOutput &out : island_outputs)
+        this->append_island_output(std::move(out));
 }
 
 //BBS:
@@ -2157,7 +2179,11 @@ void PerimeterGenerator::process_arachne()
     double surface_simplify_resolution = (print_config->enable_arc_fitting && !this->has_fuzzy_skin) ? 0.2 * m_scaled_resolution : m_scaled_resolution;
     // we need to process each island separately because we might have different
     // extra perimeters for each one
-    for (const Surface& surface : all_surfaces) {
+    std::vector<IslandOutput> island_outputs(all_surfaces.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, all_surfaces.size()), [&](const tbb::blocked_range<size_t> &range) {
+    for (size_t surface_idx = range.begin(); surface_idx < range.end(); ++ surface_idx) {
+        const Surface &surface = all_surfaces[surface_idx];
+        IslandOutput  &out     = island_outputs[surface_idx];
         coord_t bead_width_0 = ext_perimeter_spacing;
         // detect how many perimeters must be generated for this island
         int loop_number = this->config->wall_loops + surface.extra_perimeters - 1; // 0-indexed loops
@@ -2182,6 +2208,7 @@ void PerimeterGenerator::process_arachne()
                                                  : -float(ext_perimeter_width / 2. - ext_perimeter_spacing / 2.));
         
         Arachne::WallToolPathsParams input_params = Arachne::make_paths_params(this->layer_id, *object_config, *print_config);
+        input_params.cache = this->wall_tool_paths_cache;
         // Set params is_top_or_bottom_layer for adjusting short-wall removal sensitivity.
         input_params.is_top_or_bottom_layer = (is_bottom_layer || is_topmost_layer) ? true : false;
 
@@ -2505,7 +2532,7 @@ void PerimeterGenerator::process_arachne()
                 reorient_perimeters(extrusion_coll, steep_overhang_contour, steep_overhang_hole,
                                     this->config->overhang_reverse_internal_only);
             }
-            this->loops->append(extrusion_coll);
+            out.loops = std::move(extrusion_coll);
         }
 
         const coord_t spacing = (perimeters.size() == 1) ? ext_perimeter_spacing2 : perimeter_spacing;
@@ -2548,9 +2575,8 @@ void PerimeterGenerator::process_arachne()
         if (!top_expolygons.empty()) {
             infill_exp = union_ex(infill_exp, offset_ex(top_expolygons, double(top_inset)));
         }
-        this->fill_surfaces->append(infill_exp, stInternal);
-
-        apply_extra_perimeters(infill_exp);
+        generate_extra_perimeters(infill_exp, out);
+        out.fill_surfaces = std::move(infill_exp);
 
         // BBS: get the no-overlap infill expolygons
         {
@@ -2561,9 +2587,13 @@ void PerimeterGenerator::process_arachne()
                 float(+min_perimeter_infill_spacing / 2.));
             if (!top_expolygons.empty())
                 polyWithoutOverlap = union_ex(polyWithoutOverlap, top_expolygons);
-            this->fill_no_overlap->insert(this->fill_no_overlap->end(), polyWithoutOverlap.begin(), polyWithoutOverlap.end());
+            out.fill_no_overlap = std::move(polyWithoutOverlap);
         }
     }
+    });
+
+    for (IslandOutput &out : island_outputs)
+        this->append_island_output(std::move(out));
 }
 
 bool PerimeterGeneratorLoop::is_internal_contour() const
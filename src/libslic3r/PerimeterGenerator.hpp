@@ -93,6 +93,8 @@ public:
     bool                                            has_fuzzy_skin = false;
     bool                                            has_fuzzy_hole = false;
     std::unordered_map<FuzzySkinConfig, ExPolygons> regions_by_fuzzify;
+    // Optional cache of the Arachne toolpaths shared by the layers of an object.
+    Arachne::WallToolPathsCache                    *wall_tool_paths_cache = nullptr;
     
     PerimeterGenerator(
         // Input:
@@ -137,9 +139,25 @@ public:
     Polygons    lower_slices_polygons() const { return m_lower_slices_polygons; }
 
 private:
+    // Outputs of a single island. The islands of a layer are processed in parallel,
+    // their outputs are then appended to the outputs of the layer in the order of the islands.
+    struct IslandOutput
+    {
+        // Collection of the perimeters of the island, appended as a single entity.
+        ExtrusionEntityCollection   loops;
+        ExtrusionEntityCollection   gap_fill;
+        ExPolygons                  fill_surfaces;
+        ExPolygons                  fill_no_overlap;
+        // Extra perimeters over overhangs and the infill area they fill.
+        std::vector<ExtrusionPaths> extra_perimeters;
+        Polygons                    extra_perimeters_filled_area;
+    };
+
     std::vector<Polygons>     generate_lower_polygons_series(float width);
     void split_top_surfaces(const ExPolygons &orig_polygons, ExPolygons &top_fills, ExPolygons &non_top_polygons, ExPolygons &fill_clip) const;
-    void apply_extra_perimeters(ExPolygons& infill_area);
+    void generate_extra_perimeters(const ExPolygons &infill_area, IslandOutput &out) const;
+    void apply_extra_perimeters(std::vector<ExtrusionPaths> &&extra_perimeters, const Polygons &filled_area);
+    void append_island_output(IslandOutput &&out);
     void process_no_bridge(Surfaces& all_surfaces, coord_t perimeter_spacing, coord_t ext_perimeter_width);
 
 private:
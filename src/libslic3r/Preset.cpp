@@ -1160,6 +1160,7 @@ static std::vector<std::string> s_Preset_print_options{
     "min_length_factor",
     "wall_maximum_resolution",
     "wall_maximum_deviation",
+    "wall_generator_cache",
     "small_perimeter_speed",
     "small_perimeter_threshold",
     "bridge_angle",
@@ -1205,6 +1206,7 @@ static std::vector<std::string> s_Preset_print_options{
     "internal_solid_infill_acceleration",
     "tree_support_auto_brim",
     "tree_support_brim_width",
+    "tree_support_area_cache",
     "gcode_comments",
     "gcode_label_objects",
     "initial_layer_travel_speed",
@@ -22,13 +22,19 @@
 #include <float.h>
 
 #include <algorithm>
+#include <chrono>
 #include <limits>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <unordered_set>
+#include <boost/algorithm/hex.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/format.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/regex.hpp>
 #include <boost/nowide/fstream.hpp>
+#include <boost/uuid/detail/md5.hpp>
 
 #include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
@@ -89,13 +95,10 @@ bool Print::has_tpu_filament() const
     return false;
 }
 
-// Called by Print::apply().
-// This method only accepts PrintConfig option keys.
-bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* new_config */, const std::vector<t_config_option_key> &opt_keys)
+// Sort PrintConfig option keys into the Print steps and the PrintObject steps they invalidate.
+// Returns false if any of the keys is not known, then all the steps have to be invalidated.
+static bool print_config_options_steps(const std::vector<t_config_option_key> &opt_keys, std::vector<PrintStep> &steps, std::vector<PrintObjectStep> &osteps)
 {
-    if (opt_keys.empty())
-        return false;
-
     // Cache the plenty of parameters, which influence the G-code generator only,
     // or they are only notes not influencing the generated G-code.
     static std::unordered_set<std::string> steps_gcode = {
@@ -241,10 +244,7 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
 
     static std::unordered_set<std::string> steps_ignore;
 
-    std::vector<PrintStep> steps;
-    std::vector<PrintObjectStep> osteps;
-    bool invalidated = false;
-
+    bool all_known = true;
     for (const t_config_option_key &opt_key : opt_keys) {
         if (steps_gcode.find(opt_key) != steps_gcode.end()) {
             // These options only affect G-code export or they are just notes without influence on the generated G-code,
@@ -398,11 +398,26 @@ bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* n
             osteps.emplace_back(posDetectOverhangsForLift);
         } else {
             // for legacy, if we can't handle this option let's invalidate all steps
-            //FIXME invalidate all steps of all objects as well?
-            invalidated |= this->invalidate_all_steps();
+            all_known = false;
             // Continue with the other opt_keys to possibly invalidate any object specific steps.
         }
     }
+    return all_known;
+}
+
+// Called by Print::apply().
+// This method only accepts PrintConfig option keys.
+bool Print::invalidate_state_by_config_options(const ConfigOptionResolver & /* new_config */, const std::vector<t_config_option_key> &opt_keys)
+{
+    if (opt_keys.empty())
+        return false;
+
+    std::vector<PrintStep> steps;
+    std::vector<PrintObjectStep> osteps;
+    bool invalidated = false;
+    if (! print_config_options_steps(opt_keys, steps, osteps))
+        //FIXME invalidate all steps of all objects as well?
+        invalidated |= this->invalidate_all_steps();
 
     sort_remove_duplicates(steps);
     for (PrintStep step : steps)
@@ -1968,6 +1983,8 @@ void  PrintObject::clear_shared_object()
         BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": this=%1%, clear previous shared object data %2%")%this %m_shared_object;
         m_layers.clear();
         m_support_layers.clear();
+        m_perimeters_dirty_all = true;
+        m_walls_to_simplify.clear();
 
         m_shared_object = nullptr;
 
@@ -2056,6 +2073,62 @@ std::map<ObjectID, unsigned int> getObjectExtruderMap(const Print& print) {
     return objectExtruderMap;
 }
 
+// Timeline of the steps of the print objects run as concurrent tasks by Print::process().
+// Logged at the debug level to show how well the object steps overlap on the available cores.
+class PrintObjectStepsTrace
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    template<typename StepFn>
+    void run(const PrintObject *object, const char *step, StepFn &&step_fn)
+    {
+        Clock::time_point start = Clock::now();
+        step_fn();
+        Clock::time_point end = Clock::now();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back({ object, step, start, end, std::this_thread::get_id() });
+    }
+
+    void log() const
+    {
+        if (m_tasks.empty() || get_logging_level() < 4)
+            return;
+        Clock::time_point start = m_tasks.front().start;
+        Clock::time_point end   = m_tasks.front().end;
+        double            busy  = 0.;
+        std::set<std::thread::id> threads;
+        for (const Task &task : m_tasks) {
+            start = std::min(start, task.start);
+            end   = std::max(end, task.end);
+            busy += std::chrono::duration<double, std::milli>(task.end - task.start).count();
+            threads.insert(task.thread);
+        }
+        double wall = std::chrono::duration<double, std::milli>(end - start).count();
+        BOOST_LOG_TRIVIAL(debug) << boost::format("Print object steps: %1% tasks on %2% threads, wall time %3$.1f ms, step time %4$.1f ms, "
+                                                  "%5$.2f object steps running in parallel on average (%6% cores)")
+                                        % m_tasks.size() % threads.size() % wall % busy % (wall > 0. ? busy / wall : 0.)
+                                        % std::thread::hardware_concurrency();
+        for (const Task &task : m_tasks)
+            BOOST_LOG_TRIVIAL(trace) << boost::format("Print object step %1% of \"%2%\": %3$.1f - %4$.1f ms, thread %5%")
+                                            % task.step % task.object->model_object()->name
+                                            % std::chrono::duration<double, std::milli>(task.start - start).count()
+                                            % std::chrono::duration<double, std::milli>(task.end - start).count() % task.thread;
+    }
+
+private:
+    struct Task
+    {
+        const PrintObject *object;
+        const char        *step;
+        Clock::time_point  start;
+        Clock::time_point  end;
+        std::thread::id    thread;
+    };
+    std::mutex        m_mutex;
+    std::vector<Task> m_tasks;
+};
+
 // Slicing process, running at a background thread.
 void Print::process(long long *time_cost_with_cache, bool use_cache)
 {
@@ -2172,82 +2245,52 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
     BOOST_LOG_TRIVIAL(info) << __FUNCTION__ << boost::format(": total object counts %1% in current print, need to slice %2%")%m_objects.size()%need_slicing_objects.size();
     BOOST_LOG_TRIVIAL(info) << "Starting the slicing process." << log_memory_info();
     if (!use_cache) {
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->make_perimeters();
+        // The steps of a print object depend on the previous steps of the same object only, therefore the chains of steps
+        // of the objects are run as independent tasks. TBB work stealing then overlaps the steps of different objects
+        // (one object generates its infill while another one generates its support), instead of waiting at the end of each
+        // step for the largest object to finish.
+        PrintObjectStepsTrace trace;
+        static constexpr const size_t num_object_steps = 7;
+        auto run_object_step = [&need_slicing_objects, &trace](PrintObject *obj, size_t step) {
+            if (need_slicing_objects.count(obj) == 0) {
+                // The layers are copied from the shared object once all objects are processed.
+                static const std::vector<PrintObjectStep> shared_steps[num_object_steps] = {
+                    { posSlice, posPerimeters }, { posEstimateCurledExtrusions }, { posPrepareInfill, posInfill }, { posIroning },
+                    { posContouring }, { posSupportMaterial }, { posDetectOverhangsForLift } };
+                for (PrintObjectStep shared_step : shared_steps[step])
+                    if (obj->set_started(shared_step))
+                        obj->set_done(shared_step);
+                return;
             }
-            else {
-                if (obj->set_started(posSlice))
-                    obj->set_done(posSlice);
-                if (obj->set_started(posPerimeters))
-                    obj->set_done(posPerimeters);
-            }
-        }
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->estimate_curled_extrusions();
-            }
-            else {
-                if (obj->set_started(posEstimateCurledExtrusions))
-                    obj->set_done(posEstimateCurledExtrusions);
-            }
-        }
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->infill();
-            }
-            else {
-                if (obj->set_started(posPrepareInfill))
-                    obj->set_done(posPrepareInfill);
-                if (obj->set_started(posInfill))
-                    obj->set_done(posInfill);
-            }
-        }
-        for (PrintObject *obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->ironing();
-            }
-            else {
-                if (obj->set_started(posIroning))
-                    obj->set_done(posIroning);
-            }
-        }
-
-        // Z-Contouring
-        for (PrintObject *obj : m_objects) {
-            bool need_contouring = need_slicing_objects.count(obj) != 0 && obj->need_z_contouring();
-            if (need_contouring) {
-                obj->contour_z();
-            } else {
-                if (obj->set_started(posContouring))
+            switch (step) {
+            case 0: trace.run(obj, "perimeters", [obj]() { obj->make_perimeters(); }); break;
+            case 1: trace.run(obj, "estimate_curled_extrusions", [obj]() { obj->estimate_curled_extrusions(); }); break;
+            case 2: trace.run(obj, "infill", [obj]() { obj->infill(); }); break;
+            case 3: trace.run(obj, "ironing", [obj]() { obj->ironing(); }); break;
+            case 4:
+                // Z-Contouring
+                if (obj->need_z_contouring())
+                    trace.run(obj, "contour_z", [obj]() { obj->contour_z(); });
+                else if (obj->set_started(posContouring))
                     obj->set_done(posContouring);
+                break;
+            case 5: trace.run(obj, "support_material", [obj]() { obj->generate_support_material(); }); break;
+            case 6: trace.run(obj, "detect_overhangs_for_lift", [obj]() { obj->detect_overhangs_for_lift(); }); break;
             }
-        }
-
-        tbb::parallel_for(tbb::blocked_range<int>(0, int(m_objects.size())),
-            [this, need_slicing_objects](const tbb::blocked_range<int>& range) {
-                for (int i = range.begin(); i < range.end(); i++) {
-                    PrintObject* obj = m_objects[i];
-                    if (need_slicing_objects.count(obj) != 0) {
-                        obj->generate_support_material();
-                    }
-                    else {
-                        if (obj->set_started(posSupportMaterial))
-                            obj->set_done(posSupportMaterial);
-                    }
-                }
-            }
-        );
-
-        for (PrintObject* obj : m_objects) {
-            if (need_slicing_objects.count(obj) != 0) {
-                obj->detect_overhangs_for_lift();
-            }
-            else {
-                if (obj->set_started(posDetectOverhangsForLift))
-                    obj->set_done(posDetectOverhangsForLift);
-            }
-        }
+        };
+        // The tree support reads the layer counts of all objects to find the layers of the skirt, thus all objects are sliced
+        // before the chains of the remaining steps start.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_objects.size(), 1), [&need_slicing_objects, &trace, this](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                if (PrintObject *obj = m_objects[i]; need_slicing_objects.count(obj) != 0)
+                    trace.run(obj, "slice", [obj]() { obj->slice(); });
+        });
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_objects.size(), 1), [this, &run_object_step](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                for (size_t step = 0; step < num_object_steps; ++ step)
+                    run_object_step(m_objects[i], step);
+        });
+        trace.log();
     }
     else {
         for (PrintObject *obj : m_objects) {
@@ -3666,6 +3709,7 @@ const std::string PrintStatistics::TotalFilamentUsedWipeTowerValueMask = "; tota
 #define JSON_ARC_FITTING            "arc_fitting"
 #define JSON_OBJECT_NAME            "name"
 #define JSON_IDENTIFY_ID          "identify_id"
+#define JSON_CACHE_KEY            "cache_key"
 
 
 #define JSON_LAYERS                  "layers"
@@ -4399,7 +4443,104 @@ static void from_json(const json& j, groupedVolumeSlices& firstlayer_group)
     }
 }
 
-int Print::export_cached_data(const std::string& directory, bool with_space)
+std::string PrintObject::cache_key() const
+{
+    //computed once per applied state: Print::process() rewrites some of the print config (filament_map, the filament overrides)
+    //and the key looked up before processing has to match the key of the data exported after it
+    if (! m_cache_key.empty())
+        return m_cache_key;
+
+    //boost::uuids::detail::md5 is an internal namespace, see also appconfig_md5_hash_line()
+    using boost::uuids::detail::md5;
+    md5 hash;
+    auto add_bytes  = [&hash](const void *data, size_t size) { hash.process_bytes(data, size); };
+    auto add_string = [&add_bytes](const std::string &str) { size_t len = str.size(); add_bytes(&len, sizeof(len)); add_bytes(str.data(), len); };
+    auto add_config = [&add_string](const ConfigBase &config) {
+        t_config_option_keys keys = config.keys();
+        std::sort(keys.begin(), keys.end());
+        for (const std::string &key : keys) {
+            add_string(key);
+            add_string(config.opt_serialize(key));
+        }
+        add_string("");
+    };
+    auto add_facets = [&add_bytes](const FacetsAnnotation &facets) {
+        const TriangleSelector::TriangleSplittingData &data = facets.get_data();
+        size_t cnt = data.triangles_to_split.size();
+        add_bytes(&cnt, sizeof(cnt));
+        for (const TriangleSelector::TriangleBitStreamMapping &mapping : data.triangles_to_split) {
+            add_bytes(&mapping.triangle_idx, sizeof(mapping.triangle_idx));
+            add_bytes(&mapping.bitstream_start_idx, sizeof(mapping.bitstream_start_idx));
+        }
+        std::vector<unsigned char> bits(data.bitstream.begin(), data.bitstream.end());
+        append(bits, std::vector<unsigned char>(data.used_states.begin(), data.used_states.end()));
+        cnt = bits.size();
+        add_bytes(&cnt, sizeof(cnt));
+        add_bytes(bits.data(), bits.size());
+    };
+
+    //the cached data of a different build of the slicer can not be trusted
+    add_string(SoftFever_VERSION);
+    add_string(GIT_COMMIT_HASH);
+
+    const ModelObject *model_obj = this->model_object();
+    add_bytes(this->trafo().matrix().data(), sizeof(double) * 16);
+    add_bytes(this->center_offset().data(), sizeof(coord_t) * 2);
+    for (const ModelVolume *model_volume : model_obj->volumes) {
+        int type = int(model_volume->type());
+        add_bytes(&type, sizeof(type));
+        const indexed_triangle_set &its = model_volume->mesh().its;
+        size_t cnt = its.vertices.size();
+        add_bytes(&cnt, sizeof(cnt));
+        add_bytes(its.vertices.data(), its.vertices.size() * sizeof(stl_vertex));
+        cnt = its.indices.size();
+        add_bytes(&cnt, sizeof(cnt));
+        add_bytes(its.indices.data(), its.indices.size() * sizeof(stl_triangle_vertex_indices));
+        add_bytes(model_volume->get_matrix().data(), sizeof(double) * 16);
+        add_config(model_volume->config.get());
+        add_facets(model_volume->supported_facets);
+        add_facets(model_volume->seam_facets);
+        add_facets(model_volume->mmu_segmentation_facets);
+        add_facets(model_volume->fuzzy_skin_facets);
+    }
+    add_config(model_obj->config.get());
+    for (const auto &[range, range_config] : model_obj->layer_config_ranges) {
+        add_bytes(&range.first, sizeof(range.first));
+        add_bytes(&range.second, sizeof(range.second));
+        add_config(range_config.get());
+    }
+    const std::vector<coordf_t> &layer_height_profile = model_obj->layer_height_profile.get();
+    size_t cnt = layer_height_profile.size();
+    add_bytes(&cnt, sizeof(cnt));
+    add_bytes(layer_height_profile.data(), layer_height_profile.size() * sizeof(coordf_t));
+
+    //only the print config options invalidating the object steps are hashed, so that changing the G-code only options
+    //(start G-code, retractions, temperatures...) still hits the cache
+    const PrintConfig &print_config = this->print()->config();
+    t_config_option_keys print_keys = print_config.keys();
+    std::sort(print_keys.begin(), print_keys.end());
+    for (const std::string &key : print_keys) {
+        std::vector<PrintStep>       steps;
+        std::vector<PrintObjectStep> osteps;
+        if (! print_config_options_steps({ key }, steps, osteps) || ! osteps.empty()) {
+            add_string(key);
+            add_string(print_config.opt_serialize(key));
+        }
+    }
+    add_string("");
+    add_config(this->config());
+    for (int index = 0; index < this->num_printing_regions(); index++)
+        add_config(this->printing_region(index).config());
+
+    md5::digest_type digest{};
+    hash.get_digest(digest);
+    std::string digest_str;
+    boost::algorithm::hex(digest, digest + std::size(digest), std::back_inserter(digest_str));
+    m_cache_key = digest_str;
+    return digest_str;
+}
+
+int Print::export_cached_data(const std::string& directory, bool with_space, bool content_addressed)
 {
     int ret = 0;
     boost::filesystem::path directory_path(directory);
@@ -4448,12 +4589,12 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
         return;
     };
 
-    //firstly clear this directory
-    if (fs::exists(directory_path)) {
+    //firstly clear this directory, the content addressed cache is shared and only grows
+    if (!content_addressed && fs::exists(directory_path)) {
         fs::remove_all(directory_path);
     }
     try {
-        if (!fs::create_directory(directory_path)) {
+        if (!fs::is_directory(directory_path) && !fs::create_directories(directory_path)) {
             BOOST_LOG_TRIVIAL(error) << boost::format("create directory %1% failed")%directory;
             return CLI_EXPORT_CACHE_DIRECTORY_CREATE_FAILED;
         }
@@ -4477,7 +4618,12 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
         const PrintInstance &print_instance = obj->instances()[0];
         const ModelInstance *model_instance = print_instance.model_instance;
         size_t identify_id = (model_instance->loaded_id > 0)?model_instance->loaded_id: model_instance->id().id;
-        std::string file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
+        std::string cache_key = content_addressed ? obj->cache_key() : std::string();
+        std::string file_name = directory +"/obj_"+(content_addressed ? cache_key : std::to_string(identify_id))+".json";
+        if (content_addressed && fs::exists(file_name)) {
+            BOOST_LOG_TRIVIAL(info) << boost::format("object %1% already cached in %2%, skip it")%model_obj->name %file_name;
+            continue;
+        }
 
         BOOST_LOG_TRIVIAL(info) << boost::format("begin to dump object %1%, identify_id %2% to %3%")%model_obj->name %identify_id %file_name;
 
@@ -4486,6 +4632,8 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
 
             root_json[JSON_OBJECT_NAME] = model_obj->name;
             root_json[JSON_IDENTIFY_ID] = identify_id;
+            if (content_addressed)
+                root_json[JSON_CACHE_KEY] = cache_key;
 
             //export the layers
             std::vector<json> layers_json_vector(obj->layer_count());
@@ -4642,16 +4790,23 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
     boost::mutex mutex;
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, filename_vector.size()),
-        [filename_vector, &json_vector, with_space, &ret, &mutex](const tbb::blocked_range<size_t>& output_range) {
+        [filename_vector, &json_vector, with_space, content_addressed, &ret, &mutex](const tbb::blocked_range<size_t>& output_range) {
             for (size_t object_index = output_range.begin(); object_index < output_range.end(); ++ object_index) {
                 try {
+                    //the shared cache may be read by other slicing sessions, only publish completely written files
+                    std::string temp_name = content_addressed ? filename_vector[object_index] + "." + std::to_string(get_current_pid()) + ".tmp" : filename_vector[object_index];
                     boost::nowide::ofstream c;
-                    c.open(filename_vector[object_index], std::ios::out | std::ios::trunc);
+                    c.open(temp_name, std::ios::out | std::ios::trunc);
                     if (with_space)
                         c << json_vector[object_index].dump(1, '\t') << std::endl;
                     else
                         c << json_vector[object_index].dump(0) << std::endl;
                     c.close();
+                    if (content_addressed) {
+                        if (c.fail())
+                            throw Slic3r::RuntimeError("failed to write " + temp_name);
+                        fs::rename(temp_name, filename_vector[object_index]);
+                    }
                 }
                 catch(std::exception &err) {
                     BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< ": save to "<<filename_vector[object_index]<<" got a generic exception, reason = " << err.what();
@@ -4667,7 +4822,21 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
 }
 
 
-int Print::load_cached_data(const std::string& directory)
+int Print::load_cached_data(const std::string& directory, bool content_addressed)
+{
+    int ret = this->load_cached_objects(directory, content_addressed);
+    if (ret) {
+        // Don't leave a partially loaded print behind, the caller falls back to slicing from scratch.
+        for (PrintObject *obj : m_objects) {
+            obj->clear_layers();
+            obj->clear_support_layers();
+            obj->firstLayerObjGroupsMod().clear();
+        }
+    }
+    return ret;
+}
+
+int Print::load_cached_objects(const std::string& directory, bool content_addressed)
 {
     int ret = 0;
     boost::filesystem::path directory_path(directory);
@@ -4706,7 +4875,7 @@ int Print::load_cached_data(const std::string& directory)
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": object %1%'s loaded_id is 0, need to use the instance_id %2%")%model_obj->name %identify_id;
             //continue;
         }
-        std::string file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
+        std::string file_name = directory +"/obj_"+(content_addressed ? obj->cache_key() : std::to_string(identify_id))+".json";
 
         if (!fs::exists(file_name)) {
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<<boost::format(": file %1% not exist, maybe a shared object, skip it")%file_name;
@@ -4715,6 +4884,11 @@ int Print::load_cached_data(const std::string& directory)
         object_filenames.push_back({file_name, obj});
     }
 
+    if (content_addressed && object_filenames.empty()) {
+        BOOST_LOG_TRIVIAL(info) << __FUNCTION__<< boost::format(": no object found in cache %1%")%directory;
+        return CLI_IMPORT_CACHE_NOT_FOUND;
+    }
+
     boost::mutex mutex;
     std::vector<json> object_jsons(object_filenames.size());
     tbb::parallel_for(
@@ -4751,6 +4925,10 @@ int Print::load_cached_data(const std::string& directory)
 
             std::string name = root_json.at(JSON_OBJECT_NAME);
             int identify_id = root_json.at(JSON_IDENTIFY_ID);
+            if (content_addressed && fs::path(object_filenames[obj_index].first).filename().string() != "obj_" + root_json.value(JSON_CACHE_KEY, std::string()) + ".json") {
+                BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< boost::format(": cache key of %1% does not match its file name")%object_filenames[obj_index].first;
+                return CLI_IMPORT_CACHE_DATA_CAN_NOT_USE;
+            }
             int layer_count = 0, support_layer_count = 0, firstlayer_group_count = 0;
 
             layer_count = root_json[JSON_LAYERS].size();
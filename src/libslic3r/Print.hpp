@@ -457,6 +457,10 @@ public:
     void         clear_shared_object();
     void         copy_layers_from_shared_object();
     void         copy_layers_overhang_from_shared_object();
+    // Hex digest of everything the object steps depend on: meshes, transformations, painted facets, layer height profile,
+    // the object / region configs and the print config options invalidating the object steps.
+    // Used to name the object in a persistent slicing cache. Computed once after each Print::apply().
+    std::string  cache_key() const;
 
     // BBS: Boundingbox of the first layer
     BoundingBox                 firstLayerObjectBrimBoundingBox;
@@ -486,6 +490,10 @@ public:
     // It may be called for both the PrintObjectConfig and PrintRegionConfig.
     bool                    invalidate_state_by_config_options(
         const ConfigOptionResolver &old_config, const ConfigOptionResolver &new_config, const std::vector<t_config_option_key> &opt_keys);
+    // Same as above for the config of a single region. If the walls are invalidated, only the layers containing the region
+    // will get their walls regenerated by the next make_perimeters().
+    bool                    invalidate_state_by_region_config_options(
+        const PrintRegion &region, const PrintRegionConfig &old_config, const PrintRegionConfig &new_config, const std::vector<t_config_option_key> &opt_keys);
     // If ! m_slicing_params.valid, recalculate.
     void                    update_slicing_parameters();
 
@@ -564,6 +572,15 @@ private:
     // so that next call to make_perimeters() performs a union() before computing loops
     bool                    				m_typed_slices = false;
 
+    // Walls of all layers have to be regenerated, because the layers were resliced or a non-region config changed.
+    bool                                    m_perimeters_dirty_all { true };
+    // Otherwise only the layers containing these regions, whose configs changed, get their walls regenerated.
+    std::vector<const PrintRegion*>         m_perimeters_dirty_regions;
+    // Region being processed by invalidate_state_by_region_config_options().
+    const PrintRegion                      *m_invalidating_region { nullptr };
+    // Layers whose walls were generated by make_perimeters() and not yet simplified by simplify_extrusion_path().
+    std::vector<size_t>                     m_walls_to_simplify;
+
     std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> m_adaptive_fill_octrees;
     FillLightning::GeneratorPtr m_lightning_generator;
 
@@ -574,6 +591,8 @@ private:
     ExtrusionEntityCollection               m_skirt;
 
     PrintObject*                            m_shared_object{ nullptr };
+    // Cached result of cache_key(), cleared by Print::apply().
+    mutable std::string                     m_cache_key;
 
     
     // SoftFever
@@ -912,8 +931,10 @@ public:
     // If preview_data is not null, the preview_data is filled in for the G-code visualization (not used by the command line Slic3r).
     std::string         export_gcode(const std::string& path_template, GCodeProcessorResult* result, ThumbnailsGeneratorCallback thumbnail_cb = nullptr);
     //return 0 means successful
-    int                 export_cached_data(const std::string& dir_path, bool with_space=false);
-    int                 load_cached_data(const std::string& directory);
+    //if content_addressed, the objects are stored into / looked up from a persistent cache directory shared by many slicing sessions,
+    //named by a hash of everything their slicing depends on (see PrintObject::cache_key()), and already cached objects are kept.
+    int                 export_cached_data(const std::string& dir_path, bool with_space=false, bool content_addressed=false) override;
+    int                 load_cached_data(const std::string& directory, bool content_addressed=false) override;
 
     // methods for handling state
     bool                is_step_done(PrintStep step) const { return Inherited::is_step_done(step); }
@@ -1124,6 +1145,8 @@ private:
     void                _make_skirt();
     void                _make_wipe_tower();
     void                finalize_first_layer_convex_hull();
+    // Loads the objects of load_cached_data(), may leave them partially loaded on failure.
+    int                 load_cached_objects(const std::string& directory, bool content_addressed);
 
     // Islands of objects and their supports extruded at the 1st layer.
     Polygons            first_layer_islands() const;
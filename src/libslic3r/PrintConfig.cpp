@@ -542,6 +542,13 @@ static const t_config_enum_values s_keys_map_FilamentMapMode = {
 };
 CONFIG_OPTION_ENUM_DEFINE_STATIC_MAPS(FilamentMapMode)
 
+static const t_config_enum_values s_keys_map_ArrangeStrategy = {
+    { "nfp",           int(ArrangeStrategy::Nfp) },
+    { "shelf",         int(ArrangeStrategy::Shelf) },
+    { "shelf_refined", int(ArrangeStrategy::ShelfRefined) }
+};
+CONFIG_OPTION_ENUM_DEFINE_STATIC_MAPS(ArrangeStrategy)
+
 
 //BBS
 std::string get_extruder_variant_string(ExtruderType extruder_type, NozzleVolumeType nozzle_volume_type)
@@ -6113,6 +6120,14 @@ void PrintConfigDef::init_fff_params()
     def->tooltip = L("Distance from tree branch to the outermost brim line.");
     def->set_default_value(new ConfigOptionFloat(3));
 
+    def = this->add("tree_support_area_cache", coBool);
+    def->label = L("Cache the areas on disk");
+    def->category = L("Support");
+    def->tooltip = L("Store the areas avoided by the organic tree support in the temporary directory, so that slicing the same object "
+        "again after changing a support setting, which does not influence these areas, is faster. The cache takes up to 1 GB of disk space.");
+    def->mode = comDevelop;
+    def->set_default_value(new ConfigOptionBool(true));
+
     def = this->add("tree_support_tip_diameter", coFloat);
     def->label = L("Tip Diameter");
     def->category = L("Support");
@@ -6867,6 +6882,15 @@ void PrintConfigDef::init_fff_params()
     def->max = 0.05f;
     def->set_default_value(new ConfigOptionFloat(0.025f));
 
+    def = this->add("wall_generator_cache", coBool);
+    def->label = L("Reuse walls of repeated shapes");
+    def->category = L("Quality");
+    def->tooltip = L("Generate the Arachne walls of an island only once if the same island shape repeats at another position or on "
+        "another layer, as with prismatic parts or with multiple copies of a part merged into a single object. "
+        "This speeds up slicing, the walls of a repeated shape are only translated.");
+    def->mode = comDevelop;
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("initial_layer_min_bead_width", coPercent);
     def->label = L("First layer minimum wall width");
     def->category = L("Quality");
@@ -10051,6 +10075,13 @@ CLIActionsConfigDef::CLIActionsConfigDef()
     def->cli_params = "slicing_data_directory";
     def->set_default_value(new ConfigOptionString("cached_data"));
 
+    def = this->add("slicedata_cache", coString);
+    def->label = L("Slicing data cache");
+    def->tooltip = L("Reuse the slicing data of objects found in this cache directory and add the newly sliced objects to it. "
+                     "The objects are looked up by their geometry and settings.");
+    def->cli_params = "slicing_data_directory";
+    def->set_default_value(new ConfigOptionString("slicedata_cache"));
+
     /*def = this->add("export_amf", coBool);
     def->label = L("Export AMF");
     def->tooltip = L("Export the model(s) as AMF.");
@@ -10434,6 +10465,19 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->tooltip = L("If enabled, Arrange will allow rotation when placing objects.");
     def->set_default_value(new ConfigOptionBool(true));
 
+    def = this->add("arrange_strategy", coEnum);
+    def->label = L("Arrange strategy");
+    def->tooltip = L("The algorithm placing the objects on the plates.");
+    def->enum_keys_map = &ConfigOptionEnum<ArrangeStrategy>::get_enum_values();
+    def->enum_values.push_back("nfp");
+    def->enum_values.push_back("shelf");
+    def->enum_values.push_back("shelf_refined");
+    def->enum_labels.push_back(L("No-fit polygon placer"));
+    def->enum_labels.push_back(L("Shelf packing of the bounding boxes (fast, for many hundreds of objects)"));
+    def->enum_labels.push_back(L("Shelf packing refined with the no-fit polygon placer"));
+    def->cli_params = "option";
+    def->set_default_value(new ConfigOptionEnum<ArrangeStrategy>(ArrangeStrategy::Nfp));
+
     def = this->add("avoid_extrusion_cali_region", coBool);
     def->label = L("Avoid extrusion calibrate region when arranging");
     def->tooltip = L("If enabled, Arrange will avoid extrusion calibrate region when placing objects.");
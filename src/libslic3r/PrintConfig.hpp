@@ -399,6 +399,21 @@ enum FilamentMapMode {
     fmmDefault
 };
 
+// Orca: the algorithm placing the items on the beds, see arrangement::arrange().
+enum class ArrangeStrategy {
+    /// Place the items one by one with the no-fit polygon placer (default).
+    Nfp,
+    /// Pack the minimum area bounding boxes of the items into shelves. Runs in
+    /// near linear time, meant for plates with many hundreds of items.
+    /// Only rectangular beds are supported, others are arranged with Nfp.
+    /// Items of incompatible filament temperature types are shelved on separate
+    /// beds. Sequential printing and a single material per plate fall back to Nfp.
+    Shelf,
+    /// Pack the items into shelves and rearrange each of the beds
+    /// with the no-fit polygon placer afterwards.
+    ShelfRefined
+};
+
 extern std::string get_extruder_variant_string(ExtruderType extruder_type, NozzleVolumeType nozzle_volume_type);
 
 std::string get_nozzle_volume_type_string(NozzleVolumeType nozzle_volume_type);
@@ -521,6 +536,7 @@ CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS(AuthorizationType)
 CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS(WipeTowerWallType)
 CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS(PerimeterGeneratorType)
 CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS(PowerLossRecoveryMode)
+CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS(ArrangeStrategy)
 
 #undef CONFIG_OPTION_ENUM_DECLARE_STATIC_MAPS
 
@@ -983,6 +999,7 @@ PRINT_CONFIG_CLASS_DEFINE(
     ((ConfigOptionFloat,              tree_support_angle_slow))
     ((ConfigOptionInt,                tree_support_wall_count))
     ((ConfigOptionBool,               tree_support_auto_brim))
+    ((ConfigOptionBool,               tree_support_area_cache))
     ((ConfigOptionFloat,              tree_support_brim_width))
     ((ConfigOptionBool,               detect_narrow_internal_solid_infill))
     // ((ConfigOptionBool,               adaptive_layer_height))
@@ -999,6 +1016,7 @@ PRINT_CONFIG_CLASS_DEFINE(
     // Orca
     ((ConfigOptionFloat,              wall_maximum_resolution))
     ((ConfigOptionFloat,              wall_maximum_deviation))
+    ((ConfigOptionBool,               wall_generator_cache))
     ((ConfigOptionFloat,              make_overhang_printable_angle))
     ((ConfigOptionFloat,              make_overhang_printable_hole_size))
     ((ConfigOptionFloat,              tree_support_branch_distance_organic))
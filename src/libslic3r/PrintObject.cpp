@@ -8,6 +8,7 @@
 #include "Geometry.hpp"
 #include "I18N.hpp"
 #include "Layer.hpp"
+#include "Arachne/WallToolPaths.hpp"
 #include "MutablePolygon.hpp"
 #include "PrintConfig.hpp"
 #include "SLA/IndexedMesh.hpp"
@@ -512,19 +513,41 @@ void PrintObject::make_perimeters()
         BOOST_LOG_TRIVIAL(debug) << "Generating extra perimeters for region " << region_id << " in parallel - end";
     }
 
-    BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - start";
+    // If just some region configs changed since the walls were generated, the walls of the layers not containing these regions
+    // are still valid: a layer's walls only depend on its own slices and on the slices of its neighbors, which did not change.
+    std::vector<size_t> layers_to_process;
+    layers_to_process.reserve(m_layers.size());
+    for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx)
+        if (m_perimeters_dirty_all ||
+            std::any_of(m_layers[layer_idx]->regions().begin(), m_layers[layer_idx]->regions().end(), [this](const LayerRegion *layerm) {
+                return ! layerm->slices.empty() &&
+                    std::find(m_perimeters_dirty_regions.begin(), m_perimeters_dirty_regions.end(), &layerm->region()) != m_perimeters_dirty_regions.end();
+            }))
+            layers_to_process.emplace_back(layer_idx);
+
+    BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - start, " << layers_to_process.size() << " of " << m_layers.size() << " layers";
+    // Prismatic parts have the same islands layer after layer, Arachne generates their walls only once.
+    Arachne::WallToolPathsCache  wall_tool_paths_cache;
+    Arachne::WallToolPathsCache *wall_tool_paths_cache_ptr = m_config.wall_generator_cache ? &wall_tool_paths_cache : nullptr;
     tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, m_layers.size()),
-        [this](const tbb::blocked_range<size_t>& range) {
-            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+        tbb::blocked_range<size_t>(0, layers_to_process.size()),
+        [this, &layers_to_process, wall_tool_paths_cache_ptr](const tbb::blocked_range<size_t>& range) {
+            for (size_t idx = range.begin(); idx < range.end(); ++ idx) {
                 m_print->throw_if_canceled();
-                m_layers[layer_idx]->make_perimeters();
+                m_layers[layers_to_process[idx]]->make_perimeters(wall_tool_paths_cache_ptr);
             }
         }
     );
     m_print->throw_if_canceled();
+    if (Arachne::WallToolPathsCache::Statistics stats = wall_tool_paths_cache.statistics(); stats.lookups > 0)
+        BOOST_LOG_TRIVIAL(debug) << "Arachne walls cache: " << stats.lookups << " lookups, hit rate " << 100. * double(stats.hits) / double(stats.lookups)
+                                 << "%, saved " << stats.saved_ms << " ms";
     BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - end";
 
+    m_perimeters_dirty_all = false;
+    m_perimeters_dirty_regions.clear();
+    append(m_walls_to_simplify, std::move(layers_to_process));
+    sort_remove_duplicates(m_walls_to_simplify);
     this->set_done(posPerimeters);
 }
 
@@ -890,16 +913,18 @@ void PrintObject::simplify_extrusion_path()
         m_print->set_status(75, L("Optimizing toolpath"));
         BOOST_LOG_TRIVIAL(debug) << "Simplify extrusion path of object in parallel - start";
         //BBS: infill and walls
+        // Only the walls generated since the last simplification, simplifying the kept walls again would change them.
         tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, m_layers.size()),
+            tbb::blocked_range<size_t>(0, m_walls_to_simplify.size()),
             [this](const tbb::blocked_range<size_t>& range) {
-                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                for (size_t idx = range.begin(); idx < range.end(); ++ idx) {
                     m_print->throw_if_canceled();
-                    m_layers[layer_idx]->simplify_wall_extrusion_path();
+                    m_layers[m_walls_to_simplify[idx]]->simplify_wall_extrusion_path();
                 }
             }
         );
         m_print->throw_if_canceled();
+        m_walls_to_simplify.clear();
         BOOST_LOG_TRIVIAL(debug) << "Simplify wall extrusion path of object in parallel - end";
         this->set_done(posSimplifyPath);
     }
@@ -997,6 +1022,9 @@ void PrintObject::clear_layers()
             delete l;
         m_layers.clear();
     }
+    // The walls of the layers created next have to be generated from scratch.
+    m_perimeters_dirty_all = true;
+    m_walls_to_simplify.clear();
 }
 
 Layer* PrintObject::add_layer(int id, coordf_t height, coordf_t print_z, coordf_t slice_z)
@@ -1231,7 +1259,8 @@ bool PrintObject::invalidate_state_by_config_options(
             || opt_key == "tree_support_branch_angle"
             || opt_key == "tree_support_branch_angle_organic"
             || opt_key == "tree_support_angle_slow"
-            || opt_key == "tree_support_wall_count") {
+            || opt_key == "tree_support_wall_count"
+            || opt_key == "tree_support_area_cache") {
             steps.emplace_back(posSupportMaterial);
         } else if (
                opt_key == "bottom_shell_layers"
@@ -1358,6 +1387,7 @@ bool PrintObject::invalidate_state_by_config_options(
             || opt_key == "wall_distribution_count"
             || opt_key == "wall_maximum_resolution"
             || opt_key == "wall_maximum_deviation"
+            || opt_key == "wall_generator_cache"
             || opt_key == "min_feature_size"
             || opt_key == "min_length_factor"
             || opt_key == "min_bead_width") {
@@ -1430,10 +1460,25 @@ bool PrintObject::invalidate_state_by_config_options(
     return invalidated;
 }
 
+bool PrintObject::invalidate_state_by_region_config_options(
+    const PrintRegion &region, const PrintRegionConfig &old_config, const PrintRegionConfig &new_config, const std::vector<t_config_option_key> &opt_keys)
+{
+    m_invalidating_region = &region;
+    bool invalidated = this->invalidate_state_by_config_options(old_config, new_config, opt_keys);
+    m_invalidating_region = nullptr;
+    return invalidated;
+}
+
 bool PrintObject::invalidate_step(PrintObjectStep step)
 {
 	bool invalidated = Inherited::invalidate_step(step);
 
+    // Remember which layers need their walls to be regenerated. Reslicing marks all the layers dirty in clear_layers().
+    if (step == posPerimeters && m_invalidating_region != nullptr)
+        m_perimeters_dirty_regions.emplace_back(m_invalidating_region);
+    else if (step == posPerimeters)
+        m_perimeters_dirty_all = true;
+
     // propagate to dependent steps
     if (step == posPerimeters) {
 		invalidated |= this->invalidate_steps({ posPrepareInfill, posInfill, posIroning, posContouring, posSimplifyPath, posSimplifyInfill });
@@ -1468,6 +1513,7 @@ bool PrintObject::invalidate_all_steps()
     bool result = Inherited::invalidate_all_steps() | m_print->invalidate_all_steps();
 	// Then reset some of the depending values.
 	m_slicing_params.valid = false;
+    m_perimeters_dirty_all = true;
 	return result;
 }
 
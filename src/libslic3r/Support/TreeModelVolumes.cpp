@@ -19,9 +19,14 @@
 #include "../Utils.hpp"
 #include "../format.hpp"
 
+#include <chrono>
+#include <sstream>
 #include <string_view>
+#include <thread>
 
+#include <boost/filesystem.hpp>
 #include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
 
 #include <tbb/parallel_for.h>
 #include <tbb/task_group.h>
@@ -103,6 +108,7 @@ TreeModelVolumes::TreeModelVolumes(
         m_radius_0 = config.getRadius(0);
         m_raft_layers = config.raft_layers;
         m_current_outline_idx = 0;
+        m_precalculated_cache_enabled = print_object.config().tree_support_area_cache;
 
         m_layer_outlines.emplace_back(mesh_settings, std::vector<Polygons>{});
         std::vector<Polygons> &outlines = m_layer_outlines.front().second;
@@ -222,6 +228,14 @@ void TreeModelVolumes::precalculate(const PrintObject& print_object, const coord
     // Now that required_avoidance_limit contains the maximum of ild and regular required radius just copy.
     std::vector<RadiusLayerPair> relevant_collision_radiis{ radius_until_layer.begin(), radius_until_layer.end() };
 
+    // Reuse the areas calculated by a previous run with the same object outlines and the same settings the areas depend on.
+    const std::string cache_path = this->precalculated_cache_path(max_layer, relevant_collision_radiis, relevant_avoidance_radiis);
+    if (! cache_path.empty() && this->load_precalculated(cache_path)) {
+        auto dur_load = 0.001 * std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - t_start).count();
+        BOOST_LOG_TRIVIAL(info) << "Loading precalculated collision and avoidance from " << cache_path << " took " << dur_load << " ms.";
+        return;
+    }
+
     // Calculate the relevant collisions
     calculateCollision(relevant_collision_radiis, throw_on_cancel);
 
@@ -253,6 +267,9 @@ void TreeModelVolumes::precalculate(const PrintObject& print_object, const coord
 //    m_precalculated = true;
     BOOST_LOG_TRIVIAL(info) << "Precalculating collision took" << dur_col << " ms. Precalculating avoidance took " << dur_avo << " ms.";
 
+    if (! cache_path.empty())
+        this->save_precalculated(cache_path);
+
 #if 0
     // Paint caches into SVGs:
     auto paint_cache_into_SVGs = [this](const RadiusLayerPolygonCache &cache, std::string_view name) {
@@ -861,12 +878,50 @@ coord_t TreeModelVolumes::ceilRadius(const coord_t radius) const
     return out;
 }
 
+template<typename Mutex>
+std::unique_lock<Mutex> TreeModelVolumes::RadiusLayerPolygonCache::lock(Mutex &mutex)
+{
+    std::unique_lock<Mutex> lock(mutex, std::try_to_lock);
+    if (! lock.owns_lock()) {
+        auto t_start = std::chrono::steady_clock::now();
+        lock.lock();
+        m_contention_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t_start).count(), std::memory_order_relaxed);
+    }
+    return lock;
+}
+
 void TreeModelVolumes::RadiusLayerPolygonCache::allocate_layers(size_t num_layers)
 {
+    // Fast path, the layers are only ever added.
     if (num_layers > m_data.size()) {
-        if (num_layers > m_data.capacity())
-            reserve_power_of_2(m_data, num_layers);
-        m_data.resize(num_layers, {});
+        std::unique_lock<std::mutex> guard = this->lock(m_layers_mutex);
+        m_data.grow(num_layers);
+    }
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::insert(LayerIndex layer_idx, coord_t radius, Polygons &&polygons)
+{
+    allocate_layers(layer_idx + 1);
+    LayerData &layer = m_data[layer_idx];
+    std::unique_lock<std::mutex> guard = this->lock(layer.mutex);
+    // Keep the first value inserted for a radius, references to it may have been handed out already.
+    if (layer.find(radius) == nullptr)
+        layer.entries.push_back({ radius, std::move(polygons) });
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::clear_all_but_radius0()
+{
+    for (size_t layer_idx = 0; layer_idx < m_data.size(); ++ layer_idx) {
+        auto &entries = m_data[layer_idx].entries;
+        if (entries.empty())
+            continue;
+        size_t smallest = 0;
+        for (size_t i = 1; i < entries.size(); ++ i)
+            if (entries[i].radius < entries[smallest].radius)
+                smallest = i;
+        if (smallest != 0)
+            std::swap(entries[0], entries[smallest]);
+        entries.truncate(1);
     }
 }
 
@@ -874,13 +929,261 @@ void TreeModelVolumes::RadiusLayerPolygonCache::allocate_layers(size_t num_layer
 std::vector<std::pair<TreeModelVolumes::RadiusLayerPair, std::reference_wrapper<const Polygons>>> TreeModelVolumes::RadiusLayerPolygonCache::sorted() const
 {
     std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> out;
-    for (auto &layer : m_data) {
-        auto layer_idx = LayerIndex(&layer - m_data.data());
-        for (auto &radius_polygons : layer)
-            out.emplace_back(std::make_pair(radius_polygons.first, layer_idx), radius_polygons.second);
+    for (size_t layer_idx = 0; layer_idx < m_data.size(); ++ layer_idx) {
+        const auto &entries = m_data[layer_idx].entries;
+        size_t      first   = out.size();
+        for (size_t i = 0; i < entries.size(); ++ i)
+            out.emplace_back(std::make_pair(entries[i].radius, LayerIndex(layer_idx)), entries[i].polygons);
+        std::sort(out.begin() + first, out.end(), [](auto &l, auto &r){ return l.first.first < r.first.first; });
     }
     assert(std::is_sorted(out.begin(), out.end(), [](auto &l, auto &r){ return l.first.second < r.first.second || (l.first.second == r.first.second) && l.first.first < r.first.first; }));
     return out;
 }
 
+void TreeModelVolumes::RadiusLayerPolygonCache::save(std::ostream &out) const
+{
+    auto write = [&out](const auto &value) { out.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+    write(uint64_t(m_data.size()));
+    for (size_t layer_idx = 0; layer_idx < m_data.size(); ++ layer_idx) {
+        const auto &entries = m_data[layer_idx].entries;
+        write(uint64_t(entries.size()));
+        for (size_t i = 0; i < entries.size(); ++ i) {
+            write(int64_t(entries[i].radius));
+            write(uint64_t(entries[i].polygons.size()));
+            for (const Polygon &polygon : entries[i].polygons) {
+                write(uint64_t(polygon.size()));
+                out.write(reinterpret_cast<const char*>(polygon.points.data()), polygon.size() * sizeof(Point));
+            }
+        }
+    }
+}
+
+bool TreeModelVolumes::RadiusLayerPolygonCache::load(std::istream &in)
+{
+    auto read = [&in](auto &value) { return bool(in.read(reinterpret_cast<char*>(&value), sizeof(value))); };
+    // Sanity limit to not allocate huge amounts of memory when reading a corrupted file.
+    static constexpr const uint64_t max_count = uint64_t(1) << 32;
+    uint64_t num_layers;
+    if (! read(num_layers) || num_layers > max_count)
+        return false;
+    this->clear();
+    m_data.grow(num_layers);
+    for (size_t layer_idx = 0; layer_idx < num_layers; ++ layer_idx) {
+        uint64_t num_entries;
+        if (! read(num_entries) || num_entries > max_count)
+            return false;
+        for (uint64_t i = 0; i < num_entries; ++ i) {
+            int64_t  radius;
+            uint64_t num_polygons;
+            if (! read(radius) || ! read(num_polygons) || num_polygons > max_count)
+                return false;
+            Polygons polygons(num_polygons);
+            for (Polygon &polygon : polygons) {
+                uint64_t num_points;
+                if (! read(num_points) || num_points > max_count)
+                    return false;
+                polygon.points.resize(num_points);
+                if (! in.read(reinterpret_cast<char*>(polygon.points.data()), num_points * sizeof(Point)))
+                    return false;
+            }
+            m_data[layer_idx].entries.push_back({ coord_t(radius), std::move(polygons) });
+        }
+    }
+    return true;
+}
+
+// Bump when the cached areas or their calculation change.
+static constexpr const uint32_t precalculated_cache_version = 1;
+static constexpr const char     precalculated_cache_magic[] = "OrcaTreeModelVolumes";
+
+std::string TreeModelVolumes::precalculated_cache_path(LayerIndex max_layer, const std::vector<RadiusLayerPair> &collision_radii, const std::vector<RadiusLayerPair> &avoidance_radii) const
+{
+    if (! m_precalculated_cache_enabled || temporary_dir().empty())
+        return {};
+
+    MD5_CTX ctx;
+    MD5_Init(&ctx);
+    auto add = [&ctx](const auto &value) { MD5_Update(&ctx, &value, sizeof(value)); };
+    auto add_polygons = [&ctx, &add](const Polygons &polygons) {
+        add(uint64_t(polygons.size()));
+        for (const Polygon &polygon : polygons) {
+            add(uint64_t(polygon.size()));
+            MD5_Update(&ctx, polygon.points.data(), polygon.size() * sizeof(Point));
+        }
+    };
+    auto add_radii = [&add](const std::vector<RadiusLayerPair> &radii) {
+        add(uint64_t(radii.size()));
+        for (const RadiusLayerPair &r : radii) {
+            add(int64_t(r.first));
+            add(int64_t(r.second));
+        }
+    };
+
+    add(precalculated_cache_version);
+    add(int64_t(sizeof(coord_t)));
+    // Geometry of the object, support blockers and machine border.
+    for (const auto &[settings, outlines] : m_layer_outlines) {
+        // Only the settings used by calculateCollision() and the functions deriving from it.
+        add(int64_t(settings.layer_height));
+        add(int64_t(settings.resolution));
+        add(int64_t(settings.support_top_distance));
+        add(int64_t(settings.support_bottom_distance));
+        add(int64_t(settings.support_xy_distance));
+        add(settings.support_material_buildplate_only);
+        add(uint64_t(outlines.size()));
+        for (const Polygons &layer : outlines)
+            add_polygons(layer);
+    }
+    add(uint64_t(m_anti_overhang.size()));
+    for (const Polygons &layer : m_anti_overhang)
+        add_polygons(layer);
+    add_polygons(m_machine_border);
+    for (double z : m_raft_layers)
+        add(z);
+    // Derived settings.
+    for (coord_t v : { m_max_move, m_max_move_slow, m_min_resolution, m_current_min_xy_dist, m_current_min_xy_dist_delta, m_increase_until_radius, m_radius_0 })
+        add(int64_t(v));
+    add(uint64_t(m_current_outline_idx));
+    add(m_support_rests_on_model);
+    add(int64_t(max_layer));
+    add_radii(collision_radii);
+    add_radii(avoidance_radii);
+    add(uint64_t(m_ignorable_radii.size()));
+    for (coord_t r : m_ignorable_radii)
+        add(int64_t(r));
+
+    unsigned char digest[MD5_DIGEST_LENGTH];
+    MD5_Final(digest, &ctx);
+    std::string name;
+    for (unsigned char c : digest)
+        name += format("%02x", int(c));
+    return (boost::filesystem::path(temporary_dir()) / "tree_support_cache" / (name + ".bin")).string();
+}
+
+bool TreeModelVolumes::load_precalculated(const std::string &path)
+{
+    boost::system::error_code ec;
+    if (! boost::filesystem::exists(path, ec))
+        return false;
+    boost::nowide::ifstream in(path, std::ios::binary);
+    char     magic[sizeof(precalculated_cache_magic)];
+    uint32_t version;
+    bool     ok = in.read(magic, sizeof(magic)) && memcmp(magic, precalculated_cache_magic, sizeof(magic)) == 0 &&
+                  in.read(reinterpret_cast<char*>(&version), sizeof(version)) && version == precalculated_cache_version;
+    for (RadiusLayerPolygonCache *cache : this->precalculated_caches())
+        ok = ok && cache->load(in);
+    if (! ok) {
+        BOOST_LOG_TRIVIAL(warning) << "Invalid tree support cache file " << path << ", the areas will be recalculated.";
+        for (RadiusLayerPolygonCache *cache : this->precalculated_caches())
+            cache->clear();
+    } else
+        // Mark the entry as recently used for pruning.
+        boost::filesystem::last_write_time(path, std::time(nullptr), ec);
+    return ok;
+}
+
+// Write the serialized caches into the cache file, then prune the least recently used cache files.
+static void write_precalculated_cache_file(const std::string &path, const std::string &data)
+{
+    // Limits of the cache directory, the least recently used files are removed first.
+    static constexpr const size_t    max_files      = 8;
+    static constexpr const uintmax_t max_total_size = uintmax_t(1) << 30;
+    // Temporary files left over by a slicer that was closed while writing.
+    static constexpr const std::time_t max_tmp_age  = 24 * 60 * 60;
+    // Files written or loaded recently are never removed, another running slicer may have just stored or be loading them.
+    static constexpr const std::time_t min_bin_age  = 10 * 60;
+    // Serializes the writers of the objects of this slicer, thus they do not prune each other's files.
+    static std::mutex                  mutex;
+    std::scoped_lock<std::mutex>       lock(mutex);
+
+    namespace fs = boost::filesystem;
+    boost::system::error_code ec;
+    const fs::path dir = fs::path(path).parent_path();
+    fs::create_directories(dir, ec);
+    // Write into a temporary file first, so that a concurrently running slicer never sees a partially written file.
+    // Two objects with the same geometry may be saved concurrently by a single slicer, thus the temp name is unique per thread, too.
+    const std::string path_tmp = path + "." + std::to_string(get_current_pid()) + "." +
+        std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+        boost::nowide::ofstream out(path_tmp, std::ios::binary);
+        out.write(data.data(), data.size());
+        out.close();
+        if (! out) {
+            BOOST_LOG_TRIVIAL(warning) << "Failed to write tree support cache file " << path_tmp;
+            fs::remove(path_tmp, ec);
+            return;
+        }
+    }
+    if (std::error_code err = rename_file(path_tmp, path); err) {
+        BOOST_LOG_TRIVIAL(warning) << "Failed to rename tree support cache file " << path_tmp << " to " << path << ": " << err.message();
+        fs::remove(path_tmp, ec);
+        return;
+    }
+
+    struct CacheFile {
+        std::time_t time;
+        uintmax_t   size;
+        fs::path    path;
+    };
+    std::vector<CacheFile> files;
+    const std::time_t      now = std::time(nullptr);
+    for (fs::directory_iterator it(dir, ec), end; ! ec && it != end; it.increment(ec)) {
+        boost::system::error_code ec2;
+        std::time_t time = fs::last_write_time(it->path(), ec2);
+        if (it->path().extension() == ".bin")
+            files.push_back({ time, fs::file_size(it->path(), ec2), it->path() });
+        else if (it->path().extension() == ".tmp" && ! ec2 && now - time > max_tmp_age)
+            fs::remove(it->path(), ec2);
+    }
+    std::sort(files.begin(), files.end(), [](auto &l, auto &r) { return l.time > r.time; });
+    uintmax_t total_size = 0;
+    for (size_t i = 0; i < files.size(); ++ i) {
+        total_size += files[i].size;
+        // Always keep the file just written. The limits may be exceeded for a while by the files of the slicers running concurrently.
+        if (i > 0 && (i >= max_files || total_size > max_total_size) && now - files[i].time > min_bin_age)
+            fs::remove(files[i].path, ec);
+    }
+}
+
+void TreeModelVolumes::save_precalculated(const std::string &path) const
+{
+    // Caches larger than this are not stored, reading them back would not be much faster than recalculating them.
+    static constexpr const size_t max_file_size = size_t(256) << 20;
+
+    // Serialize synchronously, as the caches may be appended to once this function returns.
+    std::ostringstream out(std::ios::binary);
+    out.write(precalculated_cache_magic, sizeof(precalculated_cache_magic));
+    out.write(reinterpret_cast<const char*>(&precalculated_cache_version), sizeof(precalculated_cache_version));
+    for (const RadiusLayerPolygonCache *cache : const_cast<TreeModelVolumes*>(this)->precalculated_caches()) {
+        cache->save(out);
+        if (size_t(out.tellp()) > max_file_size) {
+            BOOST_LOG_TRIVIAL(info) << "Tree support cache for " << path << " exceeds " << (max_file_size >> 20) << " MB, it will not be stored.";
+            return;
+        }
+    }
+    // Write the file in the background, not to delay generating the support.
+    m_precalculated_writer.run([path, data = out.str()]() { write_precalculated_cache_file(path, data); });
+}
+
+void TreeModelVolumes::log_cache_statistics() const
+{
+    auto log = [](const RadiusLayerPolygonCache &cache, std::string_view name) {
+        RadiusLayerPolygonCache::Statistics stats = cache.statistics();
+        if (stats.lookups > 0 || stats.contention_ms > 0)
+            BOOST_LOG_TRIVIAL(debug) << "Tree support " << name << " cache: " << stats.lookups << " lookups, hit rate " <<
+                (stats.lookups == 0 ? 0. : 100. * double(stats.hits) / double(stats.lookups)) << "%, writers waited for locks " << stats.contention_ms << " ms";
+    };
+    log(m_collision_cache,                    "collision");
+    log(m_collision_cache_holefree,           "collision holefree");
+    log(m_avoidance_cache,                    "avoidance");
+    log(m_avoidance_cache_slow,               "avoidance slow");
+    log(m_avoidance_cache_to_model,           "avoidance to model");
+    log(m_avoidance_cache_to_model_slow,      "avoidance to model slow");
+    log(m_placeable_areas_cache,              "placeable areas");
+    log(m_avoidance_cache_holefree,           "avoidance holefree");
+    log(m_avoidance_cache_holefree_to_model,  "avoidance holefree to model");
+    log(m_wall_restrictions_cache,            "wall restrictions");
+    log(m_wall_restrictions_cache_min,        "wall restrictions min");
+}
+
 } // namespace Slic3r::TreeSupport3D
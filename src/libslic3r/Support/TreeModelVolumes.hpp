@@ -9,7 +9,11 @@
 #ifndef slic3r_TreeModelVolumes_hpp
 #define slic3r_TreeModelVolumes_hpp
 
+#include <array>
+#include <atomic>
+#include <iosfwd>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
 
 #include <boost/functional/hash.hpp>
@@ -57,6 +61,7 @@ public:
         m_placeable_areas_cache.clear();
     }
     void clear_all_but_object_collision() { 
+        this->log_cache_statistics();
         //m_collision_cache.clear_all_but_radius0();
         m_collision_cache_holefree.clear();
         m_avoidance_cache.clear();
@@ -69,6 +74,8 @@ public:
         m_wall_restrictions_cache.clear();
         m_wall_restrictions_cache_min.clear();
     }
+    // Log lookup hit rate and lock contention of the caches at the debug level.
+    void log_cache_statistics() const;
 
     enum class AvoidanceType : int8_t
     {
@@ -198,11 +205,107 @@ private:
      */
     using RadiusLayerPair             = std::pair<coord_t, LayerIndex>;
     class RadiusLayerPolygonCache {
-        // Map from radius to Polygons. Cache of one layer collision regions.
-        using LayerData = std::map<coord_t, Polygons>;
-        // Vector of layers, at each layer map of radius to Polygons.
+        // Vector with stable element addresses, which is appended to by writers serialized by the caller,
+        // while it is being read by any number of threads without locking.
+        // Elements are stored in blocks of geometrically growing size, a block once allocated is never reallocated,
+        // thus the readers only need to check the published size before accessing an element.
+        template<typename T, size_t FirstBlockBits, size_t NumBlocks>
+        class AppendOnlyVector {
+        public:
+            AppendOnlyVector() = default;
+            AppendOnlyVector(AppendOnlyVector &&rhs) { *this = std::move(rhs); }
+            // Not thread safe.
+            AppendOnlyVector& operator=(AppendOnlyVector &&rhs) {
+                this->clear();
+                for (size_t i = 0; i < NumBlocks; ++ i)
+                    m_blocks[i].store(rhs.m_blocks[i].exchange(nullptr, std::memory_order_relaxed), std::memory_order_relaxed);
+                m_size.store(rhs.m_size.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+                return *this;
+            }
+            ~AppendOnlyVector() { this->clear(); }
+
+            AppendOnlyVector(const AppendOnlyVector&) = delete;
+            AppendOnlyVector& operator=(const AppendOnlyVector&) = delete;
+
+            // Number of elements published so far. Elements below this index may be read without locking.
+            size_t      size() const { return m_size.load(std::memory_order_acquire); }
+            bool        empty() const { return this->size() == 0; }
+            const T&    operator[](size_t idx) const { auto [block, offset] = locate(idx); return m_blocks[block].load(std::memory_order_acquire)[offset]; }
+            T&          operator[](size_t idx) { auto [block, offset] = locate(idx); return m_blocks[block].load(std::memory_order_acquire)[offset]; }
+
+            // Writer only: Grow to new_size default constructed elements.
+            void        grow(size_t new_size) {
+                if (size_t old_size = m_size.load(std::memory_order_relaxed); new_size > old_size) {
+                    this->allocate(old_size, new_size);
+                    m_size.store(new_size, std::memory_order_release);
+                }
+            }
+            // Writer only: Fill in the next element, then publish it.
+            void        push_back(T &&value) {
+                size_t idx = m_size.load(std::memory_order_relaxed);
+                this->allocate(idx, idx + 1);
+                (*this)[idx] = std::move(value);
+                m_size.store(idx + 1, std::memory_order_release);
+            }
+            // Not thread safe.
+            void        truncate(size_t new_size) {
+                for (size_t i = new_size; i < m_size.load(std::memory_order_relaxed); ++ i)
+                    (*this)[i] = T{};
+                m_size.store(std::min(new_size, m_size.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+            }
+            // Not thread safe.
+            void        clear() {
+                for (std::atomic<T*> &block : m_blocks)
+                    delete[] block.exchange(nullptr, std::memory_order_relaxed);
+                m_size.store(0, std::memory_order_relaxed);
+            }
+
+        private:
+            static constexpr size_t block_size(size_t block) { return size_t(1) << (block + FirstBlockBits); }
+            // Block b holds elements <(2^b - 1) * 2^FirstBlockBits, (2^(b+1) - 1) * 2^FirstBlockBits).
+            static std::pair<size_t, size_t> locate(size_t idx) {
+                size_t i     = idx + block_size(0);
+                size_t block = 0;
+                while (i >= block_size(block + 1))
+                    ++ block;
+                assert(block < NumBlocks);
+                return { block, i - block_size(block) };
+            }
+            // Allocate all blocks needed to store elements <begin, end).
+            void allocate(size_t begin, size_t end) {
+                if (begin == end)
+                    return;
+                for (size_t block = locate(begin).first, last = locate(end - 1).first; block <= last; ++ block)
+                    if (m_blocks[block].load(std::memory_order_relaxed) == nullptr)
+                        m_blocks[block].store(new T[block_size(block)](), std::memory_order_release);
+            }
+
+            std::array<std::atomic<T*>, NumBlocks>  m_blocks {};
+            std::atomic<size_t>                     m_size { 0 };
+        };
+
+        // Polygons of one layer for a single radius.
+        struct RadiusPolygons {
+            coord_t     radius { 0 };
+            Polygons    polygons;
+        };
+        // Cache of one layer collision regions. Unsorted, each radius is stored at most once.
+        // Readers scan the published entries without locking, the writers of a single layer are serialized by the layer mutex.
         // Reference to Polygons returned shall be stable to insertion.
-        using Layers = std::vector<LayerData>;
+        struct LayerData {
+            AppendOnlyVector<RadiusPolygons, 3, 24> entries;
+            std::mutex                              mutex;
+
+            const RadiusPolygons* find(coord_t radius) const {
+                for (size_t i = 0, n = entries.size(); i < n; ++ i)
+                    if (const RadiusPolygons &e = entries[i]; e.radius == radius)
+                        return &e;
+                return nullptr;
+            }
+        };
+        // Vector of layers, at each layer the polygons per radius.
+        using Layers = AppendOnlyVector<LayerData, 6, 26>;
+
     public:
         RadiusLayerPolygonCache() = default;
         RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) : m_data(std::move(rhs.m_data)) {}
@@ -212,28 +315,24 @@ private:
         RadiusLayerPolygonCache& operator=(const RadiusLayerPolygonCache&) = delete;
 
         void insert(std::vector<std::pair<RadiusLayerPair, Polygons>> &&in) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             for (auto &d : in)
-                this->get_allocate_layer_data(d.first.second).emplace(d.first.first, std::move(d.second));
+                this->insert(d.first.second, d.first.first, std::move(d.second));
         }
         // by layer
         void insert(std::vector<std::pair<coord_t, Polygons>> &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             for (auto &d : in)
-                this->get_allocate_layer_data(d.first).emplace(radius, std::move(d.second));
+                this->insert(d.first, radius, std::move(d.second));
         }
         void insert(std::vector<Polygons> &&in, coord_t first_layer_idx, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             allocate_layers(first_layer_idx + in.size());
             for (auto &d : in)
-                m_data[first_layer_idx ++].emplace(radius, std::move(d));
+                this->insert(first_layer_idx ++, radius, std::move(d));
         }
         void insert(LayerPolygonCache &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             LayerIndex i = in.begin();
             allocate_layers(i + LayerIndex(in.size()));
             for (auto &d : in.polygons_mutable())
-                m_data[i ++].emplace(radius, std::move(d));
+                this->insert(i ++, radius, std::move(d));
         }
         /*!
          * \brief Checks a cache for a given RadiusLayerPair and returns it if it is found
@@ -241,29 +340,37 @@ private:
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
         std::optional<std::reference_wrapper<const Polygons>> getArea(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
+#ifndef NDEBUG
+            m_lookups.fetch_add(1, std::memory_order_relaxed);
+#endif // NDEBUG
             if (key.second >= LayerIndex(m_data.size()))
                 return std::optional<std::reference_wrapper<const Polygons>>{};
-            const auto &layer = m_data[key.second];
-            auto it = layer.find(key.first);
-            return it == layer.end() ? 
-                std::optional<std::reference_wrapper<const Polygons>>{} : std::optional<std::reference_wrapper<const Polygons>>{ it->second };
+            const RadiusPolygons *entry = m_data[key.second].find(key.first);
+            if (entry == nullptr)
+                return std::optional<std::reference_wrapper<const Polygons>>{};
+#ifndef NDEBUG
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+#endif // NDEBUG
+            return std::optional<std::reference_wrapper<const Polygons>>{ entry->polygons };
         }
         // Get a collision area at a given layer for a radius that is a lower or equial to the key radius.
         std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> get_lower_bound_area(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
+#ifndef NDEBUG
+            m_lookups.fetch_add(1, std::memory_order_relaxed);
+#endif // NDEBUG
             if (key.second >= LayerIndex(m_data.size()))
                 return {};
-            const auto &layer = m_data[key.second];
-            if (layer.empty())
+            const RadiusPolygons *best = nullptr;
+            const auto           &entries = m_data[key.second].entries;
+            for (size_t i = 0, n = entries.size(); i < n; ++ i)
+                if (const RadiusPolygons &e = entries[i]; e.radius <= key.first && (best == nullptr || e.radius > best->radius))
+                    best = &e;
+            if (best == nullptr)
                 return {};
-            auto it = layer.lower_bound(key.first);
-            if (it == layer.end() || it->first != key.first) {
-                if (it == layer.begin())
-                    return {};
-                -- it;
-            }
-            return std::make_pair(it->first, std::reference_wrapper<const Polygons>(it->second));
+#ifndef NDEBUG
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+#endif // NDEBUG
+            return std::make_pair(best->radius, std::reference_wrapper<const Polygons>(best->polygons));
         }
         /*!
          * \brief Get the highest already calculated layer in the cache.
@@ -273,10 +380,9 @@ private:
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
         LayerIndex getMaxCalculatedLayer(coord_t radius) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
             auto layer_idx = LayerIndex(m_data.size()) - 1;
             for (; layer_idx > 0; -- layer_idx)
-                if (const auto &layer = m_data[layer_idx]; layer.find(radius) != layer.end())
+                if (m_data[layer_idx].find(radius) != nullptr)
                     break;
             // The placeable on model areas do not exist on layer 0, as there can not be model below it. As such it may be possible that layer 1 is available, but layer 0 does not exist.
             return layer_idx == 0 ? -1 : layer_idx;
@@ -285,28 +391,47 @@ private:
         // For debugging purposes, sorted by layer index, then by radius.
         [[nodiscard]] std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> sorted() const;
 
-        void clear() { m_data.clear(); }
-        void clear_all_but_radius0() { 
-            for (LayerData &l : m_data) {
-                auto begin = l.begin();
-                auto end = l.end();
-                if (begin != end && ++ begin != end)
-                    l.erase(begin, end);
-            }
+        // Lookups and hits are only counted in debug builds, the shared counters would be contended by the readers.
+        struct Statistics {
+            size_t  lookups         { 0 };
+            size_t  hits            { 0 };
+            // Time the writers spent waiting for a lock.
+            double  contention_ms   { 0 };
+        };
+        Statistics statistics() const {
+#ifndef NDEBUG
+            return { m_lookups.load(std::memory_order_relaxed), m_hits.load(std::memory_order_relaxed), 1e-6 * double(m_contention_ns.load(std::memory_order_relaxed)) };
+#else // NDEBUG
+            return { 0, 0, 1e-6 * double(m_contention_ns.load(std::memory_order_relaxed)) };
+#endif // NDEBUG
         }
 
+        // Not thread safe.
+        void clear() { m_data.clear(); }
+        // Not thread safe.
+        void clear_all_but_radius0();
+
+        // Binary serialization for the persistent cache of precalculated areas. Not thread safe.
+        void save(std::ostream &out) const;
+        // Returns false if the stream is truncated or malformed, the cache is left in an undefined state then.
+        bool load(std::istream &in);
+
     private:
-        LayerData&          get_allocate_layer_data(LayerIndex layer_idx) {
-            allocate_layers(layer_idx + 1);
-            return m_data[layer_idx];
-        }
+        void                insert(LayerIndex layer_idx, coord_t radius, Polygons &&polygons);
         void                allocate_layers(size_t num_layers);
-
-        Layers              m_data;
-        mutable std::mutex  m_mutex;
+        template<typename Mutex>
+        std::unique_lock<Mutex> lock(Mutex &mutex);
+
+        Layers                          m_data;
+        // Serializes growing of m_data.
+        std::mutex                      m_layers_mutex;
+#ifndef NDEBUG
+        mutable std::atomic<size_t>     m_lookups       { 0 };
+        mutable std::atomic<size_t>     m_hits          { 0 };
+#endif // NDEBUG
+        std::atomic<int64_t>            m_contention_ns { 0 };
     };
 
-
     /*!
      * \brief Provides the areas that have to be avoided by the tree's branches to prevent collision with the model on this layer. Holes are removed.
      *
@@ -415,6 +540,17 @@ private:
         calculateWallRestrictions(std::vector<RadiusLayerPair>{ RadiusLayerPair(key) }, []{});
     }
 
+    /*!
+     * \brief Path of the on-disk cache of the areas calculated by precalculate().
+     *
+     * The file name is a hash of the layer outlines, the anti overhang areas and of all settings the collision, avoidance,
+     * placeable and wall restriction areas depend on, thus the areas are reused after changing any other support setting.
+     * \return Empty string if the cache is disabled by the tree_support_area_cache option or because no temporary directory was set.
+     */
+    std::string precalculated_cache_path(LayerIndex max_layer, const std::vector<RadiusLayerPair> &collision_radii, const std::vector<RadiusLayerPair> &avoidance_radii) const;
+    bool        load_precalculated(const std::string &path);
+    void        save_precalculated(const std::string &path) const;
+
     /*!
      * \brief The maximum distance that the center point of a tree branch may move in consecutive layers if it has to avoid the model.
      */
@@ -545,6 +681,31 @@ private:
     // restriction would be slower.    
     RadiusLayerPolygonCache     m_wall_restrictions_cache_min;
 
+    // Caches stored by save_precalculated(), in the order of serialization.
+    std::array<RadiusLayerPolygonCache*, 11> precalculated_caches() {
+        return { &m_collision_cache, &m_collision_cache_holefree, &m_avoidance_cache, &m_avoidance_cache_slow, &m_avoidance_cache_to_model,
+                 &m_avoidance_cache_to_model_slow, &m_placeable_areas_cache, &m_avoidance_cache_holefree, &m_avoidance_cache_holefree_to_model,
+                 &m_wall_restrictions_cache, &m_wall_restrictions_cache_min };
+    }
+
+    // Writes the file of save_precalculated() in the background. Joined before it is replaced or destroyed,
+    // thus the file is complete once the volumes of the object are released.
+    class PrecalculatedWriter {
+    public:
+        PrecalculatedWriter() = default;
+        PrecalculatedWriter(PrecalculatedWriter &&rhs) = default;
+        PrecalculatedWriter& operator=(PrecalculatedWriter &&rhs) { this->join(); m_thread = std::move(rhs.m_thread); return *this; }
+        ~PrecalculatedWriter() { this->join(); }
+
+        void run(std::function<void()> &&fn) { this->join(); m_thread = std::thread(std::move(fn)); }
+        void join() { if (m_thread.joinable()) m_thread.join(); }
+
+    private:
+        std::thread m_thread;
+    };
+    bool                        m_precalculated_cache_enabled { false };
+    mutable PrecalculatedWriter m_precalculated_writer;
+
 #ifdef SLIC3R_TREESUPPORTS_PROGRESS
     std::unique_ptr<std::mutex> m_critical_progress { std::make_unique<std::mutex>() };
 #endif // SLIC3R_TREESUPPORTS_PROGRESS
@@ -8,6 +8,7 @@
 #include "MeshBoolean.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <deque>
 #include <queue>
@@ -472,59 +473,100 @@ static FacetSliceType slice_facet_for_cut_mesh(
     return FacetSliceType::NoSlice;
 }
 
-template<typename TransformVertex>
-void slice_facet_at_zs(
-    // Scaled or unscaled vertices. transform_vertex_fn may scale zs.
-    const std::vector<Vec3f>                         &mesh_vertices,
-    const TransformVertex                            &transform_vertex_fn,
-    const stl_triangle_vertex_indices                &indices,
-    const Vec3i32                                      &edge_ids,
-    // Scaled or unscaled zs. If vertices have their zs scaled or transform_vertex_fn scales them, then zs have to be scaled as well.
-    const std::vector<float>                         &zs,
-    std::vector<IntersectionLines>                   &lines,
-    std::array<std::mutex, 64>                       &lines_mutex)
+// Range of zs sliced by a facet: [first, last). Horizontal facets are not sliced at all.
+static inline std::pair<uint32_t, uint32_t> facet_slice_range(
+    // Vertices already transformed for slicing.
+    const stl_vertex                                 *vertices,
+    // Scaled or unscaled zs, matching the vertices.
+    const std::vector<float>                         &zs)
 {
-    stl_vertex vertices[3] { transform_vertex_fn(mesh_vertices[indices(0)]), transform_vertex_fn(mesh_vertices[indices(1)]), transform_vertex_fn(mesh_vertices[indices(2)]) };
-
-    // find facet extents
     const float min_z = fminf(vertices[0].z(), fminf(vertices[1].z(), vertices[2].z()));
     const float max_z = fmaxf(vertices[0].z(), fmaxf(vertices[1].z(), vertices[2].z()));
-
-    // find layer extents
+    // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
+    if (min_z == max_z)
+        return { 0, 0 };
     auto min_layer = std::lower_bound(zs.begin(), zs.end(), min_z); // first layer whose slice_z is >= min_z
     auto max_layer = std::upper_bound(min_layer, zs.end(), max_z); // first layer whose slice_z is > max_z
-    int  idx_vertex_lowest = (vertices[1].z() == min_z) ? 1 : ((vertices[2].z() == min_z) ? 2 : 0);
-
-    for (auto it = min_layer; it != max_layer; ++ it) {
-        IntersectionLine il;
-        // Ignore horizontal triangles. Any valid horizontal triangle must have a vertical triangle connected, otherwise the part has zero volume.
-        if (min_z != max_z && slice_facet(*it, vertices, indices, edge_ids, idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
-            assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
-            size_t slice_id = it - zs.begin();
-            boost::lock_guard<std::mutex> l(lines_mutex[slice_id % lines_mutex.size()]);
-            lines[slice_id].emplace_back(il);
-        }
-    }
+    return { uint32_t(min_layer - zs.begin()), uint32_t(max_layer - zs.begin()) };
 }
 
-template<typename TransformVertex, typename ThrowOnCancel>
-static inline std::vector<IntersectionLines> slice_make_lines(
+// Slices all facets at all zs.
+// Instead of each facet pushing its intersection lines into the layers under a lock, an index of facets spanning each layer is built first
+// (a compressed sparse row of facet indices per layer), then the layers are sliced in parallel, each layer visiting only the facets spanning it.
+// The lines of a layer are produced in the order of the facets, thus the result does not depend on thread scheduling.
+static std::vector<IntersectionLines> slice_make_lines(
+    // Vertices already transformed for slicing, see transform_mesh_vertices_for_slicing(). They are transformed once here,
+    // not once per each layer a facet spans.
     const std::vector<stl_vertex>                   &vertices,
-    const TransformVertex                           &transform_vertex_fn,
     const std::vector<stl_triangle_vertex_indices>  &indices,
     const std::vector<Vec3i32>                        &face_edge_ids,
     const std::vector<float>                        &zs,
-    const ThrowOnCancel                              throw_on_cancel_fn)
+    const std::function<void()>                     &throw_on_cancel_fn)
 {
-    std::vector<IntersectionLines>  lines(zs.size(), IntersectionLines());
-    std::array<std::mutex, 64>      lines_mutex;
+    // 1) Range of layers sliced by each facet, number of facets slicing each layer.
+    // The index grows with the number of facets times the number of layers they span, thus it is addressed by size_t.
+    std::vector<std::pair<uint32_t, uint32_t>> facet_ranges(indices.size());
+    std::vector<std::atomic<size_t>>           layer_facets_cnt(zs.size());
+    for (std::atomic<size_t> &cnt : layer_facets_cnt)
+        cnt.store(0, std::memory_order_relaxed);
     tbb::parallel_for(
         tbb::blocked_range<int>(0, int(indices.size())),
-        [&vertices, &transform_vertex_fn, &indices, &face_edge_ids, &zs, &lines, &lines_mutex, throw_on_cancel_fn](const tbb::blocked_range<int> &range) {
+        [&vertices, &indices, &zs, &facet_ranges, &layer_facets_cnt, &throw_on_cancel_fn](const tbb::blocked_range<int> &range) {
             for (int face_idx = range.begin(); face_idx < range.end(); ++ face_idx) {
                 if ((face_idx & 0x0ffff) == 0)
                     throw_on_cancel_fn();
-                slice_facet_at_zs(vertices, transform_vertex_fn, indices[face_idx], face_edge_ids[face_idx], zs, lines, lines_mutex);
+                const stl_triangle_vertex_indices &facet = indices[face_idx];
+                stl_vertex facet_vertices[3] { vertices[facet(0)], vertices[facet(1)], vertices[facet(2)] };
+                std::pair<uint32_t, uint32_t> layers = facet_slice_range(facet_vertices, zs);
+                facet_ranges[face_idx] = layers;
+                for (uint32_t layer_idx = layers.first; layer_idx < layers.second; ++ layer_idx)
+                    layer_facets_cnt[layer_idx].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    );
+
+    // 2) Index of facets per layer.
+    std::vector<size_t> layer_facets_begin(zs.size() + 1, 0);
+    for (size_t layer_idx = 0; layer_idx < zs.size(); ++ layer_idx)
+        layer_facets_begin[layer_idx + 1] = layer_facets_begin[layer_idx] + layer_facets_cnt[layer_idx].load(std::memory_order_relaxed);
+    // Reuse the counters as insertion cursors.
+    for (size_t layer_idx = 0; layer_idx < zs.size(); ++ layer_idx)
+        layer_facets_cnt[layer_idx].store(layer_facets_begin[layer_idx], std::memory_order_relaxed);
+    // Facet indices themselves fit into 32 bits, see the int indexing of the facets above.
+    std::vector<uint32_t> layer_facets(layer_facets_begin.back());
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, int(indices.size())),
+        [&facet_ranges, &layer_facets_cnt, &layer_facets](const tbb::blocked_range<int> &range) {
+            for (int face_idx = range.begin(); face_idx < range.end(); ++ face_idx)
+                for (uint32_t layer_idx = facet_ranges[face_idx].first; layer_idx < facet_ranges[face_idx].second; ++ layer_idx)
+                    layer_facets[layer_facets_cnt[layer_idx].fetch_add(1, std::memory_order_relaxed)] = uint32_t(face_idx);
+        }
+    );
+    throw_on_cancel_fn();
+
+    // 3) Slice the layers in parallel.
+    std::vector<IntersectionLines> lines(zs.size(), IntersectionLines());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, zs.size()),
+        [&vertices, &indices, &face_edge_ids, &zs, &layer_facets_begin, &layer_facets, &lines, &throw_on_cancel_fn](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                throw_on_cancel_fn();
+                auto it_begin = layer_facets.begin() + layer_facets_begin[layer_idx];
+                auto it_end   = layer_facets.begin() + layer_facets_begin[layer_idx + 1];
+                std::sort(it_begin, it_end);
+                IntersectionLines &layer_lines = lines[layer_idx];
+                layer_lines.reserve(it_end - it_begin);
+                for (auto it = it_begin; it != it_end; ++ it) {
+                    const stl_triangle_vertex_indices &facet = indices[*it];
+                    stl_vertex facet_vertices[3] { vertices[facet(0)], vertices[facet(1)], vertices[facet(2)] };
+                    const float min_z = fminf(facet_vertices[0].z(), fminf(facet_vertices[1].z(), facet_vertices[2].z()));
+                    int idx_vertex_lowest = (facet_vertices[1].z() == min_z) ? 1 : ((facet_vertices[2].z() == min_z) ? 2 : 0);
+                    IntersectionLine il;
+                    if (slice_facet(zs[layer_idx], facet_vertices, facet, face_edge_ids[*it], idx_vertex_lowest, false, il) == FacetSliceType::Slicing) {
+                        assert(il.edge_type != IntersectionLine::FacetEdgeType::Horizontal);
+                        layer_lines.emplace_back(il);
+                    }
+                }
             }
         }
     );
@@ -1878,23 +1920,9 @@ std::vector<Polygons> slice_mesh(
         // However facets_edges assigns a single edge ID to two triangles only, thus when factoring facets_edges out, one will have
         // to make sure that no code relies on it.
         std::vector<Vec3i32> face_edge_ids = its_face_edge_ids(mesh);
-        if (zs.size() <= 1) {
-            // It likely is not worthwile to copy the vertices. Apply the transformation in place.
-            if (is_identity(params.trafo)) {
-                lines = slice_make_lines(
-                    mesh.vertices, [](const Vec3f &p) { return Vec3f(scaled<float>(p.x()), scaled<float>(p.y()), p.z()); }, 
-                    mesh.indices, face_edge_ids, zs, throw_on_cancel);
-            } else {
-                // Transform the vertices, scale up in XY, not in Z.
-                Transform3f tf = make_trafo_for_slicing(params.trafo);
-                lines = slice_make_lines(mesh.vertices, [tf](const Vec3f &p) { return tf * p; }, mesh.indices, face_edge_ids, zs, throw_on_cancel);
-            }
-        } else {
-            // Copy and scale vertices in XY, don't scale in Z. Possibly apply the transformation.
-            lines = slice_make_lines(
-                transform_mesh_vertices_for_slicing(mesh, params.trafo), 
-                [](const Vec3f &p) { return p; },  mesh.indices, face_edge_ids, zs, throw_on_cancel);
-        }
+        // Copy and scale vertices in XY, don't scale in Z. Possibly apply the transformation.
+        // Transforming the vertices once is cheaper than transforming the three vertices of each facet, even for a single layer.
+        lines = slice_make_lines(transform_mesh_vertices_for_slicing(mesh, params.trafo), mesh.indices, face_edge_ids, zs, throw_on_cancel);
     }
 
     throw_on_cancel();
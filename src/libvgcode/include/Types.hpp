@@ -207,6 +207,22 @@ enum class EColorRangeType : uint8_t
 
 static constexpr std::size_t COLOR_RANGE_TYPES_COUNT = static_cast<std::size_t>(EColorRangeType::COUNT);
 
+//
+// Encodings of the vertices stored in cpu memory
+// Float:     the vertices are stored as given
+// Quantized: the attributes of the vertices are stored as 16 bit integers relative to the ranges of blocks
+//            of consecutive vertices, positions on a power of two grid with steps of at most 1/1024 mm,
+//            or of at most 1/32768 of the span of the block for blocks spanning more than 64 mm
+//
+enum class EVerticesEncoding : uint8_t
+{
+    Float,
+    Quantized,
+    COUNT
+};
+
+static constexpr std::size_t VERTICES_ENCODINGS_COUNT = static_cast<std::size_t>(EVerticesEncoding::COUNT);
+
 //
 // Predefined colors
 //
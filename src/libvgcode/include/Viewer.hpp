@@ -8,6 +8,7 @@
 #include "Types.hpp"
 
 #include <string>
+#include <vector>
 
 namespace libvgcode {
 
@@ -56,6 +57,29 @@ public:
     //
     void load(GCodeInputData&& gcode_data);
     //
+    // Append the given vertices to the content set up by load().
+    // Allows to load large toolpaths progressively (f.e. in chunks of layers)
+    // and to render the toolpaths loaded so far in the meantime.
+    // The vertices must continue the sequence of the already loaded ones.
+    // See: PathVertex
+    //
+    void append(std::vector<PathVertex>&& vertices);
+    //
+    // Reserve memory for the given total count of vertices, to be called after load()
+    // when the count of the vertices which will be appended is known in advance.
+    //
+    void reserve(size_t vertices_count);
+    //
+    // Return the encoding used to store the vertices in cpu memory
+    //
+    EVerticesEncoding get_vertices_encoding() const;
+    //
+    // Set the encoding used to store the vertices in cpu memory, to be called before load().
+    // Changing the encoding resets the loaded toolpaths.
+    // See: EVerticesEncoding
+    //
+    void set_vertices_encoding(EVerticesEncoding encoding);
+    //
     // Render the toolpaths according to the current settings and
     // using the given camera matrices.
     //
@@ -309,7 +333,7 @@ public:
     //
     // Return the vertex pointed by the max value of the view visible range
     //
-    const PathVertex& get_current_vertex() const;
+    PathVertex get_current_vertex() const;
     //
     // Return the index of vertex pointed by the max value of the view visible range
     //
@@ -317,7 +341,7 @@ public:
     //
     // Return the vertex at the given index
     //
-    const PathVertex& get_vertex_at(size_t id) const;
+    PathVertex get_vertex_at(size_t id) const;
     //
     // Return the total estimated time, in seconds, using the current time mode.
     //
@@ -5,6 +5,7 @@
 #ifndef VGCODE_BITSET_HPP
 #define VGCODE_BITSET_HPP
 
+#include <algorithm>
 #include <atomic>
 #include <vector>
 
@@ -34,6 +35,18 @@ struct BitSet
         }
     }
 
+    // Grow the bitset to the given size, the added bits are set
+    void grow(std::size_t new_size) {
+        if (new_size <= size)
+            return;
+        const std::size_t old_bits_count = blocks.size() * sizeof(T) * 8;
+        for (std::size_t i = size; i < std::min(new_size, old_bits_count); ++i) {
+            set(i);
+        }
+        blocks.resize(1 + (new_size / (sizeof(T) * 8)), ~T(0));
+        size = new_size;
+    }
+
     //return true if bit changed
     bool set(std::size_t index) {
         const auto [block_idx, bit_idx] = get_coords(index);
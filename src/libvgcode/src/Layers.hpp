@@ -31,6 +31,13 @@ public:
         return (layer_id < m_items.size()) ? m_items[layer_id].z : 0.0f;
     }
     std::size_t get_layer_id_at(float z) const;
+    //
+    // Return the range of the ids of the vertices of the layer with the given id
+    //
+    const Interval& get_layer_vertices_range(std::size_t layer_id) const {
+        static const Interval EMPTY_RANGE{ 0, 0 };
+        return (layer_id < m_items.size()) ? m_items[layer_id].range.get() : EMPTY_RANGE;
+    }
     
     const Interval& get_view_range() const { return m_view_range.get(); }
     void set_view_range(const Interval& range) { set_view_range(range[0], range[1]); }
@@ -0,0 +1,281 @@
+///|/ Copyright (c) Prusa Research 2023 Enrico Turri @enricoturri1966, Pavel Mikuš @Godrak
+///|/
+///|/ libvgcode is released under the terms of the AGPLv3 or higher
+///|/
+#include "PathVertices.hpp"
+
+#include "Utils.hpp"
+
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+
+namespace libvgcode {
+
+//
+// Float attributes of PathVertex quantized to 16 bits, followed by the estimated times
+//
+static float PathVertex::* const QUANTIZED_ATTRIBUTES[] = {
+    &PathVertex::height,
+    &PathVertex::width,
+    &PathVertex::feedrate,
+    &PathVertex::actual_feedrate,
+    &PathVertex::mm3_per_mm,
+    &PathVertex::fan_speed,
+    &PathVertex::temperature,
+#if VGCODE_ENABLE_COG_AND_TOOL_MARKERS
+    &PathVertex::weight,
+#endif // VGCODE_ENABLE_COG_AND_TOOL_MARKERS
+    &PathVertex::pressure_advance,
+    &PathVertex::acceleration,
+    &PathVertex::jerk
+};
+
+static constexpr size_t QUANTIZED_ATTRIBUTES_COUNT = sizeof(QUANTIZED_ATTRIBUTES) / sizeof(QUANTIZED_ATTRIBUTES[0]);
+
+static float& attribute(PathVertex& v, size_t id)
+{
+    return (id < QUANTIZED_ATTRIBUTES_COUNT) ? v.*QUANTIZED_ATTRIBUTES[id] : v.times[id - QUANTIZED_ATTRIBUTES_COUNT];
+}
+
+static float attribute(const PathVertex& v, size_t id)
+{
+    return (id < QUANTIZED_ATTRIBUTES_COUNT) ? v.*QUANTIZED_ATTRIBUTES[id] : v.times[id - QUANTIZED_ATTRIBUTES_COUNT];
+}
+
+//
+// Range of the exponents of the grids used for the positions,
+// from steps of 1/1024 mm to steps of 256 mm
+//
+static constexpr int MAX_POSITION_EXPONENT = 10;
+static constexpr int MIN_POSITION_EXPONENT = -8;
+
+static constexpr float QUANTIZED_MAX = 65535.0f;
+
+//
+// Maximum error of a quantized attribute, relative to its value, above which the attribute
+// of the block is stored as given
+//
+static constexpr float ATTRIBUTE_RELATIVE_TOLERANCE = 1e-3f;
+static constexpr float ATTRIBUTE_ABSOLUTE_TOLERANCE = 1e-6f;
+
+static constexpr std::array<double, MAX_POSITION_EXPONENT - MIN_POSITION_EXPONENT + 1> make_position_steps()
+{
+    std::array<double, MAX_POSITION_EXPONENT - MIN_POSITION_EXPONENT + 1> ret{};
+    double step = 1.0;
+    for (int i = 0; i < MAX_POSITION_EXPONENT; ++i) {
+        step *= 0.5;
+    }
+    for (double& s : ret) {
+        s = step;
+        step *= 2.0;
+    }
+    return ret;
+}
+
+//
+// Steps of the grids, 2^-exponent, from MAX_POSITION_EXPONENT down to MIN_POSITION_EXPONENT
+//
+static constexpr std::array<double, MAX_POSITION_EXPONENT - MIN_POSITION_EXPONENT + 1> POSITION_STEPS = make_position_steps();
+
+void PathVertices::set_encoding(EVerticesEncoding encoding)
+{
+    clear();
+    m_encoding = encoding;
+}
+
+void PathVertices::clear()
+{
+    m_vertices.clear();
+    m_vertices.shrink_to_fit();
+    m_quantized.clear();
+    m_quantized.shrink_to_fit();
+    m_blocks.clear();
+    m_blocks.shrink_to_fit();
+    m_exact_attributes.clear();
+    m_exact_attributes.shrink_to_fit();
+    m_layers_durations.clear();
+    m_layers_durations.shrink_to_fit();
+}
+
+void PathVertices::reserve(size_t count)
+{
+    if (m_encoding == EVerticesEncoding::Quantized) {
+        m_quantized.reserve(count - count % BLOCK_SIZE);
+        m_blocks.reserve(count / BLOCK_SIZE);
+    }
+    else
+        m_vertices.reserve(count);
+}
+
+size_t PathVertices::append(std::vector<PathVertex>&& vertices)
+{
+    const size_t old_size = size();
+    if (m_vertices.empty())
+        m_vertices = std::move(vertices);
+    else
+        m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+
+    if (m_encoding != EVerticesEncoding::Quantized || m_vertices.size() < BLOCK_SIZE)
+        return old_size;
+
+    // the trailing vertices stored as given up to now are going to be quantized
+    const size_t first_changed_id = m_quantized.size();
+    const size_t blocks_count = m_vertices.size() / BLOCK_SIZE;
+    for (size_t i = 0; i < blocks_count; ++i) {
+        quantize_block(m_vertices.data() + i * BLOCK_SIZE);
+    }
+    m_vertices.erase(m_vertices.begin(), m_vertices.begin() + blocks_count * BLOCK_SIZE);
+    m_vertices.shrink_to_fit();
+    return first_changed_id;
+}
+
+PathVertex PathVertices::operator [] (size_t id) const
+{
+    if (id < m_quantized.size())
+        return decode(id);
+
+    PathVertex ret = m_vertices[id - m_quantized.size()];
+    if (m_encoding == EVerticesEncoding::Quantized)
+        ret.layer_duration = get_layer_duration(ret.layer_id);
+    return ret;
+}
+
+void PathVertices::set_layers_durations(const std::vector<float>& durations, size_t first_id)
+{
+    if (m_encoding == EVerticesEncoding::Quantized) {
+        m_layers_durations = durations;
+        return;
+    }
+
+    for (size_t i = first_id; i < m_vertices.size(); ++i) {
+        PathVertex& v = m_vertices[i];
+        v.layer_duration = (v.layer_id < durations.size()) ? durations[v.layer_id] : 0.0f;
+    }
+}
+
+size_t PathVertices::size_in_bytes_cpu() const
+{
+    size_t ret = STDVEC_MEMSIZE(m_vertices, PathVertex);
+    ret += STDVEC_MEMSIZE(m_quantized, QuantizedVertex);
+    ret += STDVEC_MEMSIZE(m_blocks, Block);
+    ret += STDVEC_MEMSIZE(m_exact_attributes, float);
+    ret += STDVEC_MEMSIZE(m_layers_durations, float);
+    return ret;
+}
+
+void PathVertices::quantize_block(const PathVertex* vertices)
+{
+    static_assert(QUANTIZED_ATTRIBUTES_COUNT + TIME_MODES_COUNT == ATTRIBUTES_COUNT, "Mismatch between quantized attributes and their count");
+    static_assert(ATTRIBUTES_COUNT <= 32, "Block::exact_attributes_mask too small");
+
+    Block& block = m_blocks.emplace_back();
+    const size_t first_quantized_id = m_quantized.size();
+    m_quantized.resize(first_quantized_id + BLOCK_SIZE);
+    QuantizedVertex* quantized = m_quantized.data() + first_quantized_id;
+
+    for (size_t c = 0; c < 3; ++c) {
+        float min = vertices[0].position[c];
+        float max = min;
+        for (size_t i = 1; i < BLOCK_SIZE; ++i) {
+            min = std::min(min, vertices[i].position[c]);
+            max = std::max(max, vertices[i].position[c]);
+        }
+        // use the finest grid on which the block fits 16 bits
+        int exponent = MAX_POSITION_EXPONENT;
+        int64_t base = 0;
+        for (; exponent >= MIN_POSITION_EXPONENT; --exponent) {
+            base = static_cast<int64_t>(std::floor(std::ldexp(static_cast<double>(min), exponent)));
+            if (std::llround(std::ldexp(static_cast<double>(max), exponent)) - base <= static_cast<int64_t>(QUANTIZED_MAX))
+                break;
+        }
+        assert(exponent >= MIN_POSITION_EXPONENT);
+        block.position_base[c] = static_cast<int32_t>(base);
+        block.position_exponent[c] = static_cast<int8_t>(exponent);
+        for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+            const int64_t q = std::llround(std::ldexp(static_cast<double>(vertices[i].position[c]), exponent)) - base;
+            quantized[i].position[c] = static_cast<uint16_t>(std::clamp<int64_t>(q, 0, static_cast<int64_t>(QUANTIZED_MAX)));
+        }
+    }
+
+    for (size_t a = 0; a < ATTRIBUTES_COUNT; ++a) {
+        float min = attribute(vertices[0], a);
+        float max = min;
+        for (size_t i = 1; i < BLOCK_SIZE; ++i) {
+            min = std::min(min, attribute(vertices[i], a));
+            max = std::max(max, attribute(vertices[i], a));
+        }
+        float scale = (max - min) / QUANTIZED_MAX;
+        // constant attribute
+        if (!std::isfinite(scale) || scale <= 0.0f)
+            scale = 0.0f;
+        block.attributes_min[a] = min;
+        block.attributes_scale[a] = scale;
+        bool exact = false;
+        for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+            const float value = attribute(vertices[i], a);
+            const float q = (scale > 0.0f) ? std::round((value - min) / scale) : 0.0f;
+            quantized[i].attributes[a] = static_cast<uint16_t>(std::clamp(q, 0.0f, QUANTIZED_MAX));
+            const float decoded = min + static_cast<float>(quantized[i].attributes[a]) * scale;
+            exact |= std::abs(decoded - value) > ATTRIBUTE_RELATIVE_TOLERANCE * std::abs(value) + ATTRIBUTE_ABSOLUTE_TOLERANCE;
+        }
+        if (exact) {
+            // the range is too wide for the small values of the block, store the attribute as given
+            if (block.exact_attributes_mask == 0)
+                block.exact_attributes_offset = static_cast<uint32_t>(m_exact_attributes.size());
+            block.exact_attributes_mask |= uint32_t(1) << a;
+            for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+                m_exact_attributes.emplace_back(attribute(vertices[i], a));
+                quantized[i].attributes[a] = 0;
+            }
+        }
+    }
+
+    block.first_layer_id = vertices[0].layer_id;
+    for (size_t i = 1; i < BLOCK_SIZE; ++i) {
+        block.first_layer_id = std::min(block.first_layer_id, vertices[i].layer_id);
+    }
+    for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+        const PathVertex& v = vertices[i];
+        QuantizedVertex& q = quantized[i];
+        assert(v.layer_id - block.first_layer_id <= 0xFFFF);
+        q.gcode_id = v.gcode_id;
+        q.layer_id = static_cast<uint16_t>(v.layer_id - block.first_layer_id);
+        q.role = v.role;
+        q.type = v.type;
+        q.extruder_id = v.extruder_id;
+        q.color_id = v.color_id;
+    }
+}
+
+PathVertex PathVertices::decode(size_t id) const
+{
+    const Block& block = m_blocks[id / BLOCK_SIZE];
+    const QuantizedVertex& q = m_quantized[id];
+
+    PathVertex ret;
+    for (size_t c = 0; c < 3; ++c) {
+        // the product by a power of two is exact, as for std::ldexp()
+        ret.position[c] = static_cast<float>(static_cast<double>(static_cast<int64_t>(block.position_base[c]) + q.position[c]) *
+            POSITION_STEPS[MAX_POSITION_EXPONENT - block.position_exponent[c]]);
+    }
+    size_t exact_id = block.exact_attributes_offset + id % BLOCK_SIZE;
+    for (size_t a = 0; a < ATTRIBUTES_COUNT; ++a) {
+        if ((block.exact_attributes_mask & (uint32_t(1) << a)) != 0) {
+            attribute(ret, a) = m_exact_attributes[exact_id];
+            exact_id += BLOCK_SIZE;
+        }
+        else
+            attribute(ret, a) = block.attributes_min[a] + static_cast<float>(q.attributes[a]) * block.attributes_scale[a];
+    }
+    ret.gcode_id = q.gcode_id;
+    ret.layer_id = block.first_layer_id + q.layer_id;
+    ret.role = q.role;
+    ret.type = q.type;
+    ret.extruder_id = q.extruder_id;
+    ret.color_id = q.color_id;
+    ret.layer_duration = get_layer_duration(ret.layer_id);
+    return ret;
+}
+
+} // namespace libvgcode
@@ -0,0 +1,180 @@
+///|/ Copyright (c) Prusa Research 2023 Enrico Turri @enricoturri1966, Pavel Mikuš @Godrak
+///|/
+///|/ libvgcode is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef VGCODE_PATHVERTICES_HPP
+#define VGCODE_PATHVERTICES_HPP
+
+#include "../include/PathVertex.hpp"
+
+#include <iterator>
+#include <vector>
+
+namespace libvgcode {
+
+//
+// Cpu storage of the toolpaths vertices.
+// With EVerticesEncoding::Float the vertices are stored as given.
+// With EVerticesEncoding::Quantized the vertices are grouped in blocks of BLOCK_SIZE consecutive vertices
+// and the float attributes of each vertex are stored as 16 bit integers relative to the range of the block.
+// An attribute whose range in the block is too wide to be stored in 16 bits within a relative tolerance
+// (i.e. a few seconds long moves next to a long dwell) is stored as given for that block.
+// Positions are stored on a power of two grid, so that the same position is decoded to the same value
+// in all the blocks using the same grid and the toolpaths stay connected.
+// The trailing vertices not filling a whole block are kept as given until more vertices are appended.
+// The layer durations are stored per layer.
+// Vertices are returned decoded, by value.
+//
+class PathVertices
+{
+public:
+    static constexpr size_t BLOCK_SIZE = 256;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = PathVertex;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = PathVertex;
+
+        struct pointer
+        {
+            PathVertex vertex;
+            const PathVertex* operator -> () const { return &vertex; }
+        };
+
+        const_iterator() = default;
+        const_iterator(const PathVertices& vertices, size_t id) : m_vertices(&vertices), m_id(id) {}
+
+        reference operator * () const { return (*m_vertices)[m_id]; }
+        pointer operator -> () const { return { (*m_vertices)[m_id] }; }
+        reference operator [] (difference_type n) const { return (*m_vertices)[m_id + n]; }
+
+        const_iterator& operator ++ () { ++m_id; return *this; }
+        const_iterator& operator -- () { --m_id; return *this; }
+        const_iterator operator ++ (int) { const_iterator ret = *this; ++m_id; return ret; }
+        const_iterator operator -- (int) { const_iterator ret = *this; --m_id; return ret; }
+        const_iterator& operator += (difference_type n) { m_id += n; return *this; }
+        const_iterator& operator -= (difference_type n) { m_id -= n; return *this; }
+        const_iterator operator + (difference_type n) const { return const_iterator(*m_vertices, m_id + n); }
+        const_iterator operator - (difference_type n) const { return const_iterator(*m_vertices, m_id - n); }
+        difference_type operator - (const const_iterator& other) const {
+            return static_cast<difference_type>(m_id) - static_cast<difference_type>(other.m_id);
+        }
+
+        bool operator == (const const_iterator& other) const { return m_id == other.m_id; }
+        bool operator != (const const_iterator& other) const { return m_id != other.m_id; }
+        bool operator < (const const_iterator& other) const { return m_id < other.m_id; }
+        bool operator > (const const_iterator& other) const { return m_id > other.m_id; }
+        bool operator <= (const const_iterator& other) const { return m_id <= other.m_id; }
+        bool operator >= (const const_iterator& other) const { return m_id >= other.m_id; }
+
+    private:
+        const PathVertices* m_vertices{ nullptr };
+        size_t m_id{ 0 };
+    };
+
+    EVerticesEncoding get_encoding() const { return m_encoding; }
+    //
+    // Set the encoding used to store the vertices.
+    // The stored vertices are cleared.
+    //
+    void set_encoding(EVerticesEncoding encoding);
+
+    void clear();
+    void reserve(size_t count);
+
+    bool empty() const { return size() == 0; }
+    size_t size() const { return m_quantized.size() + m_vertices.size(); }
+
+    //
+    // Append the given vertices.
+    // Returns the id of the first vertex whose stored value changed, which may precede the appended vertices
+    // when they complete a block started by the vertices already stored.
+    //
+    size_t append(std::vector<PathVertex>&& vertices);
+
+    PathVertex operator [] (size_t id) const;
+
+    const_iterator begin() const { return const_iterator(*this, 0); }
+    const_iterator end() const { return const_iterator(*this, size()); }
+    std::reverse_iterator<const_iterator> rbegin() const { return std::make_reverse_iterator(end()); }
+    std::reverse_iterator<const_iterator> rend() const { return std::make_reverse_iterator(begin()); }
+
+    //
+    // Set the layer_duration of the vertices, starting from the vertex with the given id,
+    // from the given durations of the layers
+    //
+    void set_layers_durations(const std::vector<float>& durations, size_t first_id = 0);
+
+    size_t size_in_bytes_cpu() const;
+
+private:
+    //
+    // Number of float attributes of PathVertex, other than position and layer_duration,
+    // stored as 16 bit integers
+    //
+#if VGCODE_ENABLE_COG_AND_TOOL_MARKERS
+    static constexpr size_t ATTRIBUTES_COUNT = 11 + TIME_MODES_COUNT;
+#else
+    static constexpr size_t ATTRIBUTES_COUNT = 10 + TIME_MODES_COUNT;
+#endif // VGCODE_ENABLE_COG_AND_TOOL_MARKERS
+
+    struct QuantizedVertex
+    {
+        uint32_t gcode_id;
+        std::array<uint16_t, 3> position;
+        std::array<uint16_t, ATTRIBUTES_COUNT> attributes;
+        //
+        // Relative to the first layer of the block
+        //
+        uint16_t layer_id;
+        EGCodeExtrusionRole role;
+        EMoveType type;
+        uint8_t extruder_id;
+        uint8_t color_id;
+    };
+
+    struct Block
+    {
+        //
+        // Position = (position_base + quantized position) * 2^-position_exponent
+        //
+        std::array<int32_t, 3> position_base;
+        std::array<int8_t, 3> position_exponent;
+        uint32_t first_layer_id;
+        //
+        // Attribute = attributes_min + quantized attribute * attributes_scale
+        //
+        std::array<float, ATTRIBUTES_COUNT> attributes_min;
+        std::array<float, ATTRIBUTES_COUNT> attributes_scale;
+        //
+        // Bit mask of the attributes stored as given, in m_exact_attributes from exact_attributes_offset,
+        // BLOCK_SIZE values per attribute, in the order of the attributes
+        //
+        uint32_t exact_attributes_mask;
+        uint32_t exact_attributes_offset;
+    };
+
+    EVerticesEncoding m_encoding{ EVerticesEncoding::Float };
+    //
+    // With EVerticesEncoding::Float all the vertices,
+    // with EVerticesEncoding::Quantized the trailing vertices not filling a whole block
+    //
+    std::vector<PathVertex> m_vertices;
+    std::vector<QuantizedVertex> m_quantized;
+    std::vector<Block> m_blocks;
+    std::vector<float> m_exact_attributes;
+    std::vector<float> m_layers_durations;
+
+    void quantize_block(const PathVertex* vertices);
+    PathVertex decode(size_t id) const;
+    float get_layer_duration(uint32_t layer_id) const {
+        return (layer_id < m_layers_durations.size()) ? m_layers_durations[layer_id] : 0.0f;
+    }
+};
+
+} // namespace libvgcode
+
+#endif // VGCODE_PATHVERTICES_HPP
@@ -37,6 +37,26 @@ void Viewer::load(GCodeInputData&& gcode_data)
     m_impl->load(std::move(gcode_data));
 }
 
+void Viewer::append(std::vector<PathVertex>&& vertices)
+{
+    m_impl->append(std::move(vertices));
+}
+
+void Viewer::reserve(size_t vertices_count)
+{
+    m_impl->reserve(vertices_count);
+}
+
+EVerticesEncoding Viewer::get_vertices_encoding() const
+{
+    return m_impl->get_vertices_encoding();
+}
+
+void Viewer::set_vertices_encoding(EVerticesEncoding encoding)
+{
+    m_impl->set_vertices_encoding(encoding);
+}
+
 void Viewer::render(const Mat4x4& view_matrix, const Mat4x4& projection_matrix)
 {
     m_impl->render(view_matrix, projection_matrix);
@@ -262,7 +282,7 @@ size_t Viewer::get_vertices_count() const
     return m_impl->get_vertices_count();
 }
 
-const PathVertex& Viewer::get_current_vertex() const
+PathVertex Viewer::get_current_vertex() const
 {
     return m_impl->get_current_vertex();
 }
@@ -272,7 +292,7 @@ size_t Viewer::get_current_vertex_id() const
     return m_impl->get_current_vertex_id();
 }
 
-const PathVertex& Viewer::get_vertex_at(size_t id) const
+PathVertex Viewer::get_vertex_at(size_t id) const
 {
     return m_impl->get_vertex_at(id);
 }
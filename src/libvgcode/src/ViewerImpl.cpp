@@ -333,6 +333,7 @@ void ViewerImpl::TextureData::init(size_t vertices_count)
     if (vertices_count == 0)
         return;
 
+    m_vertices_count = vertices_count;
     m_width = std::min(vertices_count, OpenGLWrapper::max_texture_size());
     size_t rows_count = vertices_count / m_width;
     if (vertices_count > rows_count * m_width)
@@ -364,42 +365,8 @@ void ViewerImpl::TextureData::set_positions(const std::vector<Vec3>& positions)
     if (positions.empty())
         return;
 
-    int curr_bound_texture = 0;
-    glsafe(glGetIntegerv(GL_TEXTURE_BINDING_2D, &curr_bound_texture));
-    int curr_unpack_alignment = 0;
-    glsafe(glGetIntegerv(GL_UNPACK_ALIGNMENT, &curr_unpack_alignment));
-
-    glsafe(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
-
-    const size_t tex_capacity = max_texture_capacity();
-    size_t remaining = positions.size();
-    for (size_t i = 0; i < m_count; ++i) {
-        const auto [w, h] = width_height(std::min(remaining, tex_capacity));
-        const size_t offset = i * tex_capacity;
-
-        glsafe(glGenTextures(1, &m_tex_ids[i].positions.first));
-        glsafe(glBindTexture(GL_TEXTURE_2D, m_tex_ids[i].positions.first));
-        glsafe(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
-        glsafe(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
-        glsafe(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
-        if (remaining >= tex_capacity) {
-            glsafe(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, static_cast<GLsizei>(w), static_cast<GLsizei>(h), 0, GL_RGB, GL_FLOAT, &positions[offset]));
-            m_tex_ids[i].positions.second = w * h;
-        }
-        else {
-            // the last row is only partially fitted with data, send it separately
-            glsafe(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, static_cast<GLsizei>(w), static_cast<GLsizei>(h), 0, GL_RGB, GL_FLOAT, nullptr));
-            glsafe(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, static_cast<GLsizei>(w), static_cast<GLsizei>(h - 1), GL_RGB, GL_FLOAT, &positions[offset]));
-            glsafe(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, static_cast<GLsizei>(h - 1), static_cast<GLsizei>(remaining % w), 1, GL_RGB, GL_FLOAT, &positions[offset + w * (h - 1)]));
-            m_tex_ids[i].positions.second = w * (h - 1) + remaining % w;
-        }
-        m_positions_size += m_tex_ids[i].positions.second * sizeof(Vec3);
-
-        remaining = (remaining > tex_capacity) ? remaining - tex_capacity: 0;
-    }
-
-    glsafe(glBindTexture(GL_TEXTURE_2D, curr_bound_texture));
-    glsafe(glPixelStorei(GL_UNPACK_ALIGNMENT, curr_unpack_alignment));
+    create_vertices_textures(&TexIds::positions, GL_RGB32F, GL_RGB);
+    update_positions(0, positions);
 }
 
 void ViewerImpl::TextureData::set_heights_widths_angles(const std::vector<Vec3>& heights_widths_angles)
@@ -417,38 +384,87 @@ void ViewerImpl::TextureData::set_heights_widths_angles(const std::vector<Vec3>&
     if (heights_widths_angles.empty())
         return;
 
+    create_vertices_textures(&TexIds::heights_widths_angles, GL_RGB32F, GL_RGB);
+    update_heights_widths_angles(0, heights_widths_angles);
+}
+
+void ViewerImpl::TextureData::update_positions(size_t first_vertex_id, const std::vector<Vec3>& positions)
+{
+    update_vertices_textures(&TexIds::positions, GL_RGB, first_vertex_id, positions);
+    m_positions_size = 0;
+    for (const TexIds& ids : m_tex_ids) {
+        m_positions_size += ids.positions.second * sizeof(Vec3);
+    }
+}
+
+void ViewerImpl::TextureData::update_heights_widths_angles(size_t first_vertex_id, const std::vector<Vec3>& heights_widths_angles)
+{
+    update_vertices_textures(&TexIds::heights_widths_angles, GL_RGB, first_vertex_id, heights_widths_angles);
+    m_height_width_angle_size = 0;
+    for (const TexIds& ids : m_tex_ids) {
+        m_height_width_angle_size += ids.heights_widths_angles.second * sizeof(Vec3);
+    }
+}
+
+// Create the textures storing one texel per vertex, sized for the count of vertices set by init(), without data
+void ViewerImpl::TextureData::create_vertices_textures(TexId tex_id, int internal_format, unsigned int format)
+{
     int curr_bound_texture = 0;
     glsafe(glGetIntegerv(GL_TEXTURE_BINDING_2D, &curr_bound_texture));
-    int curr_unpack_alignment = 0;
-    glsafe(glGetIntegerv(GL_UNPACK_ALIGNMENT, &curr_unpack_alignment));
-
-    glsafe(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
 
     const size_t tex_capacity = max_texture_capacity();
-    size_t remaining = heights_widths_angles.size();
     for (size_t i = 0; i < m_count; ++i) {
-        const auto [w, h] = width_height(std::min(remaining, tex_capacity));
-        const size_t offset = i * tex_capacity;
-
-        glsafe(glGenTextures(1, &m_tex_ids[i].heights_widths_angles.first));
-        glsafe(glBindTexture(GL_TEXTURE_2D, m_tex_ids[i].heights_widths_angles.first));
+        const auto [w, h] = width_height(std::min(m_vertices_count - i * tex_capacity, tex_capacity));
+        std::pair<unsigned int, size_t>& tex = m_tex_ids[i].*tex_id;
+        glsafe(glGenTextures(1, &tex.first));
+        glsafe(glBindTexture(GL_TEXTURE_2D, tex.first));
         glsafe(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
         glsafe(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
         glsafe(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
-        if (remaining >= tex_capacity) {
-            glsafe(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, static_cast<GLsizei>(w), static_cast<GLsizei>(h), 0, GL_RGB, GL_FLOAT, &heights_widths_angles[offset]));
-            m_tex_ids[i].heights_widths_angles.second = w * h;
-        }
-        else {
-            // the last row is only partially fitted with data, send it separately
-            glsafe(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, static_cast<GLsizei>(w), static_cast<GLsizei>(h), 0, GL_RGB, GL_FLOAT, nullptr));
-            glsafe(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, static_cast<GLsizei>(w), static_cast<GLsizei>(h - 1), GL_RGB, GL_FLOAT, &heights_widths_angles[offset]));
-            glsafe(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, static_cast<GLsizei>(h - 1), static_cast<GLsizei>(remaining % w), 1, GL_RGB, GL_FLOAT, &heights_widths_angles[offset + w * (h - 1)]));
-            m_tex_ids[i].heights_widths_angles.second = w * (h - 1) + remaining % w;
-        }
-        m_height_width_angle_size += m_tex_ids[i].heights_widths_angles.second * sizeof(Vec3);
+        glsafe(glTexImage2D(GL_TEXTURE_2D, 0, internal_format, static_cast<GLsizei>(w), static_cast<GLsizei>(h), 0, format, GL_FLOAT, nullptr));
+        tex.second = 0;
+    }
 
-        remaining = (remaining > tex_capacity) ? remaining - tex_capacity : 0;
+    glsafe(glBindTexture(GL_TEXTURE_2D, curr_bound_texture));
+}
+
+// Copy the data of the vertices starting at the given index into the textures created by create_vertices_textures().
+// The vertices are stored row by row, a range of vertices is sent as its partial first row, its full rows and its partial last row
+void ViewerImpl::TextureData::update_vertices_textures(TexId tex_id, unsigned int format, size_t first_vertex_id, const std::vector<Vec3>& data)
+{
+    if (m_count == 0 || data.empty())
+        return;
+
+    assert(first_vertex_id + data.size() <= m_vertices_count);
+
+    int curr_bound_texture = 0;
+    glsafe(glGetIntegerv(GL_TEXTURE_BINDING_2D, &curr_bound_texture));
+    int curr_unpack_alignment = 0;
+    glsafe(glGetIntegerv(GL_UNPACK_ALIGNMENT, &curr_unpack_alignment));
+
+    glsafe(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+
+    const size_t tex_capacity = max_texture_capacity();
+    size_t id = first_vertex_id;
+    const size_t end_id = std::min(first_vertex_id + data.size(), m_vertices_count);
+    while (id < end_id) {
+        const size_t tex_idx = id / tex_capacity;
+        const size_t tex_begin = tex_idx * tex_capacity;
+        const size_t tex_end = std::min(end_id, tex_begin + tex_capacity);
+        const size_t w = width_height(std::min(m_vertices_count - tex_begin, tex_capacity)).first;
+        std::pair<unsigned int, size_t>& tex = m_tex_ids[tex_idx].*tex_id;
+        glsafe(glBindTexture(GL_TEXTURE_2D, tex.first));
+        while (id < tex_end) {
+            const size_t x = (id - tex_begin) % w;
+            const size_t y = (id - tex_begin) / w;
+            // full rows if starting at a row begin, otherwise the remaining part of the row
+            const size_t rows = (x == 0) ? std::max<size_t>(1, (tex_end - id) / w) : 1;
+            const size_t count = (x == 0 && rows > 1) ? rows * w : std::min(tex_end - id, w - x);
+            glsafe(glTexSubImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(x), static_cast<GLint>(y), static_cast<GLsizei>((rows > 1) ? w : count),
+                static_cast<GLsizei>(rows), format, GL_FLOAT, &data[id - first_vertex_id]));
+            id += count;
+        }
+        tex.second = std::max(tex.second, tex_end - tex_begin);
     }
 
     glsafe(glBindTexture(GL_TEXTURE_2D, curr_bound_texture));
@@ -479,7 +495,8 @@ void ViewerImpl::TextureData::set_colors(const std::vector<float>& colors)
 
     const size_t tex_capacity = max_texture_capacity();
     size_t remaining = colors.size();
-    for (size_t i = 0; i < m_count; ++i) {
+    // the textures may be sized for more vertices than loaded so far
+    for (size_t i = 0; i < m_count && remaining > 0; ++i) {
         const auto [w, h] = width_height(std::min(remaining, tex_capacity));
         const size_t offset = i * tex_capacity;
 
@@ -655,6 +672,7 @@ void ViewerImpl::TextureData::reset()
     }
     m_tex_ids.clear();
 
+    m_vertices_count = 0;
     m_width = 0;
     m_height = 0;
     m_count = 0;
@@ -885,6 +903,11 @@ void ViewerImpl::reset()
 #else
     m_enabled_segments_count = 0;
     m_enabled_options_count = 0;
+    m_positions_tex_size = 0;
+    m_height_width_angle_tex_size = 0;
+    m_colors_tex_size = 0;
+    m_enabled_segments_tex_size = 0;
+    m_enabled_options_tex_size = 0;
 
     m_settings_used_for_ranges = std::nullopt;
 
@@ -908,30 +931,34 @@ void ViewerImpl::reset()
 // to position and heights_widths_angles vectors
 using Vec4 = std::array<float, 4>;
 
-static void extract_pos_and_or_hwa(const std::vector<PathVertex>& vertices, float travels_radius, float wipes_radius, BitSet<>& valid_lines_bitset,
+// Extract the data of the vertices starting at the given index
+static void extract_pos_and_or_hwa(const PathVertices& vertices, size_t first, float travels_radius, float wipes_radius, BitSet<>& valid_lines_bitset,
     std::vector<Vec4>* positions = nullptr, std::vector<Vec4>* heights_widths_angles = nullptr, bool update_bitset = false) {
   static constexpr const Vec3 ZERO = { 0.0f, 0.0f, 0.0f };
     if (positions == nullptr && heights_widths_angles == nullptr)
         return;
-    if (vertices.empty())
+    if (first >= vertices.size())
         return;
     if (travels_radius <= 0.0f || wipes_radius <= 0.0f)
         return;
 
     if (positions != nullptr)
-        positions->reserve(vertices.size());
+        positions->reserve(vertices.size() - first);
     if (heights_widths_angles != nullptr)
-        heights_widths_angles->reserve(vertices.size());
-    for (size_t i = 0; i < vertices.size(); ++i) {
-        const PathVertex& v = vertices[i];
+        heights_widths_angles->reserve(vertices.size() - first);
+    // the vertices may be stored encoded, decode each of them once
+    PathVertex prev_v = (first > 0) ? vertices[first - 1] : PathVertex();
+    PathVertex v = vertices[first];
+    for (size_t i = first; i < vertices.size(); ++i) {
+        const PathVertex next_v = (i + 1 < vertices.size()) ? vertices[i + 1] : PathVertex();
         const EMoveType move_type = v.type;
         const bool prev_line_valid = i > 0 && valid_lines_bitset[i - 1];
-        const Vec3 prev_line = prev_line_valid ? v.position - vertices[i - 1].position : ZERO;
+        const Vec3 prev_line = prev_line_valid ? v.position - prev_v.position : ZERO;
         const bool this_line_valid = i + 1 < vertices.size() &&
-                                     vertices[i + 1].position != v.position &&
-                                     vertices[i + 1].type == move_type &&
+                                     next_v.position != v.position &&
+                                     next_v.type == move_type &&
                                      move_type != EMoveType::Seam;
-        const Vec3 this_line = this_line_valid ? vertices[i + 1].position - v.position : ZERO;
+        const Vec3 this_line = this_line_valid ? next_v.position - v.position : ZERO;
 
         if (this_line_valid) {
             // there is a valid path between point i and i+1.
@@ -979,28 +1006,101 @@ static void extract_pos_and_or_hwa(const std::vector<PathVertex>& vertices, floa
             heights_widths_angles->push_back({ height, width,
                 std::atan2(prev_line[0] * this_line[1] - prev_line[1] * this_line[0], dot(prev_line, this_line)), bias });
         }
+
+        prev_v = v;
+        v = next_v;
     }
 }
 
-void ViewerImpl::load(GCodeInputData&& gcode_data)
+#ifdef ENABLE_OPENGL_ES
+// the textures store three components per vertex
+static std::vector<Vec3> to_vec3(const std::vector<Vec4>& data)
 {
-    if (!m_initialized)
-        return;
+    std::vector<Vec3> ret;
+    ret.reserve(data.size());
+    for (const Vec4& v : data) {
+        ret.push_back({ v[0], v[1], v[2] });
+    }
+    return ret;
+}
+#else
+// Replace the given gpu buffer by one of the given size (in bytes), keeping its content up to the given size (in bytes).
+// Returns the new size of the buffer, in bytes.
+static size_t resize_buffer(unsigned int& buf_id, size_t buf_size, size_t new_size, size_t keep_size, GLenum usage)
+{
+    unsigned int new_buf_id = 0;
+    glsafe(glGenBuffers(1, &new_buf_id));
+    glsafe(glBindBuffer(GL_COPY_WRITE_BUFFER, new_buf_id));
+    glsafe(glBufferData(GL_COPY_WRITE_BUFFER, new_size, nullptr, usage));
+    keep_size = std::min({ keep_size, buf_size, new_size });
+    if (buf_id != 0 && keep_size > 0) {
+        glsafe(glBindBuffer(GL_COPY_READ_BUFFER, buf_id));
+        glsafe(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keep_size));
+        glsafe(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+    }
+    glsafe(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+    delete_buffers(buf_id);
+    buf_id = new_buf_id;
+    return new_size;
+}
+
+// Copy the given data into the given gpu buffer, starting at the given offset (in bytes).
+// The buffer is expected to be sized for all the vertices by ViewerImpl::reserve(), otherwise it is replaced
+// by one of the required size, keeping its content up to the given offset.
+// Returns the new size of the buffer, in bytes.
+static size_t update_buffer(unsigned int& buf_id, size_t buf_size, size_t offset, const void* data, size_t data_size, GLenum usage)
+{
+    if (buf_id == 0)
+        buf_size = 0;
+
+    if (buf_size < offset + data_size)
+        buf_size = resize_buffer(buf_id, buf_size, offset + data_size, offset, usage);
+
+    glsafe(glBindBuffer(GL_COPY_WRITE_BUFFER, buf_id));
+    glsafe(glBufferSubData(GL_COPY_WRITE_BUFFER, offset, data_size, data));
+    glsafe(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+    return buf_size;
+}
+#endif // ENABLE_OPENGL_ES
 
+void ViewerImpl::load(GCodeInputData&& gcode_data)
+{
     if (gcode_data.vertices.empty())
         return;
 
     reset();
 
-    m_vertices = std::move(gcode_data.vertices);
     m_tool_colors = std::move(gcode_data.tools_colors);
     m_color_print_colors = std::move(gcode_data.color_print_colors);
-    m_vertices_colors.resize(m_vertices.size());
 
     m_settings.spiral_vase_mode = gcode_data.spiral_vase_mode;
 
-    for (size_t i = 0; i < m_vertices.size(); ++i) {
-        const PathVertex& v = m_vertices[i];
+    append(std::move(gcode_data.vertices));
+
+    update_enabled_entities();
+    update_colors();
+}
+
+void ViewerImpl::set_vertices_encoding(EVerticesEncoding encoding)
+{
+    if (encoding == m_vertices.get_encoding())
+        return;
+
+    reset();
+    m_vertices.set_encoding(encoding);
+}
+
+void ViewerImpl::append(std::vector<PathVertex>&& vertices)
+{
+    if (vertices.empty())
+        return;
+
+    const size_t old_vertices_count = m_vertices.size();
+
+    // statistics are collected from the given vertices, before they are encoded
+    for (size_t k = 0; k < vertices.size(); ++k) {
+        const size_t i = old_vertices_count + k;
+        const PathVertex& v = vertices[k];
 
         m_layers.update(v, static_cast<uint32_t>(i));
 
@@ -1037,16 +1137,24 @@ void ViewerImpl::load(GCodeInputData&& gcode_data)
                 v.role != EGCodeExtrusionRole::Custom &&
                 v.role != EGCodeExtrusionRole::Brim &&
                 v.role != EGCodeExtrusionRole::SupportTransition) {
-                m_cog_marker.update(0.5f * (v.position + m_vertices[i - 1].position), v.weight);
+                const Vec3& prev_position = (k > 0) ? vertices[k - 1].position : m_vertices[i - 1].position;
+                m_cog_marker.update(0.5f * (v.position + prev_position), v.weight);
             }
 #endif // VGCODE_ENABLE_COG_AND_TOOL_MARKERS
         }
     }
 
-    // Populate layer_duration for each vertex from the accumulated layer times
-    for (PathVertex& v : m_vertices) {
-        v.layer_duration = m_layers.get_layer_time(m_settings.time_mode, static_cast<size_t>(v.layer_id));
+    const uint32_t first_layer_id = vertices.front().layer_id;
+    const size_t first_changed_vertex_id = m_vertices.append(std::move(vertices));
+    m_vertices_colors.resize(m_vertices.size());
+
+    // Populate layer_duration for each vertex from the accumulated layer times.
+    // The last layer of the previously loaded vertices may continue into the new ones, so update it as well
+    size_t first_layer_vertex_id = old_vertices_count;
+    while (first_layer_vertex_id > 0 && m_vertices[first_layer_vertex_id - 1].layer_id == first_layer_id) {
+        --first_layer_vertex_id;
     }
+    m_vertices.set_layers_durations(m_layers.get_times(m_settings.time_mode), first_layer_vertex_id);
 
     if (!m_layers.empty())
         m_layers.set_view_range(0, static_cast<uint32_t>(m_layers.count()) - 1);
@@ -1055,76 +1163,140 @@ void ViewerImpl::load(GCodeInputData&& gcode_data)
     m_options.erase(std::unique(m_options.begin(), m_options.end()), m_options.end());
     m_options.shrink_to_fit();
 
-    // reset segments visibility bitset
-    m_valid_lines_bitset = BitSet<>(m_vertices.size());
-    m_valid_lines_bitset.setAll();
+    // reset or extend segments visibility bitset.
+    // When extending, the segment starting at the last previously loaded vertex was invalidated as it had no end vertex,
+    // so set it again and update its data together with the new vertices.
+    // The same for the previously loaded vertices whose stored values changed
+    const size_t first_vertex_id = std::min(first_changed_vertex_id, (old_vertices_count > 0) ? old_vertices_count - 1 : 0);
+    if (old_vertices_count == 0) {
+        m_valid_lines_bitset = BitSet<>(m_vertices.size());
+        m_valid_lines_bitset.setAll();
+    }
+    else {
+        m_valid_lines_bitset.grow(m_vertices.size());
+        for (size_t i = first_vertex_id; i < old_vertices_count; ++i) {
+            m_valid_lines_bitset.set(i);
+        }
+    }
 
     if (m_settings.time_mode != ETimeMode::Normal && m_total_time[static_cast<size_t>(m_settings.time_mode)] == 0.0f)
         m_settings.time_mode = ETimeMode::Normal;
 
-    // buffers to send to gpu
+    // buffers to send to gpu, only for the vertices which changed
     // the last component is a dummy float to comply with GL_RGBA32F format
     std::vector<Vec4> positions;
     std::vector<Vec4> heights_widths_angles;
-    positions.reserve(m_vertices.size());
-    heights_widths_angles.reserve(m_vertices.size());
-    extract_pos_and_or_hwa(m_vertices, m_travels_radius, m_wipes_radius, m_valid_lines_bitset, &positions, &heights_widths_angles, true);
+    extract_pos_and_or_hwa(m_vertices, first_vertex_id, m_travels_radius, m_wipes_radius, m_valid_lines_bitset, &positions, &heights_widths_angles, true);
+
+    // without an OpenGL context (f.e. when benchmarking) only the cpu data are updated
+    if (m_initialized && !positions.empty())
+        update_vertices_buffers(first_vertex_id, positions, heights_widths_angles);
 
-    if (!positions.empty()) {
+    update_view_full_range();
+    m_view_range.set_visible(m_view_range.get_enabled());
+    m_settings_used_for_ranges = std::nullopt;
+    m_settings.update_enabled_entities = true;
+    m_settings.update_colors = true;
+}
+
+void ViewerImpl::reserve(size_t vertices_count)
+{
+    m_vertices.reserve(vertices_count);
+    m_vertices_colors.reserve(vertices_count);
+
+    // without an OpenGL context (f.e. when benchmarking) only the cpu data are updated
+    if (!m_initialized || m_vertices.empty() || vertices_count <= m_vertices.size())
+        return;
+
+#ifdef ENABLE_OPENGL_ES
+    if (m_texture_data.get_vertices_count() >= vertices_count)
+        return;
+
+    // size the textures for all the vertices, then append() only sends the new ones
+    std::vector<Vec4> positions;
+    std::vector<Vec4> heights_widths_angles;
+    extract_pos_and_or_hwa(m_vertices, 0, m_travels_radius, m_wipes_radius, m_valid_lines_bitset, &positions, &heights_widths_angles);
+    m_texture_data.reset();
+    m_texture_data.init(vertices_count);
+    m_texture_data.set_positions(to_vec3(positions));
+    m_texture_data.set_heights_widths_angles(to_vec3(heights_widths_angles));
+    // the colors and enabled entities textures were released as well
+    m_settings.update_enabled_entities = true;
+    m_settings.update_colors = true;
+#else
+    // size the buffers for all the vertices, then append() only sends the new ones
+    const size_t size = vertices_count * sizeof(Vec4);
+    if (m_positions_tex_size < size)
+        m_positions_tex_size = resize_buffer(m_positions_buf_id, m_positions_tex_size, size, m_vertices.size() * sizeof(Vec4), GL_STATIC_DRAW);
+    if (m_height_width_angle_tex_size < size)
+        m_height_width_angle_tex_size = resize_buffer(m_heights_widths_angles_buf_id, m_height_width_angle_tex_size, size, m_vertices.size() * sizeof(Vec4), GL_DYNAMIC_DRAW);
+#endif // ENABLE_OPENGL_ES
+}
+
+void ViewerImpl::update_vertices_buffers(size_t first_vertex_id, const std::vector<Vec4>& positions, const std::vector<Vec4>& heights_widths_angles)
+{
 #ifdef ENABLE_OPENGL_ES
-        m_texture_data.init(positions.size());
+    if (m_texture_data.get_vertices_count() < m_vertices.size()) {
+        // textures cannot be extended keeping their content, recreate them from all the vertices.
+        // Not expected when loading in chunks, the textures are sized for all the vertices by reserve()
+        std::vector<Vec4> all_positions;
+        std::vector<Vec4> all_heights_widths_angles;
+        if (first_vertex_id > 0)
+            extract_pos_and_or_hwa(m_vertices, 0, m_travels_radius, m_wipes_radius, m_valid_lines_bitset, &all_positions, &all_heights_widths_angles);
+        m_texture_data.reset();
+        m_texture_data.init(m_vertices.size());
         // create and fill position textures
-        m_texture_data.set_positions(positions);
+        m_texture_data.set_positions(to_vec3((first_vertex_id > 0) ? all_positions : positions));
         // create and fill height, width and angle textures
-        m_texture_data.set_heights_widths_angles(heights_widths_angles);
+        m_texture_data.set_heights_widths_angles(to_vec3((first_vertex_id > 0) ? all_heights_widths_angles : heights_widths_angles));
+    }
+    else {
+        m_texture_data.update_positions(first_vertex_id, to_vec3(positions));
+        m_texture_data.update_heights_widths_angles(first_vertex_id, to_vec3(heights_widths_angles));
+    }
 #else
-        m_positions_tex_size = positions.size() * sizeof(Vec3);
-        m_height_width_angle_tex_size = heights_widths_angles.size() * sizeof(Vec3);
-
-        int old_bound_texture = 0;
-        glsafe(glGetIntegerv(GL_TEXTURE_BINDING_BUFFER, &old_bound_texture));
+    int old_bound_texture = 0;
+    glsafe(glGetIntegerv(GL_TEXTURE_BINDING_BUFFER, &old_bound_texture));
 
-        // create and fill positions buffer
-        glsafe(glGenBuffers(1, &m_positions_buf_id));
-        glsafe(glBindBuffer(GL_TEXTURE_BUFFER, m_positions_buf_id));
-        glsafe(glBufferData(GL_TEXTURE_BUFFER, positions.size() * sizeof(Vec4), positions.data(), GL_STATIC_DRAW));
+    // fill positions buffer
+    m_positions_tex_size = update_buffer(m_positions_buf_id, m_positions_tex_size, first_vertex_id * sizeof(Vec4),
+        positions.data(), positions.size() * sizeof(Vec4), GL_STATIC_DRAW);
+    if (m_positions_tex_id == 0)
         glsafe(glGenTextures(1, &m_positions_tex_id));
-        glsafe(glBindTexture(GL_TEXTURE_BUFFER, m_positions_tex_id));
 
-        // create and fill height, width and angles buffer
-        glsafe(glGenBuffers(1, &m_heights_widths_angles_buf_id));
-        glsafe(glBindBuffer(GL_TEXTURE_BUFFER, m_heights_widths_angles_buf_id));
-        glsafe(glBufferData(GL_TEXTURE_BUFFER, heights_widths_angles.size() * sizeof(Vec4), heights_widths_angles.data(), GL_DYNAMIC_DRAW));
+    // fill height, width and angles buffer
+    m_height_width_angle_tex_size = update_buffer(m_heights_widths_angles_buf_id, m_height_width_angle_tex_size, first_vertex_id * sizeof(Vec4),
+        heights_widths_angles.data(), heights_widths_angles.size() * sizeof(Vec4), GL_DYNAMIC_DRAW);
+    if (m_heights_widths_angles_tex_id == 0)
         glsafe(glGenTextures(1, &m_heights_widths_angles_tex_id));
-        glsafe(glBindTexture(GL_TEXTURE_BUFFER, m_heights_widths_angles_tex_id));
 
+    if (m_colors_buf_id == 0) {
         // create (but do not fill) colors buffer (data is set in update_colors())
         glsafe(glGenBuffers(1, &m_colors_buf_id));
         glsafe(glBindBuffer(GL_TEXTURE_BUFFER, m_colors_buf_id));
         glsafe(glGenTextures(1, &m_colors_tex_id));
         glsafe(glBindTexture(GL_TEXTURE_BUFFER, m_colors_tex_id));
+    }
 
+    if (m_enabled_segments_buf_id == 0) {
         // create (but do not fill) enabled segments buffer (data is set in update_enabled_entities())
         glsafe(glGenBuffers(1, &m_enabled_segments_buf_id));
         glsafe(glBindBuffer(GL_TEXTURE_BUFFER, m_enabled_segments_buf_id));
         glsafe(glGenTextures(1, &m_enabled_segments_tex_id));
         glsafe(glBindTexture(GL_TEXTURE_BUFFER, m_enabled_segments_tex_id));
+    }
 
+    if (m_enabled_options_buf_id == 0) {
         // create (but do not fill) enabled options buffer (data is set in update_enabled_entities())
         glsafe(glGenBuffers(1, &m_enabled_options_buf_id));
         glsafe(glBindBuffer(GL_TEXTURE_BUFFER, m_enabled_options_buf_id));
         glsafe(glGenTextures(1, &m_enabled_options_tex_id));
         glsafe(glBindTexture(GL_TEXTURE_BUFFER, m_enabled_options_tex_id));
-
-        glsafe(glBindBuffer(GL_TEXTURE_BUFFER, 0));
-        glsafe(glBindTexture(GL_TEXTURE_BUFFER, old_bound_texture));
-#endif // ENABLE_OPENGL_ES
     }
 
-    update_view_full_range();
-    m_view_range.set_visible(m_view_range.get_enabled());
-    update_enabled_entities();
-    update_colors();
+    glsafe(glBindBuffer(GL_TEXTURE_BUFFER, 0));
+    glsafe(glBindTexture(GL_TEXTURE_BUFFER, old_bound_texture));
+#endif // ENABLE_OPENGL_ES
 }
 
 void ViewerImpl::update_enabled_entities()
@@ -1183,6 +1355,10 @@ void ViewerImpl::update_enabled_entities()
             enabled_segments.push_back(static_cast<uint32_t>(i));
     }
 
+    m_settings.update_enabled_entities = false;
+    if (!m_initialized)
+        return;
+
 #ifdef ENABLE_OPENGL_ES
     m_texture_data.set_enabled_segments(enabled_segments);
     m_texture_data.set_enabled_options(enabled_options);
@@ -1211,8 +1387,6 @@ void ViewerImpl::update_enabled_entities()
 
     glsafe(glBindBuffer(GL_TEXTURE_BUFFER, 0));
 #endif // ENABLE_OPENGL_ES
-
-    m_settings.update_enabled_entities = false;
 }
 
 static float encode_color(const Color& color) {
@@ -1226,6 +1400,8 @@ static float encode_color(const Color& color) {
 
 void ViewerImpl::update_colors_texture()
 {
+    if (!m_initialized)
+        return;
 #if !defined(ENABLE_OPENGL_ES)
     if (m_colors_buf_id == 0)
         return;
@@ -1321,9 +1497,7 @@ void ViewerImpl::set_time_mode(ETimeMode mode)
     m_settings.time_mode = mode;
     m_settings.update_colors = true;
     // Update layer_duration for all vertices based on the new time mode
-    for (PathVertex& v : m_vertices) {
-        v.layer_duration = m_layers.get_layer_time(mode, static_cast<size_t>(v.layer_id));
-    }
+    m_vertices.set_layers_durations(m_layers.get_times(mode));
 }
 
 void ViewerImpl::set_layers_view_range(Interval::value_type min, Interval::value_type max)
@@ -1665,7 +1839,7 @@ size_t ViewerImpl::get_used_cpu_memory() const
     ret += m_used_extruders.size() * sizeof(std::map<uint8_t, ColorPrint>::value_type);
     ret += sizeof(m_extrusion_roles_colors);
     ret += sizeof(m_options_colors);
-    ret += STDVEC_MEMSIZE(m_vertices, PathVertex);
+    ret += m_vertices.size_in_bytes_cpu();
     ret += m_valid_lines_bitset.size_in_bytes_cpu();
     ret += m_height_range.size_in_bytes_cpu();
     ret += m_width_range.size_in_bytes_cpu();
@@ -1753,7 +1927,8 @@ void ViewerImpl::update_view_full_range()
             }
         }
 
-        auto last_it = first_it;
+        // the vertices are sorted by layer, skip the layers preceding the last one of the range
+        auto last_it = std::max(first_it, m_vertices.begin() + m_layers.get_layer_vertices_range(layers_range[1])[0]);
         while (last_it != m_vertices.end() && last_it->layer_id <= layers_range[1]) {
             ++last_it;
         }
@@ -1880,10 +2055,10 @@ void ViewerImpl::update_color_ranges()
 void ViewerImpl::update_heights_widths()
 {
 #ifdef ENABLE_OPENGL_ES
-    std::vector<Vec3> heights_widths_angles;
+    std::vector<Vec4> heights_widths_angles;
     heights_widths_angles.reserve(m_vertices.size());
-    extract_pos_and_or_hwa(m_vertices, m_travels_radius, m_wipes_radius, m_valid_lines_bitset, nullptr, &heights_widths_angles);
-    m_texture_data.set_heights_widths_angles(heights_widths_angles);
+    extract_pos_and_or_hwa(m_vertices, 0, m_travels_radius, m_wipes_radius, m_valid_lines_bitset, nullptr, &heights_widths_angles);
+    m_texture_data.set_heights_widths_angles(to_vec3(heights_widths_angles));
 #else
     if (m_heights_widths_angles_buf_id == 0)
         return;
@@ -18,6 +18,7 @@
 #include "Bitset.hpp"
 #include "ViewRange.hpp"
 #include "Layers.hpp"
+#include "PathVertices.hpp"
 #include "ExtrusionRoles.hpp"
 
 #include <string>
@@ -54,6 +55,19 @@ public:
     // from the given gcode data.
     //
     void load(GCodeInputData&& gcode_data);
+    //
+    // Append the given vertices to the toolpaths already loaded.
+    // The view is extended to the new vertices, colors and visibility are
+    // updated at the next call to render().
+    //
+    void append(std::vector<PathVertex>&& vertices);
+    //
+    // Reserve memory for the given total count of vertices, in cpu and gpu memory,
+    // so that append() does not need to reallocate it
+    //
+    void reserve(size_t vertices_count);
+    EVerticesEncoding get_vertices_encoding() const { return m_vertices.get_encoding(); }
+    void set_vertices_encoding(EVerticesEncoding encoding);
 
     //
     // Update the visibility property of toolpaths in dependence
@@ -128,9 +142,9 @@ public:
     void set_view_visible_range(Interval::value_type min, Interval::value_type max);
 
     size_t get_vertices_count() const { return m_vertices.size(); }
-    const PathVertex& get_current_vertex() const { return get_vertex_at(get_current_vertex_id()); }
+    PathVertex get_current_vertex() const { return get_vertex_at(get_current_vertex_id()); }
     size_t get_current_vertex_id() const { return static_cast<size_t>(m_view_range.get_visible()[1]); }
-    const PathVertex& get_vertex_at(size_t id) const {
+    PathVertex get_vertex_at(size_t id) const {
         return (id < m_vertices.size()) ? m_vertices[id] : PathVertex::DUMMY_PATH_VERTEX;
     }
     float get_estimated_time() const { return m_total_time[static_cast<size_t>(m_settings.time_mode)]; }
@@ -270,7 +284,7 @@ private:
     //
     // cpu buffer to store vertices
     //
-    std::vector<PathVertex> m_vertices;
+    PathVertices m_vertices;
 
     // Cache for the colors to reduce the need to recalculate colors of all the vertices.
     std::vector<float> m_vertices_colors;
@@ -355,11 +369,18 @@ private:
         void init(size_t vertices_count);
         void set_positions(const std::vector<Vec3>& positions);
         void set_heights_widths_angles(const std::vector<Vec3>& heights_widths_angles);
+        //
+        // Update the data of the vertices starting at the given index,
+        // the textures keep the size set by init()
+        //
+        void update_positions(size_t first_vertex_id, const std::vector<Vec3>& positions);
+        void update_heights_widths_angles(size_t first_vertex_id, const std::vector<Vec3>& heights_widths_angles);
         void set_colors(const std::vector<float>& colors);
         void set_enabled_segments(const std::vector<uint32_t>& enabled_segments);
         void set_enabled_options(const std::vector<uint32_t>& enabled_options);
         void reset();
         size_t get_count() const { return m_count; }
+        size_t get_vertices_count() const { return m_vertices_count; }
         std::pair<unsigned int, size_t> get_positions_tex_id(size_t id) const;
         std::pair<unsigned int, size_t> get_heights_widths_angles_tex_id(size_t id) const;
         std::pair<unsigned int, size_t> get_colors_tex_id(size_t id) const;
@@ -373,6 +394,10 @@ private:
         size_t get_used_gpu_memory() const;
 
     private:
+        //
+        // Count of vertices the textures are sized for
+        //
+        size_t m_vertices_count{ 0 };
         //
         // Texture width
         //
@@ -419,6 +444,10 @@ private:
         };
 
         std::vector<TexIds> m_tex_ids;
+
+        using TexId = std::pair<unsigned int, size_t> TexIds::*;
+        void create_vertices_textures(TexId tex_id, int internal_format, unsigned int format);
+        void update_vertices_textures(TexId tex_id, unsigned int format, size_t first_vertex_id, const std::vector<Vec3>& data);
     };
 
     TextureData m_texture_data;
@@ -463,6 +492,12 @@ private:
     void update_view_full_range();
     void update_color_ranges();
     void update_heights_widths();
+    //
+    // Send to the gpu the positions and the heights, widths and angles of the vertices
+    // starting at the given index
+    //
+    void update_vertices_buffers(size_t first_vertex_id, const std::vector<std::array<float, 4>>& positions,
+        const std::vector<std::array<float, 4>>& heights_widths_angles);
     void render_segments(const Mat4x4& view_matrix, const Mat4x4& projection_matrix, const Vec3& camera_position);
     void render_options(const Mat4x4& view_matrix, const Mat4x4& projection_matrix);
 #if VGCODE_ENABLE_COG_AND_TOOL_MARKERS
@@ -1092,6 +1092,19 @@ std::vector<int> GCodeViewer::get_plater_extruder()
     return m_plater_extruder;
 }
 
+// End of the chunk of moves starting at the given index, the moves are sent to the viewer in chunks of layers
+static size_t next_moves_chunk_end(const std::vector<GCodeProcessorResult::MoveVertex>& moves, size_t begin)
+{
+    static const unsigned int LayersPerChunk = 50;
+    size_t end = std::max<size_t>(begin, 1);
+    if (end >= moves.size())
+        return moves.size();
+    const unsigned int last_layer_id = moves[end].layer_id + LayersPerChunk;
+    while (end < moves.size() && moves[end].layer_id < last_layer_id)
+        ++end;
+    return end;
+}
+
 //BBS: always load shell at preview
 void GCodeViewer::load_as_gcode(const GCodeProcessorResult& gcode_result, const Print& print, const std::vector<std::string>& str_tool_colors,
                 const std::vector<std::string>& str_color_print_colors, const BuildVolume& build_volume,
@@ -1146,8 +1159,13 @@ void GCodeViewer::load_as_gcode(const GCodeProcessorResult& gcode_result, const
         return;
     }
 
-    // convert data from PrusaSlicer format to libvgcode format
-    libvgcode::GCodeInputData data = libvgcode::convert(gcode_result, str_tool_colors, str_color_print_colors, m_viewer);
+    // convert data from PrusaSlicer format to libvgcode format.
+    // The moves are converted and sent to the viewer in chunks of layers, so that the converted vertices
+    // and the gpu staging buffers of the whole gcode do not need to live in memory at once.
+    // Only the first chunk is loaded here, the remaining ones are loaded by load_next_chunk()
+    const std::vector<GCodeProcessorResult::MoveVertex>& moves = gcode_result.moves;
+    const size_t moves_end = next_moves_chunk_end(moves, 0);
+    libvgcode::GCodeInputData data = libvgcode::convert(gcode_result, str_tool_colors, str_color_print_colors, m_viewer, moves_end);
 
 //#define ENABLE_DATA_EXPORT 1
 //#if ENABLE_DATA_EXPORT
@@ -1241,9 +1259,17 @@ void GCodeViewer::load_as_gcode(const GCodeProcessorResult& gcode_result, const
 //    }
 //#endif // ENABLE_DATA_EXPORT
 
-    // send data to the viewer
+    // send data to the viewer.
+    // Large gcodes are stored quantized in cpu memory, the loss of precision is not visible in the preview
+    static const size_t QuantizedVerticesMinCount = 5000000;
+    m_viewer.set_vertices_encoding((moves.size() > QuantizedVerticesMinCount) ? libvgcode::EVerticesEncoding::Quantized : libvgcode::EVerticesEncoding::Float);
     m_viewer.reset_default_extrusion_roles_colors();
     m_viewer.load(std::move(data));
+    if (moves_end < moves.size()) {
+        m_viewer.reserve(libvgcode::vertices_count(gcode_result));
+        // the background processing stays suppressed until the last chunk is loaded, so that the gcode result is not replaced meanwhile
+        m_chunked_loading = { print.get_plate_index(), print.id(), moves.size(), moves_end };
+    }
 
 // #if !VGCODE_ENABLE_COG_AND_TOOL_MARKERS
 //     const size_t vertices_count = m_viewer.get_vertices_count();
@@ -1263,23 +1289,6 @@ void GCodeViewer::load_as_gcode(const GCodeProcessorResult& gcode_result, const
 //     }
 // #endif // !VGCODE_ENABLE_COG_AND_TOOL_MARKERS
 
-    const libvgcode::AABox bbox = wxGetApp().is_gcode_viewer() ?
-        m_viewer.get_bounding_box() :
-        m_viewer.get_extrusion_bounding_box({
-            libvgcode::EGCodeExtrusionRole::Perimeter, libvgcode::EGCodeExtrusionRole::ExternalPerimeter, libvgcode::EGCodeExtrusionRole::OverhangPerimeter,
-            libvgcode::EGCodeExtrusionRole::InternalInfill, libvgcode::EGCodeExtrusionRole::SolidInfill, libvgcode::EGCodeExtrusionRole::TopSolidInfill,
-            libvgcode::EGCodeExtrusionRole::Ironing, libvgcode::EGCodeExtrusionRole::BridgeInfill, libvgcode::EGCodeExtrusionRole::GapFill,
-            libvgcode::EGCodeExtrusionRole::Skirt, libvgcode::EGCodeExtrusionRole::SupportMaterial, libvgcode::EGCodeExtrusionRole::SupportMaterialInterface,
-            libvgcode::EGCodeExtrusionRole::WipeTower,
-            // ORCA
-            libvgcode::EGCodeExtrusionRole::BottomSurface, libvgcode::EGCodeExtrusionRole::InternalBridgeInfill, libvgcode::EGCodeExtrusionRole::Brim,
-            libvgcode::EGCodeExtrusionRole::SupportTransition, libvgcode::EGCodeExtrusionRole::Mixed
-            });
-    m_paths_bounding_box = BoundingBoxf3(libvgcode::convert(bbox[0]).cast<double>(), libvgcode::convert(bbox[1]).cast<double>());
-
-    if (wxGetApp().is_editor())
-        m_contained_in_bed = wxGetApp().plater()->build_volume().all_paths_inside(gcode_result, m_paths_bounding_box);
-
     m_extruders_count = gcode_result.filaments_count;
 
     //BBS: move the id to the end of reset
@@ -1299,35 +1308,10 @@ void GCodeViewer::load_as_gcode(const GCodeProcessorResult& gcode_result, const
 
     // load_toolpaths(gcode_result, build_volume, exclude_bounding_box);
     
-    // ORCA: Only show filament/color print preview if more than one tool/extruder is actually used in the toolpaths.
-    // Only reset back to Toolpaths (FeatureType) if we are currently in ColorPrint and this load is single-tool.
-    if (m_viewer.get_used_extruders_count() > 1) {
-        auto it = std::find(view_type_items.begin(), view_type_items.end(), libvgcode::EViewType::ColorPrint);
-        if (it != view_type_items.end())
-            m_view_type_sel = std::distance(view_type_items.begin(), it);
-        set_view_type(libvgcode::EViewType::ColorPrint);
-    } else if (get_view_type() == libvgcode::EViewType::ColorPrint) {
-        auto it = std::find(view_type_items.begin(), view_type_items.end(), libvgcode::EViewType::FeatureType);
-        if (it != view_type_items.end())
-            m_view_type_sel = std::distance(view_type_items.begin(), it);
-        set_view_type(libvgcode::EViewType::FeatureType);
-    }
-
     // BBS: data for rendering color arrangement recommendation
     m_nozzle_nums = print.config().option<ConfigOptionFloats>("nozzle_diameter")->values.size();
     // Orca hack: Hide filament group for non-bbl printers
     if (!print.is_BBL_printer()) m_nozzle_nums = 1;
-    std::vector<int>         filament_maps = print.get_filament_maps();
-    std::vector<std::string> color_opt     = print.config().option<ConfigOptionStrings>("filament_colour")->values;
-    std::vector<std::string> type_opt      = print.config().option<ConfigOptionStrings>("filament_type")->values;
-    std::vector<unsigned char> support_filament_opt = print.config().option<ConfigOptionBools>("filament_is_support")->values;
-    for (auto extruder_id : m_viewer.get_used_extruders_ids()) {
-        if (filament_maps[extruder_id] == 1) {
-            m_left_extruder_filament.push_back({type_opt[extruder_id], color_opt[extruder_id], extruder_id, (bool)(support_filament_opt[extruder_id])});
-        } else {
-            m_right_extruder_filament.push_back({type_opt[extruder_id], color_opt[extruder_id], extruder_id, (bool)(support_filament_opt[extruder_id])});
-        }
-    }
 
     m_settings_ids = gcode_result.settings_ids;
     m_filament_diameters = gcode_result.filament_diameters;
@@ -1410,6 +1394,123 @@ void GCodeViewer::load_as_gcode(const GCodeProcessorResult& gcode_result, const
             m_viewer.set_time_mode(libvgcode::convert(PrintEstimatedStatistics::ETimeMode::Normal));
     }
 
+    bool only_gcode_3mf = false;
+    PartPlate* current_plate = wxGetApp().plater()->get_partplate_list().get_curr_plate();
+    bool current_has_print_instances = current_plate->has_printable_instances();
+    if (current_plate->is_slice_result_valid() && wxGetApp().model().objects.empty() && !current_has_print_instances)
+        only_gcode_3mf = true;
+    m_layers_slider->set_menu_enable(!(only_gcode || only_gcode_3mf));
+
+    //BBS
+    m_conflict_result = gcode_result.conflict_result;
+    m_gcode_check_result = gcode_result.gcode_check_result;
+
+    filament_printable_reuslt = gcode_result.filament_printable_reuslt;
+
+    update_from_loaded_toolpaths(gcode_result, print);
+    //BBS: add mutex for protection of gcode result
+    gcode_result.unlock();
+    if (!has_pending_chunks())
+        wxGetApp().plater()->schedule_background_process();
+}
+
+bool GCodeViewer::load_next_chunk()
+{
+    if (!has_pending_chunks())
+        return false;
+
+    auto stop_loading = [this]() {
+        m_chunked_loading = ChunkedLoading();
+        wxGetApp().plater()->schedule_background_process();
+    };
+
+    // the plate owning the print and the gcode result may have been deleted meanwhile
+    PrintBase*  print_base = nullptr;
+    GCodeResult* plate_result = nullptr;
+    if (PartPlate* plate = wxGetApp().plater()->get_partplate_list().get_plate(m_chunked_loading.plate_index); plate != nullptr)
+        plate->get_print(&print_base, &plate_result, nullptr);
+    const Print* print = dynamic_cast<const Print*>(print_base);
+    if (print == nullptr || print->id() != m_chunked_loading.print_id || plate_result != m_gcode_result) {
+        BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": print of plate %1% changed while loading, stop loading") % m_chunked_loading.plate_index;
+        stop_loading();
+        return false;
+    }
+
+    //BBS: add mutex for protection of gcode result
+    const GCodeProcessorResult& gcode_result = *m_gcode_result;
+    gcode_result.lock();
+    if (m_last_result_id != gcode_result.id || gcode_result.moves.size() != m_chunked_loading.moves_count) {
+        // the gcode result was reset meanwhile, it will be loaded again once it is valid
+        BOOST_LOG_TRIVIAL(warning) << __FUNCTION__ << boost::format(": gcode result %1% changed while loading, stop loading") % m_last_result_id;
+        gcode_result.unlock();
+        stop_loading();
+        return false;
+    }
+
+    const size_t moves_begin = m_chunked_loading.moves_begin;
+    const size_t moves_end   = next_moves_chunk_end(gcode_result.moves, moves_begin);
+    m_viewer.append(libvgcode::convert_moves(gcode_result, moves_begin, moves_end));
+    const bool completed = moves_end == gcode_result.moves.size();
+    if (completed) {
+        update_from_loaded_toolpaths(gcode_result, *print);
+        m_chunked_loading = ChunkedLoading();
+    }
+    else
+        m_chunked_loading.moves_begin = moves_end;
+    gcode_result.unlock();
+
+    if (completed)
+        wxGetApp().plater()->schedule_background_process();
+    return completed;
+}
+
+void GCodeViewer::update_from_loaded_toolpaths(const GCodeProcessorResult& gcode_result, const Print& print)
+{
+    const libvgcode::AABox bbox = wxGetApp().is_gcode_viewer() ?
+        m_viewer.get_bounding_box() :
+        m_viewer.get_extrusion_bounding_box({
+            libvgcode::EGCodeExtrusionRole::Perimeter, libvgcode::EGCodeExtrusionRole::ExternalPerimeter, libvgcode::EGCodeExtrusionRole::OverhangPerimeter,
+            libvgcode::EGCodeExtrusionRole::InternalInfill, libvgcode::EGCodeExtrusionRole::SolidInfill, libvgcode::EGCodeExtrusionRole::TopSolidInfill,
+            libvgcode::EGCodeExtrusionRole::Ironing, libvgcode::EGCodeExtrusionRole::BridgeInfill, libvgcode::EGCodeExtrusionRole::GapFill,
+            libvgcode::EGCodeExtrusionRole::Skirt, libvgcode::EGCodeExtrusionRole::SupportMaterial, libvgcode::EGCodeExtrusionRole::SupportMaterialInterface,
+            libvgcode::EGCodeExtrusionRole::WipeTower,
+            // ORCA
+            libvgcode::EGCodeExtrusionRole::BottomSurface, libvgcode::EGCodeExtrusionRole::InternalBridgeInfill, libvgcode::EGCodeExtrusionRole::Brim,
+            libvgcode::EGCodeExtrusionRole::SupportTransition, libvgcode::EGCodeExtrusionRole::Mixed
+            });
+    m_paths_bounding_box = BoundingBoxf3(libvgcode::convert(bbox[0]).cast<double>(), libvgcode::convert(bbox[1]).cast<double>());
+
+    if (wxGetApp().is_editor())
+        m_contained_in_bed = wxGetApp().plater()->build_volume().all_paths_inside(gcode_result, m_paths_bounding_box);
+
+    // ORCA: Only show filament/color print preview if more than one tool/extruder is actually used in the toolpaths.
+    // Only reset back to Toolpaths (FeatureType) if we are currently in ColorPrint and this load is single-tool.
+    if (m_viewer.get_used_extruders_count() > 1) {
+        auto it = std::find(view_type_items.begin(), view_type_items.end(), libvgcode::EViewType::ColorPrint);
+        if (it != view_type_items.end())
+            m_view_type_sel = std::distance(view_type_items.begin(), it);
+        set_view_type(libvgcode::EViewType::ColorPrint);
+    } else if (get_view_type() == libvgcode::EViewType::ColorPrint) {
+        auto it = std::find(view_type_items.begin(), view_type_items.end(), libvgcode::EViewType::FeatureType);
+        if (it != view_type_items.end())
+            m_view_type_sel = std::distance(view_type_items.begin(), it);
+        set_view_type(libvgcode::EViewType::FeatureType);
+    }
+
+    m_left_extruder_filament.clear();
+    m_right_extruder_filament.clear();
+    std::vector<int>         filament_maps = print.get_filament_maps();
+    std::vector<std::string> color_opt     = print.config().option<ConfigOptionStrings>("filament_colour")->values;
+    std::vector<std::string> type_opt      = print.config().option<ConfigOptionStrings>("filament_type")->values;
+    std::vector<unsigned char> support_filament_opt = print.config().option<ConfigOptionBools>("filament_is_support")->values;
+    for (auto extruder_id : m_viewer.get_used_extruders_ids()) {
+        if (filament_maps[extruder_id] == 1) {
+            m_left_extruder_filament.push_back({type_opt[extruder_id], color_opt[extruder_id], extruder_id, (bool)(support_filament_opt[extruder_id])});
+        } else {
+            m_right_extruder_filament.push_back({type_opt[extruder_id], color_opt[extruder_id], extruder_id, (bool)(support_filament_opt[extruder_id])});
+        }
+    }
+
     // set to color print by default if use multi extruders
     if (m_viewer.get_used_extruders_count() > 1) {
         for (int i = 0; i < view_type_items.size(); i++) {
@@ -1422,31 +1523,18 @@ void GCodeViewer::load_as_gcode(const GCodeProcessorResult& gcode_result, const
         set_view_type(libvgcode::EViewType::ColorPrint);
     }
 
-    bool only_gcode_3mf = false;
-    PartPlate* current_plate = wxGetApp().plater()->get_partplate_list().get_curr_plate();
-    bool current_has_print_instances = current_plate->has_printable_instances();
-    if (current_plate->is_slice_result_valid() && wxGetApp().model().objects.empty() && !current_has_print_instances)
-        only_gcode_3mf = true;
-    m_layers_slider->set_menu_enable(!(only_gcode || only_gcode_3mf));
     m_layers_slider->set_as_dirty();
     m_moves_slider->set_as_dirty();
 
     //BBS
-    m_conflict_result = gcode_result.conflict_result;
     if (m_conflict_result) { m_conflict_result.value().layer = m_viewer.get_layer_id_at(static_cast<float>(m_conflict_result.value()._height)); }
-
-    m_gcode_check_result = gcode_result.gcode_check_result;
-
-    filament_printable_reuslt = gcode_result.filament_printable_reuslt;
-    //BBS: add mutex for protection of gcode result
-    gcode_result.unlock();
-    wxGetApp().plater()->schedule_background_process();
 }
 
 void GCodeViewer::load_as_preview(libvgcode::GCodeInputData&& data)
 {
     m_loaded_as_preview = true;
 
+    m_viewer.set_vertices_encoding(libvgcode::EVerticesEncoding::Float);
     m_viewer.set_extrusion_role_color(libvgcode::EGCodeExtrusionRole::Skirt,                    { 127, 255, 127 });
     m_viewer.set_extrusion_role_color(libvgcode::EGCodeExtrusionRole::ExternalPerimeter,        { 255, 255, 0 });
     m_viewer.set_extrusion_role_color(libvgcode::EGCodeExtrusionRole::SupportMaterial,          { 127, 255, 127 });
@@ -1500,6 +1588,13 @@ void GCodeViewer::reset()
     m_right_extruder_filament.clear();
     m_sequential_view.gcode_window.reset();
     m_contained_in_bed = true;
+
+    if (has_pending_chunks()) {
+        // the background processing was suppressed until the last chunk was loaded
+        m_chunked_loading = ChunkedLoading();
+        if (Plater* plater = wxGetApp().plater())
+            plater->schedule_background_process();
+    }
 }
 
 //BBS: GUI refactor: add canvas width and height
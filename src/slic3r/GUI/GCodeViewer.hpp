@@ -240,6 +240,19 @@ mutable bool m_no_render_path { false };
     libvgcode::Viewer m_viewer;
     bool m_loaded_as_preview{ false };
 
+    // State of the toolpaths of m_gcode_result which are sent to the viewer in chunks, see load_next_chunk()
+    struct ChunkedLoading
+    {
+        // the print is looked up by its plate on every chunk, as the plate may be deleted or resliced between the idle events
+        int plate_index{ -1 };
+        ObjectID print_id;
+        // count of the moves of the gcode result when the loading started
+        size_t moves_count{ 0 };
+        // first move of the next chunk, zero when all the moves were sent to the viewer
+        size_t moves_begin{ 0 };
+    };
+    ChunkedLoading m_chunked_loading;
+
 public:
     GCodeViewer();
     ~GCodeViewer();
@@ -256,6 +269,11 @@ public:
         const std::vector<std::string>& str_color_print_colors, const BuildVolume& build_volume,
         const std::vector<BoundingBoxf3>& exclude_bounding_box, ConfigOptionMode mode, bool only_gcode = false);
     void load_as_preview(libvgcode::GCodeInputData&& data);
+    // Large gcodes are sent to the viewer in chunks of layers, the first one by load_as_gcode(),
+    // the remaining ones by load_next_chunk(), to be called on idle until it returns true.
+    // The bounding box, the filaments and the view type are updated once the last chunk is loaded.
+    bool has_pending_chunks() const { return m_chunked_loading.moves_begin != 0; }
+    bool load_next_chunk();
     void update_shells_color_by_extruder(const DynamicPrintConfig* config);
     void set_shell_transparency(float alpha = 0.15f);
 
@@ -304,7 +322,7 @@ public:
     const libvgcode::Interval& get_gcode_view_full_range() const { return m_viewer.get_view_full_range(); }
     const libvgcode::Interval& get_gcode_view_enabled_range() const { return m_viewer.get_view_enabled_range(); }
     const libvgcode::Interval& get_gcode_view_visible_range() const { return m_viewer.get_view_visible_range(); }
-    const libvgcode::PathVertex& get_gcode_vertex_at(size_t id) const { return m_viewer.get_vertex_at(id); }
+    libvgcode::PathVertex get_gcode_vertex_at(size_t id) const { return m_viewer.get_vertex_at(id); }
 
     bool is_contained_in_bed() const { return m_contained_in_bed; }
     //BBS: add only gcode mode
@@ -350,6 +368,8 @@ public:
 private:
     //BBS: always load shell at preview
     //void load_shells(const Print& print);
+    // update the data derived from the toolpaths sent to the viewer so far
+    void update_from_loaded_toolpaths(const GCodeProcessorResult& gcode_result, const Print& print);
     void render_toolpaths();
     void render_shells(int canvas_width, int canvas_height);
 
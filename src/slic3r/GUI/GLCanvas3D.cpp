@@ -1043,6 +1043,7 @@ wxDEFINE_EVENT(EVT_GLCANVAS_RENDER_TIMER, wxTimerEvent/*RenderTimerEvent*/);
 wxDEFINE_EVENT(EVT_GLCANVAS_TOOLBAR_HIGHLIGHTER_TIMER, wxTimerEvent);
 wxDEFINE_EVENT(EVT_GLCANVAS_GIZMO_HIGHLIGHTER_TIMER, wxTimerEvent);
 wxDEFINE_EVENT(EVT_GLCANVAS_UPDATE, SimpleEvent);
+wxDEFINE_EVENT(EVT_GLCANVAS_GCODE_PREVIEW_LOADED, SimpleEvent);
 wxDEFINE_EVENT(EVT_CUSTOMEVT_TICKSCHANGED, wxCommandEvent);
 wxDEFINE_EVENT(EVT_GLCANVAS_RESET_LAYER_HEIGHT_PROFILE, SimpleEvent);
 wxDEFINE_EVENT(EVT_GLCANVAS_ADAPTIVE_LAYER_HEIGHT_PROFILE, Event<float>);
@@ -3175,6 +3176,17 @@ void GLCanvas3D::on_idle(wxIdleEvent& evt)
 #endif // ENABLE_ENHANCED_IMGUI_SLIDER_FLOAT
     m_dirty |= GLTexture::Compressor::has_compressed_texture_to_refresh();
 
+    if (m_gcode_viewer.has_pending_chunks()) {
+        // the toolpaths of a large gcode are loaded one chunk per idle event, rendering the ones loaded so far in between
+        if (_set_current() && m_gcode_viewer.load_next_chunk()) {
+            m_gcode_layers_times_cache = m_gcode_viewer.get_layers_times();
+            m_gcode_viewer.get_moves_slider()->SetHigherValue(m_gcode_viewer.get_moves_slider()->GetMaxValue());
+            post_event(SimpleEvent(EVT_GLCANVAS_GCODE_PREVIEW_LOADED));
+        }
+        m_dirty = true;
+        request_extra_frame();
+    }
+
     if (!m_dirty)
         return;
 
@@ -281,6 +281,13 @@ bool Preview::init(wxWindow* parent, Bed3D& bed, Model* model)
 
     // sizer, m_canvas_widget
     m_canvas_widget->Bind(wxEVT_KEY_DOWN, &Preview::update_layers_slider_from_canvas, this);
+    // the layers of a large gcode are known once all its toolpaths are loaded
+    m_canvas_widget->Bind(EVT_GLCANVAS_GCODE_PREVIEW_LOADED, [this](SimpleEvent&) {
+        const std::vector<double> zs = m_canvas->get_gcode_layers_zs();
+        if (!zs.empty())
+            update_layers_slider(zs, true);
+        m_canvas_widget->Refresh();
+    });
 
     wxBoxSizer *main_sizer = new wxBoxSizer(wxVERTICAL);
     main_sizer->Add(m_canvas_widget, 1, wxALL | wxEXPAND, 0);
@@ -169,6 +169,7 @@ void OrientJob::process(Ctl &ctl)
     else {
         params.min_volume = true;
     }
+    params.parallel = true;
 
     auto count = unsigned(m_selected.size() + m_unprintable.size());
     params.stopcondition = [&ctl]() { return ctl.was_canceled(); };
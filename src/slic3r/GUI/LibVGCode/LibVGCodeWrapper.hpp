@@ -12,6 +12,7 @@
 #include <stddef.h>
 #include <string>
 #include <vector>
+#include <limits>
 #include <cstddef>
 
 #include "../../src/libvgcode/include/Types.hpp"
@@ -70,8 +71,16 @@ extern ETimeMode convert(const Slic3r::PrintEstimatedStatistics::ETimeMode& mode
 extern Slic3r::PrintEstimatedStatistics::ETimeMode convert(const ETimeMode& mode);
 
 // mapping from Slic3r::GCodeProcessorResult to libvgcode::GCodeInputData
+// Only the moves before moves_end are converted, the remaining ones can be converted
+// by convert_moves() and appended to the viewer
 extern GCodeInputData convert(const Slic3r::GCodeProcessorResult& result, const std::vector<std::string>& str_tool_colors,
-    const std::vector<std::string>& str_color_print_colors, const Viewer& viewer);
+    const std::vector<std::string>& str_color_print_colors, const Viewer& viewer, size_t moves_end = std::numeric_limits<size_t>::max());
+
+// mapping from the moves [moves_begin, moves_end) of Slic3r::GCodeProcessorResult to libvgcode::PathVertex
+extern std::vector<PathVertex> convert_moves(const Slic3r::GCodeProcessorResult& result, size_t moves_begin, size_t moves_end);
+
+// count of the libvgcode::PathVertex the moves of Slic3r::GCodeProcessorResult are converted to
+extern size_t vertices_count(const Slic3r::GCodeProcessorResult& result);
 
 // mapping from Slic3r::Print to libvgcode::GCodeInputData
 extern GCodeInputData convert(const Slic3r::Print& print, const std::vector<std::string>& str_tool_colors,
@@ -2340,6 +2340,7 @@ void TabPrint::build()
         optgroup->append_single_option_line("min_length_factor", "quality_settings_wall_generator#arachne");
         optgroup->append_single_option_line("wall_maximum_resolution", "quality_settings_wall_generator#arachne");
         optgroup->append_single_option_line("wall_maximum_deviation", "quality_settings_wall_generator#arachne");
+        optgroup->append_single_option_line("wall_generator_cache", "quality_settings_wall_generator#arachne");
 
         optgroup = page->new_optgroup(L("Walls and surfaces"), L"param_wall_surface");
         optgroup->append_single_option_line("wall_sequence", "quality_settings_wall_and_surfaces#walls-printing-order");
@@ -2579,6 +2580,7 @@ void TabPrint::build()
         optgroup->append_single_option_line("tree_support_branch_angle", "support_settings_tree#branch-angle");
         optgroup->append_single_option_line("tree_support_branch_angle_organic", "support_settings_tree#branch-angle");
         optgroup->append_single_option_line("tree_support_angle_slow", "support_settings_tree#preferred-branch-angle");
+        optgroup->append_single_option_line("tree_support_area_cache", "support_settings_tree");
         optgroup->append_single_option_line("tree_support_auto_brim", "support_settings_tree");
         optgroup->append_single_option_line("tree_support_brim_width", "support_settings_tree");
 
@@ -1,14 +1,17 @@
 #include <catch2/catch_all.hpp>
 
+#include <chrono>
 #include <numeric>
 #include <sstream>
 
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Fill/Fill.hpp"
+#include "libslic3r/Fill/Lightning/Layer.hpp"
 #include "libslic3r/Flow.hpp"
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/SVG.hpp"
+#include "libslic3r/Utils.hpp"
 #include "libslic3r/libslic3r.h"
 
 #include "test_data.hpp"
@@ -429,6 +432,146 @@ for my $pattern (qw(rectilinear honeycomb hilbertcurve concentric)) {
 }
 */
 
+// Grows lightning trees through a stack of synthetic layers the way FillLightning::Generator does:
+// a disc of a varying radius with a hole in its lower half.
+struct LightningTreesStack
+{
+    std::vector<Polygons>             outlines;
+    std::vector<Polygons>             overhangs;
+    std::vector<FillLightning::Layer> layers;
+    coord_t                           supporting_radius;
+};
+
+static LightningTreesStack grow_lightning_trees(int num_layers, double radius)
+{
+    auto circle = [](double cx, double cy, double r, int n) {
+        Polygon out;
+        for (int i = 0; i < n; ++ i) {
+            double a = 2. * PI * i / n;
+            out.points.emplace_back(scaled<coord_t>(cx + r * cos(a)), scaled<coord_t>(cy + r * sin(a)));
+        }
+        return out;
+    };
+    LightningTreesStack    stack;
+    std::vector<Polygons> &outlines = stack.outlines;
+    outlines.assign(num_layers, {});
+    for (int layer_id = 0; layer_id < num_layers; ++ layer_id) {
+        double r = radius * (0.7 + 0.3 * std::sin(layer_id * 0.05));
+        outlines[layer_id].emplace_back(circle(0., 0., r, 180));
+        if (layer_id < num_layers / 2) {
+            outlines[layer_id].emplace_back(circle(r * 0.3, 0., r * 0.2, 60));
+            outlines[layer_id].back().reverse();
+        }
+    }
+    // 0.2mm layers, 0.45mm lines at 15% density.
+    const coord_t wall_supporting_radius = scaled<coord_t>(0.2);
+    const coord_t supporting_radius      = scaled<coord_t>(0.45 / 0.15);
+    stack.supporting_radius = supporting_radius;
+    std::vector<Polygons> &overhangs = stack.overhangs;
+    overhangs.assign(num_layers, {});
+    for (int layer_id = num_layers - 1; layer_id >= 0; -- layer_id)
+        overhangs[layer_id] = diff(offset(outlines[layer_id], -float(wall_supporting_radius)),
+            layer_id + 1 < num_layers ? outlines[layer_id + 1] : Polygons());
+
+    const coord_t                     locator_cell_size = FillLightning::locator_cell_size();
+    std::vector<FillLightning::Layer> &layers = stack.layers;
+    layers.resize(num_layers);
+    EdgeGrid::Grid                    outlines_locator(get_extents(outlines.back()).inflated(SCALED_EPSILON));
+    outlines_locator.create(outlines.back(), locator_cell_size);
+    for (int layer_id = num_layers - 1; layer_id >= 0; -- layer_id) {
+        FillLightning::Layer &layer = layers[layer_id];
+        BoundingBox           bbox  = get_extents(outlines[layer_id]);
+        std::vector<FillLightning::NodeIdx> to_be_reconnected_tree_roots = layer.tree_roots;
+        layer.generateNewTrees(overhangs[layer_id], outlines[layer_id], bbox, outlines_locator, supporting_radius, wall_supporting_radius, []{});
+        layer.reconnectRoots(to_be_reconnected_tree_roots, outlines[layer_id], bbox, outlines_locator, supporting_radius, wall_supporting_radius);
+        if (layer_id == 0)
+            break;
+        const Polygons &below_outlines      = outlines[layer_id - 1];
+        BoundingBox     below_outlines_bbox = get_extents(below_outlines).inflated(SCALED_EPSILON);
+        if (const BoundingBox &outlines_locator_bbox = outlines_locator.bbox(); outlines_locator_bbox.defined)
+            below_outlines_bbox.merge(outlines_locator_bbox);
+        if (! layer.tree_roots.empty())
+            below_outlines_bbox.merge(get_extents(layer.nodes, layer.tree_roots).inflated(SCALED_EPSILON));
+        outlines_locator.set_bbox(below_outlines_bbox);
+        outlines_locator.create(below_outlines, locator_cell_size);
+        for (FillLightning::NodeIdx tree : layer.tree_roots)
+            layer.nodes.propagateToNextLayer(tree, layers[layer_id - 1].nodes, layers[layer_id - 1].tree_roots, below_outlines, outlines_locator,
+                wall_supporting_radius, wall_supporting_radius, locator_cell_size / 2);
+        layer.nodes.compact(layer.tree_roots);
+    }
+
+    return stack;
+}
+
+// Checks the shape of the trees rather than their exact node positions, which depend on the floating point
+// evaluation of the compiler and platform.
+static void check_lightning_trees(int num_layers, double radius, size_t expected_branches, double expected_length)
+{
+    const LightningTreesStack stack = grow_lightning_trees(num_layers, radius);
+
+    size_t num_branches = 0;
+    size_t num_outside  = 0;
+    double length       = 0.;
+    for (int layer_id = 0; layer_id < num_layers; ++ layer_id) {
+        const FillLightning::Layer &layer = stack.layers[layer_id];
+        const ExPolygons            inside = offset_ex(stack.outlines[layer_id], float(SCALED_EPSILON));
+        Polylines                   branches;
+        for (FillLightning::NodeIdx tree : layer.tree_roots)
+            layer.nodes.visitBranches(tree, [&](const Point &a, const Point &b) {
+                ++ num_branches;
+                length += unscaled<double>((b - a).cast<double>().norm());
+                branches.emplace_back(a, b);
+                for (const Point &pt : { a, b })
+                    if (std::none_of(inside.begin(), inside.end(), [&pt](const ExPolygon &expoly) { return expoly.contains(pt); }))
+                        ++ num_outside;
+            });
+        // The distance field does not sample overhangs narrower than a fraction of the supporting radius.
+        const Polygons overhang = opening(stack.overhangs[layer_id], float(stack.supporting_radius / 12));
+        if (const double overhang_area = area(overhang); overhang_area > 0.) {
+            // New trees are grown from the overhang of this layer.
+            REQUIRE(! layer.tree_roots.empty());
+            const double uncovered_area = area(diff(overhang, offset(branches, float(stack.supporting_radius + SCALED_EPSILON))));
+            CHECK(uncovered_area < 0.2 * overhang_area);
+        }
+    }
+    // Few nodes propagated down to a shrinking outline land outside of it before they are pruned.
+    CHECK(num_outside < num_branches / 100);
+    CHECK(double(num_branches) == Catch::Approx(double(expected_branches)).epsilon(0.02));
+    CHECK(length == Catch::Approx(expected_length).epsilon(0.02));
+}
+
+TEST_CASE("Lightning infill trees support the overhangs", "[Fill]") {
+    // Branch counts and lengths recorded with the former implementation storing the tree nodes as shared pointers.
+    // The polylines are not compared, convertToPolylines() picks the continuing branch with rand().
+    SECTION("short stack") { check_lightning_trees(60, 20., 2886, 4959.3); }
+    SECTION("tall stack") { check_lightning_trees(200, 40., 13177, 21851.9); }
+}
+
+#ifdef TEST_PERFORMANCE
+TEST_CASE("Lightning infill performance on a tall object", "[Fill]") {
+    // The trees grown below the top surface of a tall cylinder are propagated down through all of its layers.
+    DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({
+        { "sparse_infill_pattern", "lightning" },
+        { "sparse_infill_density", "15%" },
+        { "layer_height", 0.2 },
+        { "initial_layer_print_height", 0.2 },
+    });
+
+    Slic3r::Print print;
+    Slic3r::Model model;
+    Slic3r::Test::init_print({ make_cylinder(40., 200.) }, print, model, config);
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+    print.process();
+    auto t_end = std::chrono::high_resolution_clock::now();
+    WARN("Slicing with lightning infill: " << std::chrono::duration_cast<std::chrono::milliseconds>(t_end - t_start).count() << " ms;"
+        << log_memory_info(true));
+
+    REQUIRE(! print.objects().front()->layers().empty());
+}
+#endif // TEST_PERFORMANCE
+
 bool test_if_solid_surface_filled(const ExPolygon& expolygon, double flow_spacing, double angle, double density)
 {
     std::unique_ptr<Slic3r::Fill> filler(Slic3r::Fill::new_from_type("rectilinear"));
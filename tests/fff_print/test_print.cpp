@@ -4,8 +4,12 @@
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
 
+#include "libslic3r/Utils.hpp"
+
 #include "test_data.hpp"
 
+#include <boost/filesystem.hpp>
+
 using namespace Slic3r;
 using namespace Slic3r::Test;
 
@@ -30,6 +34,43 @@ SCENARIO("PrintObject: Perimeter generation", "[PrintObject][.]") {
     }
 }
 
+SCENARIO("Print: Objects exported to the content addressed slicing cache are loaded back", "[Print]") {
+    GIVEN("A cube and a pyramid and an empty cache directory") {
+        const boost::filesystem::path cache_dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("orca_slicing_cache_%%%%-%%%%");
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({ TestMesh::cube_20x20x20, TestMesh::pyramid }, print, model, config);
+        WHEN("The print is processed as the command line does, then exported to the cache") {
+            // Looked up before processing, as the command line does, nothing is cached yet.
+            REQUIRE(print.load_cached_data(cache_dir.string(), true) == CLI_IMPORT_CACHE_NOT_FOUND);
+            print.process();
+            // Print::process() rewrites the filament map in the auto filament map modes.
+            print.update_filament_maps_to_config({ 2 });
+            REQUIRE(print.export_cached_data(cache_dir.string(), false, true) == 0);
+            THEN("A new print of the same model and config finds all of its objects in the cache") {
+                Slic3r::Print cached_print;
+                Slic3r::Model cached_model;
+                Slic3r::Test::init_print({ TestMesh::cube_20x20x20, TestMesh::pyramid }, cached_print, cached_model, config);
+                REQUIRE(cached_print.load_cached_data(cache_dir.string(), true) == 0);
+                REQUIRE(cached_print.objects().size() == print.objects().size());
+                for (size_t i = 0; i < print.objects().size(); ++ i) {
+                    REQUIRE(cached_print.objects()[i]->cache_key() == print.objects()[i]->cache_key());
+                    REQUIRE(cached_print.objects()[i]->layer_count() == print.objects()[i]->layer_count());
+                }
+            }
+            THEN("Changing an option of the walls misses the cache") {
+                config.set_deserialize_strict({ { "wall_loops", 5 } });
+                Slic3r::Print changed_print;
+                Slic3r::Model changed_model;
+                Slic3r::Test::init_print({ TestMesh::cube_20x20x20, TestMesh::pyramid }, changed_print, changed_model, config);
+                REQUIRE(changed_print.load_cached_data(cache_dir.string(), true) == CLI_IMPORT_CACHE_NOT_FOUND);
+            }
+        }
+        boost::filesystem::remove_all(cache_dir);
+    }
+}
+
 SCENARIO("Print: Skirt generation", "[Print][.]") {
     GIVEN("20mm cube and default config") {
         WHEN("Skirts is set to 2 loops")  {
@@ -6,9 +6,148 @@
 
 #include "test_data.hpp"
 
+#include <algorithm>
+
+#include <tbb/global_control.h>
+
 using namespace Slic3r;
 using namespace Slic3r::Test;
 
+SCENARIO("PrintObject: walls are regenerated after an object stops sharing the layers of another object", "[PrintObject]") {
+    GIVEN("Two sliced 20mm cubes") {
+        Slic3r::Print print;
+        Slic3r::Model model;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20, TestMesh::cube_20x20x20}, print, model);
+        print.process();
+        REQUIRE(print.objects().size() == 2);
+        WHEN("The second object shares the layers of the first one, then stops sharing them and the print is processed again") {
+            PrintObject *object = print.get_object(1);
+            object->set_shared_object(print.get_object(0));
+            object->copy_layers_from_shared_object();
+            object->clear_shared_object();
+            print.process();
+            THEN("The resliced object has walls on every layer") {
+                REQUIRE(! object->layers().empty());
+                for (const Layer *layer : object->layers())
+                    REQUIRE(! layer->regions().front()->perimeters.empty());
+            }
+        }
+    }
+}
+
+SCENARIO("PrintObject: editing a layer range modifier regenerates only the walls of its layers", "[PrintObject]") {
+    GIVEN("A sliced 20mm cube with a layer range modifier from 5mm to 10mm") {
+        const DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        auto init = [&config](Slic3r::Print &print, Slic3r::Model &model, int range_wall_loops) {
+            Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+            model.objects.front()->layer_config_ranges[{ 5., 10. }].set("wall_loops", range_wall_loops);
+            print.apply(model, config);
+            print.process();
+        };
+        auto walls = [](const Layer *layer) {
+            Points points;
+            for (const LayerRegion *layerm : layer->regions())
+                for (const Polyline &polyline : layerm->perimeters.as_polylines())
+                    append(points, polyline.points);
+            return points;
+        };
+        auto has_modified_region = [](const Layer *layer) {
+            return std::any_of(layer->regions().begin(), layer->regions().end(), [](const LayerRegion *layerm) {
+                return ! layerm->slices.empty() && layerm->region().config().wall_loops.value == 4;
+            });
+        };
+        Slic3r::Print print;
+        Slic3r::Model model;
+        init(print, model, 3);
+        PrintObject &object = *print.get_object(0);
+        // Mark the walls of every layer by an empty collection, which is dropped only if the walls are generated again.
+        std::vector<size_t> num_walls;
+        for (Layer *layer : object.layers()) {
+            num_walls.emplace_back(layer->regions().front()->perimeters.entities.size());
+            layer->regions().front()->perimeters.append(ExtrusionEntityCollection());
+        }
+        WHEN("The wall loops of the modifier are changed and the print is processed again") {
+            model.objects.front()->layer_config_ranges.begin()->second.set("wall_loops", 4);
+            print.apply(model, config);
+            print.process();
+            THEN("Only the layers containing the modifier get new walls") {
+                REQUIRE(object.layers().size() == num_walls.size());
+                size_t num_regenerated = 0;
+                for (size_t i = 0; i < object.layers().size(); ++ i) {
+                    const Layer *layer = object.layers()[i];
+                    const bool   regenerated = layer->regions().front()->perimeters.entities.size() == num_walls[i];
+                    REQUIRE(regenerated == has_modified_region(layer));
+                    num_regenerated += regenerated;
+                }
+                REQUIRE(num_regenerated > 0);
+                REQUIRE(num_regenerated < object.layers().size());
+            }
+            THEN("The walls are identical to those of the modified object processed from scratch") {
+                Slic3r::Print fresh_print;
+                Slic3r::Model fresh_model;
+                init(fresh_print, fresh_model, 4);
+                const PrintObject &fresh_object = *fresh_print.objects().front();
+                REQUIRE(object.layers().size() == fresh_object.layers().size());
+                for (size_t i = 0; i < object.layers().size(); ++ i)
+                    REQUIRE(walls(object.layers()[i]) == walls(fresh_object.layers()[i]));
+            }
+        }
+    }
+}
+
+SCENARIO("PrintObject: walls of the islands of a layer do not depend on the number of threads", "[PrintObject]") {
+    GIVEN("An object made of a grid of 16 separate cubes and cylinders") {
+        TriangleMesh islands;
+        for (int i = 0; i < 4; ++ i)
+            for (int j = 0; j < 4; ++ j) {
+                TriangleMesh island = (i + j) % 2 ? make_cube(8., 8., 3.) : make_cylinder(4., 3.);
+                island.translate(float(10 * i + ((i + j) % 2 ? 0 : 4)), float(10 * j + ((i + j) % 2 ? 0 : 4)), 0.f);
+                islands.merge(island);
+            }
+        auto walls = [&islands](const char *wall_generator) {
+            DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+            config.set_deserialize_strict({ { "wall_generator", wall_generator }, { "wall_loops", 3 } });
+            Slic3r::Print print;
+            Slic3r::Model model;
+            Slic3r::Test::init_print(std::vector<TriangleMesh>{ islands }, print, model, config);
+            print.process();
+            std::vector<std::pair<Points, double>> out;
+            for (const Layer *layer : print.objects().front()->layers())
+                for (const LayerRegion *layerm : layer->regions()) {
+                    Points points;
+                    for (const Polyline &polyline : layerm->perimeters.as_polylines())
+                        append(points, polyline.points);
+                    for (const Polyline &polyline : layerm->thin_fills.as_polylines())
+                        append(points, polyline.points);
+                    double fill_area = 0;
+                    for (const Surface &surface : layerm->fill_surfaces)
+                        fill_area += surface.expolygon.area();
+                    out.emplace_back(std::move(points), fill_area);
+                }
+            return out;
+        };
+        for (const char *wall_generator : { "classic", "arachne" }) {
+            WHEN(std::string("The walls are generated by the ") + wall_generator + " generator on a single thread and on all threads") {
+                std::vector<std::pair<Points, double>> walls_serial;
+                {
+                    tbb::global_control single_thread(tbb::global_control::max_allowed_parallelism, 1);
+                    walls_serial = walls(wall_generator);
+                }
+                std::vector<std::pair<Points, double>> walls_parallel = walls(wall_generator);
+                THEN("The walls, the gap fill and the fill surfaces are the same") {
+                    REQUIRE(! walls_serial.empty());
+                    REQUIRE(walls_serial.size() == walls_parallel.size());
+                    for (size_t i = 0; i < walls_serial.size(); ++ i) {
+                        REQUIRE(! walls_serial[i].first.empty());
+                        REQUIRE(walls_serial[i].first == walls_parallel[i].first);
+                        REQUIRE(walls_serial[i].second == walls_parallel[i].second);
+                    }
+                }
+            }
+        }
+    }
+}
+
 SCENARIO("PrintObject: object layer heights", "[PrintObject][.]") {
     GIVEN("20mm cube and default initial config, initial layer height of 2mm") {
         WHEN("generate_object_layers() is called for 2mm layer heights and nozzle diameter of 3mm") {
@@ -1,7 +1,12 @@
 #include <catch2/catch_all.hpp>
 
+#include <boost/filesystem.hpp>
+
+#include "libslic3r/BuildVolume.hpp"
 #include "libslic3r/GCodeReader.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Support/TreeModelVolumes.hpp"
+#include "libslic3r/Utils.hpp"
 
 #include "test_data.hpp" // get access to init_print, etc
 
@@ -119,6 +124,80 @@ SCENARIO("SupportMaterial: support_layers_z and contact_distance", "[SupportMate
     }
 }
 
+// Precalculates the areas of the organic tree support of an overhang, returns the collision and the avoidance of the smallest branch.
+static std::vector<Polygons> tree_support_areas(bool area_cache, const std::string &cache_dir)
+{
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({
+        { "enable_support",          true },
+        { "support_type",            "tree(auto)" },
+        { "support_style",           "organic" },
+        { "tree_support_area_cache", area_cache },
+    });
+    Slic3r::Print print;
+    Slic3r::Model model;
+    Slic3r::Test::init_print({ TestMesh::overhang }, print, model, config);
+    print.process();
+
+    const std::string old_temporary_dir = temporary_dir();
+    set_temporary_dir(cache_dir);
+    std::vector<Polygons> out;
+    {
+        const PrintObject                         &object = *print.objects().front();
+        const TreeSupport3D::TreeSupportSettings   settings{ TreeSupport3D::TreeSupportMeshGroupSettings(object), object.slicing_parameters() };
+        const BuildVolume                          build_volume{ { { 0., 0. }, { 200., 0. }, { 200., 200. }, { 0., 200. } }, 200., {}, {} };
+        const TreeSupport3D::LayerIndex            max_layer = TreeSupport3D::LayerIndex(object.layer_count()) - 1;
+        // Destroying the volumes waits for the cache file to be written.
+        TreeSupport3D::TreeModelVolumes volumes(object, build_volume, settings.maximum_move_distance, settings.maximum_move_distance_slow, 0);
+        volumes.precalculate(object, max_layer, []{});
+        const coord_t radius = volumes.ceilRadius(settings.getRadius(0), false);
+        for (TreeSupport3D::LayerIndex layer_idx = 0; layer_idx <= max_layer; ++ layer_idx) {
+            out.emplace_back(volumes.getCollision(0, layer_idx, false));
+            out.emplace_back(volumes.getAvoidance(radius, layer_idx, TreeSupport3D::TreeModelVolumes::AvoidanceType::Fast, false, false));
+        }
+    }
+    set_temporary_dir(old_temporary_dir);
+    return out;
+}
+
+static std::vector<boost::filesystem::path> tree_support_cache_files(const boost::filesystem::path &cache_dir)
+{
+    std::vector<boost::filesystem::path> out;
+    if (boost::filesystem::exists(cache_dir / "tree_support_cache"))
+        for (const auto &entry : boost::filesystem::directory_iterator(cache_dir / "tree_support_cache"))
+            out.emplace_back(entry.path());
+    return out;
+}
+
+TEST_CASE("SupportMaterial: organic tree support areas are reused from the disk cache", "[SupportMaterial]")
+{
+    const boost::filesystem::path cache_dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("orca_tree_support_cache_%%%%-%%%%");
+    boost::filesystem::create_directories(cache_dir);
+
+    const std::vector<Polygons> areas = tree_support_areas(true, cache_dir.string());
+    REQUIRE(! areas.empty());
+    const std::vector<boost::filesystem::path> files = tree_support_cache_files(cache_dir);
+    REQUIRE(files.size() == 1);
+    REQUIRE(files.front().extension() == ".bin");
+
+    SECTION("The areas loaded from the cache match the calculated areas") {
+        REQUIRE(tree_support_areas(true, cache_dir.string()) == areas);
+        REQUIRE(tree_support_cache_files(cache_dir) == files);
+    }
+    SECTION("A truncated cache file is recalculated") {
+        const uintmax_t size = boost::filesystem::file_size(files.front());
+        boost::filesystem::resize_file(files.front(), size - 3);
+        REQUIRE(tree_support_areas(true, cache_dir.string()) == areas);
+        REQUIRE(boost::filesystem::file_size(files.front()) == size);
+    }
+    SECTION("Nothing is stored with the cache disabled") {
+        boost::filesystem::remove_all(cache_dir / "tree_support_cache");
+        REQUIRE(tree_support_areas(false, cache_dir.string()) == areas);
+        REQUIRE(tree_support_cache_files(cache_dir).empty());
+    }
+    boost::filesystem::remove_all(cache_dir);
+}
+
 #if 0
 // Test 8.
 TEST_CASE("SupportMaterial: forced support is generated", "[SupportMaterial]")
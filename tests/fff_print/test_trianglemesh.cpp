@@ -326,6 +326,30 @@ TEST_CASE("Regression test for issue #4486 - files take forever to slice") {
     REQUIRE(timedout == false);
 
 }
+
+TEST_CASE("Slicing performance of a mesh with millions of triangles") {
+    // About 5M triangles.
+    indexed_triangle_set its = its_make_sphere(50., 2. * PI / 2240.);
+    std::vector<float> zs;
+    for (float z = -49.9f; z < 50.f; z += 0.05f)
+        zs.emplace_back(z);
+    MeshSlicingParams params;
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+    std::vector<Polygons> layers = slice_mesh(its, zs, params);
+    auto t_end = std::chrono::high_resolution_clock::now();
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t_end - t_start).count();
+    WARN("Slicing " << its.indices.size() << " triangles at " << zs.size() << " layers: " << ms << " ms");
+
+    // Every 50th plane is sliced again on its own by the single plane slice_mesh(), which tests every facet.
+    REQUIRE(layers.size() == zs.size());
+    for (size_t i = 0; i < zs.size(); i += 50) {
+        Polygons reference = slice_mesh(its, zs[i], params);
+        REQUIRE(layers[i].size() == 1);
+        REQUIRE(reference.size() == 1);
+        REQUIRE(layers[i].front().area() == Catch::Approx(reference.front().area()));
+    }
+}
 #endif // TEST_PERFORMANCE
 
 #ifdef BUILD_PROFILE
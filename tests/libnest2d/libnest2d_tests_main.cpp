@@ -1,5 +1,6 @@
 #include <catch2/catch_all.hpp>
 
+#include <chrono>
 #include <fstream>
 #include <cstdint>
 
@@ -1225,3 +1226,95 @@ TEST_CASE("Test for biggest bounding box area", "[Nesting][NestKernels][.]")
     REQUIRE(pile.size() == N);
     REQUIRE(bb.area() == double(N) * N * W * W);
 }
+
+TEST_CASE("Cached nfps should give the same arrangement", "[Nesting][NestKernels]")
+{
+    // Copies of the same parts, more than fit into one bin
+    std::vector<Item> parts = prusaParts();
+    std::vector<Item> input;
+    for (size_t i = 0; i < 4; ++i)
+        input.insert(input.end(), parts.begin(), parts.begin() + 10);
+
+    std::vector<Item> input_cached = input;
+
+    auto bin = Box(100000000, 100000000);
+
+    NfpPlacer::Config pconfig;
+    pconfig.rotations = {0., Pi / 2.};
+    size_t bins = nest(input, bin, 0, NestConfig{pconfig});
+
+    pconfig.nfp_cache = std::make_shared<placers::NfpCache<PolygonImpl>>();
+    size_t bins_cached = nest(input_cached, bin, 0, NestConfig{pconfig});
+
+    REQUIRE(bins > 1);
+    REQUIRE(bins_cached == bins);
+    REQUIRE(pconfig.nfp_cache->hits() > 0);
+
+    for (size_t i = 0; i < input.size(); ++i) {
+        REQUIRE(input_cached[i].binId() == input[i].binId());
+        REQUIRE(double(input_cached[i].rotation()) == double(input[i].rotation()));
+        REQUIRE(getX(input_cached[i].translation()) == getX(input[i].translation()));
+        REQUIRE(getY(input_cached[i].translation()) == getY(input[i].translation()));
+    }
+}
+
+TEST_CASE("Nfp cache matches the shapes, not only their hashes", "[Nesting][NestKernels]")
+{
+    placers::NfpCache<PolygonImpl> cache;
+    RectangleItem stationary(1000, 1000);
+    RectangleItem orbiter(500, 200);
+    stationary.translation({2000, 3000});
+    const PolygonImpl nfp = RectangleItem(1500, 1200).rawShape();
+    cache.insert(stationary, orbiter, nfp);
+
+    // A copy of the same shapes at another position finds the nfp moved along with the stationary item
+    RectangleItem stationary_copy(1000, 1000);
+    RectangleItem orbiter_copy(500, 200);
+    PolygonImpl found;
+    REQUIRE(cache.find(stationary_copy, orbiter_copy, found));
+    REQUIRE(sl::area(found) == Catch::Approx(sl::area(nfp)));
+    REQUIRE(getX(sl::boundingBox(found).minCorner()) == getX(sl::boundingBox(nfp).minCorner()) - 2000);
+    REQUIRE(getY(sl::boundingBox(found).minCorner()) == getY(sl::boundingBox(nfp).minCorner()) - 3000);
+
+    // Different shape, inflation or rotation of the orbiter
+    RectangleItem other(200, 500);
+    REQUIRE(! cache.find(stationary, other, found));
+    RectangleItem inflated(500, 200);
+    inflated.inflation(10);
+    REQUIRE(! cache.find(stationary, inflated, found));
+    RectangleItem rotated(500, 200);
+    rotated.rotation(Pi / 2.);
+    REQUIRE(! cache.find(stationary, rotated, found));
+    REQUIRE(cache.hits() == 1);
+}
+
+#ifdef TEST_PERFORMANCE
+TEST_CASE("Nfp cache performance", "[Nesting][NestKernels]")
+{
+    std::vector<Item> parts = prusaParts();
+    std::vector<Item> input;
+    for (size_t i = 0; i < 3; ++i)
+        input.insert(input.end(), parts.begin(), parts.end());
+
+    auto bin = Box(250000000, 210000000);
+
+    auto benchmark = [&](bool cached) {
+        std::vector<Item> items = input;
+        NfpPlacer::Config pconfig;
+        if (cached)
+            pconfig.nfp_cache = std::make_shared<placers::NfpCache<PolygonImpl>>();
+
+        auto t_start = std::chrono::high_resolution_clock::now();
+        size_t bins = nest(items, bin, 0, NestConfig{pconfig});
+        auto t_end = std::chrono::high_resolution_clock::now();
+        const double time_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+        const size_t hits = cached ? pconfig.nfp_cache->hits() : 0;
+        WARN("Arranging " << items.size() << " parts into " << bins << " bins" << (cached ? " with nfp cache: " : ": ")
+             << time_ms << " ms, " << hits << " cache hits");
+        REQUIRE(bins > 0);
+    };
+
+    benchmark(false);
+    benchmark(true);
+}
+#endif // TEST_PERFORMANCE
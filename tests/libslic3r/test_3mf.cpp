@@ -1,10 +1,15 @@
 
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/3mf.hpp"
+#include "libslic3r/Format/bbs_3mf.hpp"
 #include "libslic3r/Format/STL.hpp"
+#include "libslic3r/miniz_extension.hpp"
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem/operations.hpp>
 
+#include <tbb/global_control.h>
+
 #include <catch2/catch_tostring.hpp>
 #include <Eigen/Core>
 #include <Eigen/Geometry>
@@ -193,3 +198,129 @@ SCENARIO("2D convex hull of sinking object", "[3mf][.]") {
         }
     }
 }
+
+static bool store_bbs_3mf_to(const std::string &path, Model &model, SaveStrategy strategy)
+{
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    StoreParams        store_params;
+    store_params.path     = path.c_str();
+    store_params.model    = &model;
+    store_params.config   = &config;
+    store_params.strategy = strategy | SaveStrategy::Silence;
+    return store_bbs_3mf(store_params);
+}
+
+SCENARIO("Export+Import of a painted mesh to/from a Bambu 3mf file", "[3mf]") {
+    GIVEN("a sphere with painted supports, seams and colors") {
+        Model src_model;
+        ModelObject *src_object = src_model.add_object("sphere", "", TriangleMesh(its_make_sphere(10., 2. * PI / 60.)));
+        src_object->add_instance();
+        ModelVolume *src_volume = src_object->volumes.front();
+        const int    num_triangles = int(src_volume->mesh().its.indices.size());
+        // Unsplit triangles: "4" is state 1, "8" is state 2, "C" is a state above 2 stored in the following nibble.
+        for (int i = 0; i < num_triangles; i += 7) {
+            src_volume->supported_facets.set_triangle_from_string(i, "4");
+            src_volume->seam_facets.set_triangle_from_string(i, "8");
+            src_volume->mmu_segmentation_facets.set_triangle_from_string(i, "1C");
+        }
+
+        for (bool split_model : { false, true }) {
+            WHEN(split_model ? "saved and loaded with a model file per object" : "saved and loaded as a single model file") {
+                SaveStrategy strategy = split_model ? SaveStrategy::Zip64 | SaveStrategy::SplitModel : SaveStrategy::Zip64;
+                boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("painted-%%%%-%%%%.3mf");
+                REQUIRE(store_bbs_3mf_to(path.string(), src_model, strategy));
+
+                Model                      dst_model;
+                DynamicPrintConfig         dst_config;
+                ConfigSubstitutionContext  ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                PlateDataPtrs              plate_data;
+                std::vector<Preset*>       project_presets;
+                bool                       is_bbl_3mf = false;
+                bool                       is_orca_3mf = false;
+                Semver                     file_version;
+                bool loaded = load_bbs_3mf(path.string().c_str(), &dst_config, &ctxt, &dst_model, &plate_data, &project_presets,
+                    &is_bbl_3mf, &is_orca_3mf, &file_version, nullptr, LoadStrategy::LoadModel);
+                release_PlateData_list(plate_data);
+                boost::filesystem::remove(path);
+
+                THEN("the mesh and the paint of every triangle are loaded back") {
+                    REQUIRE(loaded);
+                    REQUIRE(dst_model.objects.size() == 1);
+                    REQUIRE(dst_model.objects.front()->volumes.size() == 1);
+                    const ModelVolume &dst_volume = *dst_model.objects.front()->volumes.front();
+                    REQUIRE(int(dst_volume.mesh().its.indices.size()) == num_triangles);
+                    TriangleMesh src_mesh = src_model.mesh();
+                    TriangleMesh dst_mesh = dst_model.mesh();
+                    REQUIRE(dst_mesh.its.vertices.size() == src_mesh.its.vertices.size());
+                    for (size_t i = 0; i < src_mesh.its.vertices.size(); ++ i)
+                        REQUIRE(dst_mesh.its.vertices[i].isApprox(src_mesh.its.vertices[i]));
+                    REQUIRE(dst_mesh.its.indices == src_mesh.its.indices);
+                    for (int i = 0; i < num_triangles; ++ i) {
+                        REQUIRE(dst_volume.supported_facets.get_triangle_as_string(i) == src_volume->supported_facets.get_triangle_as_string(i));
+                        REQUIRE(dst_volume.seam_facets.get_triangle_as_string(i) == src_volume->seam_facets.get_triangle_as_string(i));
+                        REQUIRE(dst_volume.mmu_segmentation_facets.get_triangle_as_string(i) == src_volume->mmu_segmentation_facets.get_triangle_as_string(i));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Names of the entries of a zip archive in their order, and the uncompressed content of the object model files.
+static std::vector<std::pair<std::string, std::string>> zip_entries(const std::string &path)
+{
+    std::vector<std::pair<std::string, std::string>> out;
+    mz_zip_archive archive;
+    mz_zip_zero_struct(&archive);
+    if (! open_zip_reader(&archive, path))
+        return out;
+    for (mz_uint i = 0; i < mz_zip_reader_get_num_files(&archive); ++ i) {
+        mz_zip_archive_file_stat stat;
+        if (! mz_zip_reader_file_stat(&archive, i, &stat))
+            break;
+        std::string name = stat.m_filename;
+        std::string data;
+        if (boost::starts_with(name, "3D/Objects/")) {
+            data.assign(size_t(stat.m_uncomp_size), 0);
+            if (! mz_zip_reader_extract_to_mem(&archive, i, data.data(), data.size(), 0))
+                data.clear();
+        }
+        out.emplace_back(std::move(name), std::move(data));
+    }
+    close_zip_reader(&archive);
+    return out;
+}
+
+SCENARIO("Bambu 3mf export of a model file per object does not depend on the thread count", "[3mf]") {
+    GIVEN("a model of a dozen different objects") {
+        Model model;
+        for (int i = 0; i < 12; ++ i) {
+            ModelObject *object = model.add_object(("object" + std::to_string(i)).c_str(), "",
+                TriangleMesh(i % 2 ? its_make_sphere(5. + i, 2. * PI / (20. + 4 * i)) : its_make_cube(5. + i, 10., 5. + 2 * i)));
+            object->add_instance()->set_offset(Vec3d(30. * i, 0., 0.));
+        }
+
+        WHEN("saved on a single thread and on all threads") {
+            boost::filesystem::path path_serial   = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("serial-%%%%-%%%%.3mf");
+            boost::filesystem::path path_parallel = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("parallel-%%%%-%%%%.3mf");
+            bool stored_serial;
+            {
+                tbb::global_control single_thread(tbb::global_control::max_allowed_parallelism, 1);
+                stored_serial = store_bbs_3mf_to(path_serial.string(), model, SaveStrategy::Zip64 | SaveStrategy::SplitModel);
+            }
+            bool stored_parallel = store_bbs_3mf_to(path_parallel.string(), model, SaveStrategy::Zip64 | SaveStrategy::SplitModel);
+            std::vector<std::pair<std::string, std::string>> entries_serial   = zip_entries(path_serial.string());
+            std::vector<std::pair<std::string, std::string>> entries_parallel = zip_entries(path_parallel.string());
+            boost::filesystem::remove(path_serial);
+            boost::filesystem::remove(path_parallel);
+
+            THEN("the entries are stored in the same order with the same object model files") {
+                REQUIRE(stored_serial);
+                REQUIRE(stored_parallel);
+                REQUIRE(std::count_if(entries_serial.begin(), entries_serial.end(),
+                    [](const std::pair<std::string, std::string> &entry) { return ! entry.second.empty(); }) == 12);
+                REQUIRE(entries_serial == entries_parallel);
+            }
+        }
+    }
+}
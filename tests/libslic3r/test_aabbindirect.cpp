@@ -4,6 +4,10 @@
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
 
+#include <array>
+#include <chrono>
+#include <random>
+
 using namespace Slic3r;
 
 TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndirect]")
@@ -58,3 +62,125 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.y() == Catch::Approx(0.5));
     REQUIRE(closest_point.z() == Catch::Approx(1.));
 }
+
+// Rays from points just above the surface of a mesh into the hemisphere around the surface normal,
+// shaped like the rays casted by SeamPlacer to estimate visibility.
+static void hemisphere_rays(const indexed_triangle_set &its, size_t num_samples, std::vector<Vec3f> &origins, std::vector<Vec3f> &dirs)
+{
+    std::mt19937 rng(5489u);
+    std::uniform_int_distribution<size_t> face_dist(0, its.indices.size() - 1);
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+    for (size_t i = 0; i < num_samples; ++ i) {
+        const stl_triangle_vertex_indices &face = its.indices[face_dist(rng)];
+        const Vec3f center = (its.vertices[face(0)] + its.vertices[face(1)] + its.vertices[face(2)]) / 3.f;
+        const Vec3f normal = its_face_normal(its, face);
+        for (;;) {
+            Vec3f dir(2.f * dist(rng) - 1.f, 2.f * dist(rng) - 1.f, 2.f * dist(rng) - 1.f);
+            if (float l = dir.norm(); l > 0.1f && l < 1.f) {
+                origins.emplace_back(center + normal * 0.01f);
+                dirs.emplace_back((dir.dot(normal) < 0 ? -dir : dir) / l);
+                break;
+            }
+        }
+    }
+}
+
+TEST_CASE("Ray packets hit the same triangles as single rays", "[AABBIndirect]")
+{
+    // A cube pierced by a cylinder, the two meshes occlude each other.
+    TriangleMesh tmesh = make_cube(20., 20., 20.);
+    tmesh.merge(TriangleMesh(its_make_cylinder(5., 30.)));
+    const indexed_triangle_set &its = tmesh.its;
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+
+    std::vector<Vec3f> origins;
+    std::vector<Vec3f> dirs;
+    hemisphere_rays(its, 1000, origins, dirs);
+    // Grazing rays aimed at the mesh vertices from afar, where the ray-box tests are the least accurate.
+    std::mt19937 rng(5489u);
+    std::uniform_real_distribution<float> dist(-500.f, 500.f);
+    for (size_t i = 0; i < 1000; ++ i) {
+        origins.emplace_back(dist(rng), dist(rng), dist(rng));
+        dirs.emplace_back((its.vertices[rng() % its.vertices.size()] - origins.back()).normalized());
+    }
+    // Include rays missing the mesh and rays parallel to the coordinate planes.
+    origins.emplace_back(-10.f, -10.f, -10.f);
+    dirs.emplace_back(-1.f, 0.f, 0.f);
+    origins.emplace_back(5.f, 5.f, -10.f);
+    dirs.emplace_back(0.f, 0.f, 1.f);
+
+    static constexpr size_t packet_size = 8;
+    // Last packet is partially filled.
+    for (size_t first = 0; first < origins.size(); first += packet_size) {
+        const size_t num_rays = std::min(packet_size, origins.size() - first);
+        std::array<igl::Hit, packet_size> hits;
+        uint32_t hit_mask = AABBTreeIndirect::intersect_ray_packet_first_hit<packet_size>(its.vertices, its.indices, tree,
+            origins.data() + first, dirs.data() + first, num_rays, hits.data());
+        std::array<std::vector<igl::Hit>, packet_size> all_hits;
+        uint32_t all_hits_mask = AABBTreeIndirect::intersect_ray_packet_all_hits<packet_size>(its.vertices, its.indices, tree,
+            origins.data() + first, dirs.data() + first, num_rays, all_hits.data());
+        REQUIRE(hit_mask == all_hits_mask);
+        for (size_t i = 0; i < num_rays; ++ i) {
+            igl::Hit hit;
+            bool     intersected = AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices, tree,
+                origins[first + i].cast<double>().eval(), dirs[first + i].cast<double>().eval(), hit);
+            std::vector<igl::Hit> hits_single;
+            AABBTreeIndirect::intersect_ray_all_hits(its.vertices, its.indices, tree,
+                origins[first + i].cast<double>().eval(), dirs[first + i].cast<double>().eval(), hits_single);
+            // The ray-box tests of the packets are calculated in single precision, but conservatively.
+            REQUIRE(intersected == bool(hit_mask & (uint32_t(1) << i)));
+            REQUIRE(hits_single.size() == all_hits[i].size());
+            if (intersected) {
+                // Hits at an edge shared by two triangles may report either triangle.
+                REQUIRE(hits[i].t == Catch::Approx(hit.t));
+                REQUIRE(all_hits[i].front().t == Catch::Approx(hit.t));
+            } else
+                REQUIRE(hits[i].id == -1);
+        }
+    }
+}
+
+#ifdef TEST_PERFORMANCE
+TEST_CASE("Ray casting performance, single rays vs. ray packets", "[AABBIndirect]")
+{
+    // About 1M triangles.
+    indexed_triangle_set its = its_make_sphere(50., 2. * PI / 1000.);
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+    std::vector<Vec3f> origins;
+    std::vector<Vec3f> dirs;
+    hemisphere_rays(its, 200000, origins, dirs);
+    // Group rays sharing an origin like SeamPlacer does.
+    for (size_t i = 0; i + 4 <= origins.size(); i += 4)
+        std::fill(origins.begin() + i + 1, origins.begin() + i + 4, origins[i]);
+
+    auto report = [&origins](const char *name, auto t_start, size_t num_hits) {
+        auto t_end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(t_end - t_start).count();
+        WARN(name << ": " << origins.size() / seconds * 1e-6 << " Mrays/s, " << num_hits << " hits");
+    };
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+    size_t num_hits = 0;
+    for (size_t i = 0; i < origins.size(); ++ i) {
+        igl::Hit hit;
+        num_hits += AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices, tree, origins[i].cast<double>().eval(), dirs[i].cast<double>().eval(), hit);
+    }
+    report("intersect_ray_first_hit", t_start, num_hits);
+
+    auto bench_packets = [&](auto packet_size_tag) {
+        static constexpr size_t packet_size = decltype(packet_size_tag)::value;
+        auto   t_start  = std::chrono::high_resolution_clock::now();
+        size_t num_hits = 0;
+        std::array<igl::Hit, packet_size> hits;
+        for (size_t first = 0; first < origins.size(); first += packet_size) {
+            uint32_t mask = AABBTreeIndirect::intersect_ray_packet_first_hit<packet_size>(its.vertices, its.indices, tree,
+                origins.data() + first, dirs.data() + first, std::min(packet_size, origins.size() - first), hits.data());
+            for (; mask; mask &= mask - 1)
+                ++ num_hits;
+        }
+        report(packet_size == 4 ? "intersect_ray_packet_first_hit<4>" : "intersect_ray_packet_first_hit<8>", t_start, num_hits);
+    };
+    bench_packets(std::integral_constant<size_t, 4>());
+    bench_packets(std::integral_constant<size_t, 8>());
+}
+#endif // TEST_PERFORMANCE
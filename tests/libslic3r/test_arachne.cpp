@@ -0,0 +1,112 @@
+#include <catch2/catch_all.hpp>
+#include "test_utils.hpp"
+
+#include <libslic3r/Arachne/WallToolPaths.hpp>
+#include <libslic3r/ClipperUtils.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Slic3r;
+using namespace Slic3r::Arachne;
+
+static WallToolPathsParams make_params()
+{
+    WallToolPathsParams params;
+    params.min_bead_width                   = 0.34f;
+    params.min_feature_size                 = 0.1f;
+    params.min_length_factor                = 0.5f;
+    params.wall_transition_length           = 0.4f;
+    params.wall_transition_angle            = 10.f;
+    params.wall_transition_filter_deviation = 0.1f;
+    params.wall_distribution_count          = 1;
+    params.is_top_or_bottom_layer           = false;
+    return params;
+}
+
+// A square plate with a round hole, as a cross-section of a prismatic part.
+static Polygons make_part(const Point &offset)
+{
+    Polygon contour = Polygon::new_scale({ {0., 0.}, {20., 0.}, {20., 20.}, {0., 20.} });
+    Polygon hole;
+    for (size_t i = 0; i < 64; ++ i) {
+        double angle = - 2. * PI * double(i) / 64.;
+        hole.points.emplace_back(Point::new_scale(10. + 4. * cos(angle), 10. + 4. * sin(angle)));
+    }
+    Polygons out { contour, hole };
+    for (Polygon &polygon : out)
+        polygon.translate(offset);
+    return out;
+}
+
+static std::vector<VariableWidthLines> generate(const Polygons &outline, const WallToolPathsParams &params, Polygons *inner_contour = nullptr)
+{
+    WallToolPaths wall_tool_paths(outline, scaled<coord_t>(0.4), scaled<coord_t>(0.45), 3, 0, 0.2, params);
+    std::vector<VariableWidthLines> out = wall_tool_paths.getToolPaths();
+    if (inner_contour)
+        *inner_contour = wall_tool_paths.getInnerContour();
+    return out;
+}
+
+TEST_CASE("Arachne toolpaths of a translated island are reused from the cache", "[Arachne]")
+{
+    WallToolPathsCache  cache;
+    WallToolPathsParams params = make_params();
+    params.cache = &cache;
+
+    const Point offset   = Point::new_scale(35., -12.);
+    Polygons    outline1 = make_part(Point(0, 0));
+    Polygons    outline2 = make_part(offset);
+
+    Polygons inner1, inner2;
+    std::vector<VariableWidthLines> paths1 = generate(outline1, params, &inner1);
+    std::vector<VariableWidthLines> paths2 = generate(outline2, params, &inner2);
+    REQUIRE(! paths1.empty());
+
+    WallToolPathsCache::Statistics stats = cache.statistics();
+    REQUIRE(stats.lookups == 2);
+    REQUIRE(stats.hits == 1);
+
+    REQUIRE(paths1.size() == paths2.size());
+    for (size_t i = 0; i < paths1.size(); ++ i) {
+        REQUIRE(paths1[i].size() == paths2[i].size());
+        for (size_t j = 0; j < paths1[i].size(); ++ j) {
+            REQUIRE(paths1[i][j].junctions.size() == paths2[i][j].junctions.size());
+            for (size_t k = 0; k < paths1[i][j].junctions.size(); ++ k) {
+                REQUIRE(paths1[i][j].junctions[k].p + offset == paths2[i][j].junctions[k].p);
+                REQUIRE(paths1[i][j].junctions[k].w == paths2[i][j].junctions[k].w);
+            }
+        }
+    }
+    REQUIRE(inner1.size() == inner2.size());
+    REQUIRE(area(inner1) == Catch::Approx(area(inner2)));
+
+    SECTION("A cache miss returns the same toolpaths as a hit") {
+        WallToolPathsCache  empty_cache;
+        WallToolPathsParams params_empty = params;
+        params_empty.cache = &empty_cache;
+        std::vector<VariableWidthLines> paths3 = generate(outline2, params_empty);
+        REQUIRE(empty_cache.statistics().hits == 0);
+        REQUIRE(paths3.size() == paths2.size());
+        for (size_t i = 0; i < paths2.size(); ++ i) {
+            REQUIRE(paths3[i].size() == paths2[i].size());
+            for (size_t j = 0; j < paths2[i].size(); ++ j)
+                REQUIRE(paths3[i][j].junctions == paths2[i][j].junctions);
+        }
+    }
+
+    SECTION("An outline starting at another point is not shared") {
+        // Another starting point produces other toolpaths, the point order is a part of the key.
+        Polygons outline3 = outline1;
+        std::rotate(outline3.front().points.begin(), outline3.front().points.begin() + 2, outline3.front().points.end());
+        generate(outline3, params);
+        REQUIRE(cache.statistics().hits == 1);
+    }
+
+    SECTION("Different parameters are not shared") {
+        WallToolPathsParams params_top = params;
+        params_top.is_top_or_bottom_layer = true;
+        generate(outline1, params_top);
+        REQUIRE(cache.statistics().hits == 1);
+    }
+}
@@ -0,0 +1,178 @@
+#include <catch2/catch_all.hpp>
+
+#include <libslic3r/Arrange.hpp>
+#include <libslic3r/Geometry/ConvexHull.hpp>
+#include <libslic3r/Print.hpp>
+
+#include "../libnest2d/printer_parts.hpp"
+
+#include <chrono>
+#include <map>
+
+using namespace Slic3r;
+using namespace Slic3r::arrangement;
+
+static ArrangePolygons printer_parts(size_t count)
+{
+    ArrangePolygons items;
+    items.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        ArrangePolygon ap;
+        ap.poly.contour = Geometry::convex_hull(PRINTER_PART_POLYGONS[i % PRINTER_PART_POLYGONS.size()].points);
+        ap.itemid       = int(i);
+        items.emplace_back(std::move(ap));
+    }
+    return items;
+}
+
+static bool overlaps(const BoundingBox &a, const BoundingBox &b)
+{
+    return a.min.x() < b.max.x() && b.min.x() < a.max.x() && a.min.y() < b.max.y() && b.min.y() < a.max.y();
+}
+
+static const BoundingBox test_bed{Point::new_scale(0., 0.), Point::new_scale(250., 210.)};
+
+TEST_CASE("Shelf arrange packs many items without overlaps", "[Arrange]")
+{
+    ArrangePolygons items = printer_parts(300);
+
+    ArrangeParams params;
+    params.strategy        = ArrangeStrategy::Shelf;
+    params.allow_rotations = true;
+    params.progressind     = {};
+    arrange(items, test_bed, params);
+
+    std::map<int, std::vector<BoundingBox>> beds;
+    for (const ArrangePolygon &ap : items) {
+        REQUIRE(ap.is_arranged());
+        BoundingBox bb = get_extents(ap.transformed_poly());
+        REQUIRE(test_bed.contains(bb.min));
+        REQUIRE(test_bed.contains(bb.max));
+        beds[ap.bed_idx].emplace_back(bb);
+    }
+
+    REQUIRE(beds.size() > 1);
+    for (const auto &[bed_idx, bbs] : beds)
+        for (size_t i = 0; i < bbs.size(); ++i)
+            for (size_t j = i + 1; j < bbs.size(); ++j)
+                REQUIRE(!overlaps(bbs[i], bbs[j]));
+}
+
+TEST_CASE("Shelf arrange avoids the fixed items", "[Arrange]")
+{
+    ArrangePolygons items = printer_parts(50);
+
+    ArrangePolygon fixed;
+    fixed.poly.contour = Polygon::new_scale({{0., 0.}, {100., 0.}, {100., 100.}, {0., 100.}});
+    fixed.translation  = Point::new_scale(75., 55.);
+    fixed.bed_idx      = 0;
+    BoundingBox fixed_bb = get_extents(fixed.transformed_poly());
+
+    ArrangeParams params;
+    params.strategy    = ArrangeStrategy::Shelf;
+    params.progressind = {};
+    arrange(items, {fixed}, test_bed, params);
+
+    for (const ArrangePolygon &ap : items) {
+        REQUIRE(ap.is_arranged());
+        if (ap.bed_idx == 0)
+            REQUIRE(!overlaps(get_extents(ap.transformed_poly()), fixed_bb));
+    }
+}
+
+TEST_CASE("Refined shelf arrange keeps the beds of the shelves", "[Arrange]")
+{
+    ArrangePolygons items = printer_parts(40);
+
+    ArrangeParams params;
+    params.strategy    = ArrangeStrategy::Shelf;
+    params.progressind = {};
+
+    ArrangePolygons shelf = items;
+    arrange(shelf, test_bed, params);
+
+    params.strategy = ArrangeStrategy::ShelfRefined;
+    arrange(items, test_bed, params);
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        REQUIRE(items[i].bed_idx == shelf[i].bed_idx);
+        BoundingBox bb = get_extents(items[i].transformed_poly());
+        REQUIRE(test_bed.contains(bb.min));
+        REQUIRE(test_bed.contains(bb.max));
+    }
+}
+
+TEST_CASE("Shelf arrange does not mix incompatible filaments on a bed", "[Arrange]")
+{
+    for (ArrangeStrategy strategy : {ArrangeStrategy::Shelf, ArrangeStrategy::ShelfRefined}) {
+        ArrangePolygons items = printer_parts(60);
+        for (size_t i = 0; i < items.size(); ++i)
+            items[i].filament_temp_type = i % 3 == 0 ? FilamentTempType::HighTemp :
+                                          i % 3 == 1 ? FilamentTempType::LowTemp : FilamentTempType::HighLowCompatible;
+
+        // A low temperature object already occupies the first bed.
+        ArrangePolygon fixed;
+        fixed.poly.contour       = Polygon::new_scale({{0., 0.}, {20., 0.}, {20., 20.}, {0., 20.}});
+        fixed.bed_idx            = 0;
+        fixed.filament_temp_type = FilamentTempType::LowTemp;
+
+        ArrangeParams params;
+        params.strategy    = strategy;
+        params.progressind = {};
+        arrange(items, {fixed}, test_bed, params);
+
+        std::map<int, std::vector<int>> temp_types{{0, {FilamentTempType::LowTemp}}};
+        for (const ArrangePolygon &ap : items) {
+            REQUIRE(ap.is_arranged());
+            temp_types[ap.bed_idx].emplace_back(ap.filament_temp_type);
+        }
+        for (const auto &[bed_idx, types] : temp_types)
+            REQUIRE(Print::is_filaments_compatible(types));
+    }
+}
+
+TEST_CASE("Shelf arrange falls back to the nfp placer for sequential printing", "[Arrange]")
+{
+    ArrangePolygons items = printer_parts(8);
+    for (ArrangePolygon &ap : items)
+        ap.height = 10.;
+
+    ArrangeParams params;
+    params.is_seq_print = true;
+    params.progressind  = {};
+
+    ArrangePolygons nfp = items;
+    arrange(nfp, test_bed, params);
+
+    params.strategy = ArrangeStrategy::Shelf;
+    arrange(items, test_bed, params);
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        REQUIRE(items[i].bed_idx == nfp[i].bed_idx);
+        REQUIRE(items[i].translation == nfp[i].translation);
+        REQUIRE(items[i].rotation == Catch::Approx(nfp[i].rotation));
+    }
+}
+
+#ifdef TEST_PERFORMANCE
+TEST_CASE("Shelf arrange performance", "[Arrange]")
+{
+    for (ArrangeStrategy strategy : {ArrangeStrategy::Nfp, ArrangeStrategy::Shelf, ArrangeStrategy::ShelfRefined}) {
+        ArrangePolygons items = printer_parts(200);
+
+        ArrangeParams params;
+        params.strategy    = strategy;
+        params.progressind = {};
+
+        auto t_start = std::chrono::high_resolution_clock::now();
+        arrange(items, test_bed, params);
+        auto t_end = std::chrono::high_resolution_clock::now();
+        const double time_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+
+        int beds = 0;
+        for (const ArrangePolygon &ap : items)
+            beds = std::max(beds, ap.bed_idx + 1);
+        WARN("Arranging " << items.size() << " parts with strategy " << int(strategy) << " onto " << beds << " beds: " << time_ms << " ms");
+    }
+}
+#endif // TEST_PERFORMANCE
@@ -0,0 +1,86 @@
+#include <catch2/catch_all.hpp>
+#include "test_utils.hpp"
+
+#include <libslic3r/GCode/ConflictChecker.hpp>
+
+#include <chrono>
+#include <set>
+
+using namespace Slic3r;
+
+// Zig-zag lines filling a size x size square at (x, y), as one layer of an object would be printed.
+static void add_object_lines(LineWithIDs &lines, const void *id, double x, double y, double size, double spacing)
+{
+    for (double dy = 0.; dy + spacing <= size; dy += spacing) {
+        Point a = Point::new_scale(x, y + dy);
+        Point b = Point::new_scale(x + size, y + dy + spacing);
+        lines.emplace_back(Line(a, b), id, ExtrusionRole::erInternalInfill);
+        lines.emplace_back(Line(b, Point::new_scale(x, y + dy + spacing)), id, ExtrusionRole::erInternalInfill);
+    }
+}
+
+// A plate of columns x rows objects spaced by gap, the first object is shifted by offset into its neighbour.
+static LineWithIDs make_plate(std::vector<int> &ids, int columns, int rows, double size, double gap, double offset, double spacing)
+{
+    LineWithIDs lines;
+    ids.assign(columns * rows, 0);
+    for (int r = 0; r < rows; ++ r)
+        for (int c = 0; c < columns; ++ c) {
+            int idx = r * columns + c;
+            add_object_lines(lines, &ids[idx], c * (size + gap) + (idx == 0 ? offset : 0.), r * (size + gap), size, spacing);
+        }
+    return lines;
+}
+
+static bool brute_force_conflict(const LineWithIDs &lines)
+{
+    for (size_t i = 0; i < lines.size(); ++ i)
+        for (size_t j = i + 1; j < lines.size(); ++ j)
+            if (ConflictChecker::line_intersect(lines[i], lines[j]).has_value())
+                return true;
+    return false;
+}
+
+TEST_CASE("Conflicts between objects on a single layer", "[ConflictChecker]")
+{
+    std::vector<int> ids;
+
+    SECTION("Separated objects do not conflict") {
+        LineWithIDs lines = make_plate(ids, 8, 5, 20., 2., 0., 2.);
+        REQUIRE(! brute_force_conflict(lines));
+        REQUIRE(! ConflictChecker::find_inter_of_lines(lines).has_value());
+    }
+
+    SECTION("Overlapping objects conflict") {
+        LineWithIDs lines = make_plate(ids, 8, 5, 20., 2., 5., 2.);
+        REQUIRE(brute_force_conflict(lines));
+        ConflictComputeOpt conflict = ConflictChecker::find_inter_of_lines(lines);
+        REQUIRE(conflict.has_value());
+        std::set<const void*> objs { conflict->_obj1, conflict->_obj2 };
+        REQUIRE(objs == std::set<const void*>{ &ids[0], &ids[1] });
+    }
+
+    SECTION("Lines of a single object never conflict") {
+        LineWithIDs lines = make_plate(ids, 1, 1, 20., 2., 0., 2.);
+        REQUIRE(! ConflictChecker::find_inter_of_lines(lines).has_value());
+    }
+}
+
+#ifdef TEST_PERFORMANCE
+TEST_CASE("Conflict checking performance on a 40 object plate", "[ConflictChecker]")
+{
+    std::vector<int> ids;
+    // 8 x 5 objects, about 40k lines per layer.
+    LineWithIDs lines = make_plate(ids, 8, 5, 25., 1., 0., 0.05);
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+    size_t num_conflicts = 0;
+    for (int layer = 0; layer < 20; ++ layer)
+        num_conflicts += ConflictChecker::find_inter_of_lines(lines).has_value();
+    auto t_end = std::chrono::high_resolution_clock::now();
+    const double time_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+    WARN("find_inter_of_lines: " << time_ms / 20. << " ms per layer of "
+         << lines.size() << " lines, " << num_conflicts << " conflicts");
+    REQUIRE(num_conflicts == 0);
+}
+#endif // TEST_PERFORMANCE
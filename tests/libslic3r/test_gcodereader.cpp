@@ -0,0 +1,98 @@
+#include <catch2/catch_all.hpp>
+
+#include "libslic3r/GCodeReader.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include <chrono>
+#include <sstream>
+
+using namespace Slic3r;
+
+namespace {
+
+struct ParsedLine
+{
+    std::string raw;
+    float       reader_e;
+    float       x, y, e;
+    bool        has_x, has_y, has_e;
+
+    bool operator==(const ParsedLine &rhs) const {
+        return raw == rhs.raw && reader_e == rhs.reader_e && x == rhs.x && y == rhs.y && e == rhs.e &&
+               has_x == rhs.has_x && has_y == rhs.has_y && has_e == rhs.has_e;
+    }
+};
+
+GCodeReader::callback_t collect_lines(std::vector<ParsedLine> &out)
+{
+    return [&out](GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+        out.push_back({ line.raw(), reader.e(), line.x(), line.y(), line.e(), line.has_x(), line.has_y(), line.has_e() });
+    };
+}
+
+} // namespace
+
+TEST_CASE("Parallel G-code parsing matches serial parsing", "[GCodeReader]") {
+    const boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("gcodereader-%%%%-%%%%.gcode");
+    {
+        boost::nowide::ofstream f(path.string(), std::ios::binary);
+        f << "; generated by test\n\nM83\r\n";
+        // Spans multiple blocks read from the file.
+        for (int i = 0; i < 40000; ++ i)
+            f << "N" << i << " G1 X" << i * 0.01 << " Y" << (i % 100) << " E0.0" << (i % 7) << " ; move\n"
+              << (i % 3 == 0 ? "   G92 E0\r\n" : "G1 F3000\n");
+        // Last line not terminated by a newline.
+        f << "G1 X1 Y2 E3";
+    }
+
+    GCodeConfig config;
+    config.use_relative_e_distances.value = true;
+
+    std::vector<ParsedLine> serial, parallel;
+    std::vector<size_t>     serial_lines_ends, parallel_lines_ends;
+    {
+        GCodeReader reader;
+        reader.apply_config(config);
+        REQUIRE(reader.parse_file(path.string(), collect_lines(serial), serial_lines_ends));
+    }
+    {
+        GCodeReader reader;
+        reader.apply_config(config);
+        REQUIRE(reader.parse_file_parallel(path.string(), collect_lines(parallel), parallel_lines_ends));
+    }
+    boost::filesystem::remove(path);
+
+    REQUIRE(serial.size() == 80004);
+    REQUIRE(parallel.size() == serial.size());
+    CHECK(parallel == serial);
+    CHECK(parallel_lines_ends == serial_lines_ends);
+}
+
+TEST_CASE("G-code tokenizer throughput", "[GCodeReader][.benchmark]") {
+    // A G-code resembling the output of the slicer: short moves, long comments.
+    std::ostringstream ss;
+    for (int i = 0; i < 200000; ++ i) {
+        ss << "G1 X" << 100. + (i % 1000) * 0.013 << " Y" << 80. + (i % 777) * 0.021 << " E" << 0.0123 + (i % 13) * 0.001 << "\n";
+        if (i % 50 == 0)
+            ss << "; FEATURE: Outer wall\n;LAYER_CHANGE\n; WIDTH: 0.45 ; HEIGHT: 0.2, some more text to scan\nG1 F" << 1800 + i % 600 << "\n";
+    }
+    const std::string gcode = ss.str();
+
+    size_t num_moves = 0;
+    auto   parse     = [&gcode, &num_moves]() {
+        GCodeReader reader;
+        num_moves = 0;
+        reader.parse_buffer(gcode, [&num_moves](GCodeReader &, const GCodeReader::GCodeLine &line) { num_moves += line.has_x(); });
+        return num_moves;
+    };
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+    parse();
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t_start).count();
+    WARN("GCodeReader::parse_buffer(): " << double(gcode.size()) / (1024. * 1024.) / seconds << " MB/s");
+    REQUIRE(num_moves == 200000);
+
+    BENCHMARK("parse_buffer") { return parse(); };
+}
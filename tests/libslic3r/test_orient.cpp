@@ -0,0 +1,160 @@
+#include <catch2/catch_all.hpp>
+#include "test_utils.hpp"
+
+#include <libslic3r/Orient.hpp>
+
+#include <chrono>
+
+using namespace Slic3r;
+using namespace Slic3r::orientation;
+
+static const std::vector<std::string> orient_models = {
+    "20mm_cube.obj", "2x20x10.obj", "A.obj", "A_upsidedown.obj", "V.obj", "V_standing.obj", "bridge.obj",
+    "cube_with_concave_hole_enlarged_standing.obj", "extruder_idler.obj", "frog_legs.obj", "ipadstand.obj",
+    "overhang.obj", "pyramid.obj", "sloping_hole.obj", "two_hollow_squares.obj"};
+
+static OrientMeshs load_orient_meshes(size_t copies = 1)
+{
+    OrientMeshs meshes;
+    for (size_t i = 0; i < copies; ++i)
+        for (const std::string &name : orient_models) {
+            OrientMesh om;
+            om.mesh = load_model(name);
+            om.name = name;
+            meshes.emplace_back(std::move(om));
+        }
+    return meshes;
+}
+
+// A sphere with a box and a cylinder attached, about 400k facets
+static OrientMesh high_poly_mesh()
+{
+    indexed_triangle_set its  = its_make_sphere(10., 0.01);
+    indexed_triangle_set cube = its_make_cube(30., 8., 5.);
+    its_translate(cube, Vec3f(-5.f, -4.f, -14.f));
+    its_merge(its, cube);
+    indexed_triangle_set cylinder = its_make_cylinder(3., 15., 0.01);
+    its_translate(cylinder, Vec3f(6.f, 0.f, 0.f));
+    its_merge(its, cylinder);
+
+    OrientMesh om;
+    om.mesh = TriangleMesh(std::move(its));
+    om.mesh.rotate_x(0.7f);
+    om.mesh.rotate_y(0.3f);
+    om.name = "high poly";
+    return om;
+}
+
+static OrientMeshs oriented(OrientParams params, size_t copies = 1)
+{
+    OrientMeshs meshes = load_orient_meshes(copies);
+    orient(meshes, {}, params);
+    return meshes;
+}
+
+TEST_CASE("Parallel orientation gives the same result", "[Orient]")
+{
+    OrientParams params;
+    params.proxy_facets = 0;
+
+    params.parallel = false;
+    OrientMeshs sequential = oriented(params);
+
+    params.parallel = true;
+    OrientMeshs parallel = oriented(params);
+
+    REQUIRE(parallel.size() == sequential.size());
+    for (size_t i = 0; i < parallel.size(); ++i) {
+        INFO(parallel[i].name);
+        REQUIRE(parallel[i].orientation.isApprox(sequential[i].orientation));
+    }
+}
+
+TEST_CASE("Proxy mesh refining all candidates gives the full mesh result", "[Orient]")
+{
+    OrientParams params;
+    params.parallel     = true;
+    params.proxy_facets = 0;
+    OrientMeshs full    = oriented(params);
+
+    // Every candidate is scored on the full mesh again
+    params.proxy_facets       = 500;
+    params.proxy_refine_count = 1000;
+    OrientMeshs proxy         = oriented(params);
+
+    for (size_t i = 0; i < proxy.size(); ++i) {
+        INFO(proxy[i].name);
+        REQUIRE(proxy[i].orientation.isApprox(full[i].orientation));
+    }
+}
+
+TEST_CASE("Canceled orientation keeps the mesh", "[Orient]")
+{
+    OrientParams params;
+    params.parallel      = true;
+    params.proxy_facets  = 20000;
+    params.stopcondition = []() { return true; };
+
+    // Canceled in the decimation of the proxy mesh
+    OrientMeshs meshes{high_poly_mesh()};
+    REQUIRE_NOTHROW(orient(meshes, {}, params));
+    REQUIRE(meshes.front().orientation == Vec3d(0., 0., 1.));
+}
+
+#ifdef TEST_PERFORMANCE
+TEST_CASE("Orientation performance", "[Orient]")
+{
+    const size_t copies = 4;
+
+    OrientParams params;
+    params.proxy_facets = 0;
+    params.parallel     = false;
+
+    auto benchmark = [copies](const OrientParams &params, const char *label) {
+        auto t_start = std::chrono::high_resolution_clock::now();
+        OrientMeshs meshes = oriented(params, copies);
+        auto t_end = std::chrono::high_resolution_clock::now();
+        const double time_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+        WARN("Orienting " << meshes.size() << " objects " << label << ": " << time_ms << " ms");
+        return meshes;
+    };
+
+    OrientMeshs reference = benchmark(params, "sequentially");
+
+    params.parallel = true;
+    benchmark(params, "in parallel");
+
+    params.proxy_facets = 1000;
+    OrientMeshs proxy   = benchmark(params, "in parallel with proxy meshes");
+
+    size_t different = 0;
+    for (size_t i = 0; i < proxy.size(); ++i)
+        if (!proxy[i].orientation.isApprox(reference[i].orientation)) {
+            WARN("Proxy orientation of " << proxy[i].name << " differs: " << proxy[i].orientation.transpose() << " instead of "
+                                         << reference[i].orientation.transpose());
+            ++different;
+        }
+    WARN(different << " of " << proxy.size() << " orientations differ with proxy meshes");
+}
+
+TEST_CASE("Orientation performance of a high poly mesh", "[Orient]")
+{
+    auto benchmark = [](const OrientParams &params, const char *label) {
+        OrientMeshs meshes{high_poly_mesh()};
+        auto t_start = std::chrono::high_resolution_clock::now();
+        orient(meshes, {}, params);
+        auto t_end = std::chrono::high_resolution_clock::now();
+        const double time_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+        WARN("Orienting " << meshes.front().mesh.facets_count() << " facets " << label << ": " << time_ms << " ms");
+        return meshes.front().orientation;
+    };
+
+    OrientParams params;
+    params.parallel = false;
+    Vec3d full = benchmark(params, "with the default settings");
+
+    params.proxy_facets = 20000;
+    Vec3d proxy = benchmark(params, "on a proxy of 20000 facets");
+    REQUIRE(proxy.isApprox(full));
+}
+#endif // TEST_PERFORMANCE
@@ -2,6 +2,9 @@
 
 #include "libslic3r/Model.hpp"
 #include "libslic3r/Format/STL.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+
+#include <boost/filesystem/operations.hpp>
 
 using namespace Slic3r;
 
@@ -55,3 +58,29 @@ SCENARIO("Reading an STL file", "[stl]") {
 		}
 	}
 }
+
+SCENARIO("Reading a binary STL file spanning several read blocks", "[stl]") {
+	GIVEN("a sphere of more facets than two read blocks, not a multiple of the block size") {
+		TriangleMesh src(its_make_sphere(10., 2. * PI / 200.));
+		REQUIRE(src.its.indices.size() > 2 * 8192);
+		REQUIRE(src.its.indices.size() % 8192 != 0);
+		boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("stl-blocks-%%%%-%%%%.stl");
+		REQUIRE(src.write_binary(path.string().c_str()));
+		WHEN("STL file is read") {
+			TriangleMesh dst;
+			bool loaded = dst.ReadSTLFile(path.string().c_str(), false);
+			boost::filesystem::remove(path);
+			THEN("all facets are read back bit for bit in the original order") {
+				REQUIRE(loaded);
+				REQUIRE(dst.its.indices.size() == src.its.indices.size());
+				size_t mismatches = 0;
+				for (size_t i = 0; i < src.its.indices.size(); ++ i)
+					for (int j = 0; j < 3; ++ j)
+						if (dst.its.vertices[dst.its.indices[i](j)] != src.its.vertices[src.its.indices[i](j)])
+							++ mismatches;
+				REQUIRE(mismatches == 0);
+				REQUIRE(dst.its.vertices.size() == src.its.vertices.size());
+			}
+		}
+	}
+}
@@ -0,0 +1,193 @@
+#include <catch2/catch_all.hpp>
+
+#include "libvgcode/include/Viewer.hpp"
+#include "libvgcode/include/GCodeInputData.hpp"
+#include "libvgcode/include/PathVertex.hpp"
+
+#include <chrono>
+#include <cmath>
+
+using namespace libvgcode;
+
+// Circular perimeters of the layers [first_layer, last_layer), each one preceded by a travel move,
+// in the order the gcode processor would produce them.
+static std::vector<PathVertex> make_layers(uint32_t first_layer, uint32_t last_layer, size_t segments_per_layer)
+{
+    std::vector<PathVertex> out;
+    out.reserve((last_layer - first_layer) * (segments_per_layer + 1));
+    for (uint32_t layer_id = first_layer; layer_id < last_layer; ++layer_id) {
+        const float z = 0.2f * float(layer_id + 1);
+        PathVertex v;
+        v.height          = 0.2f;
+        v.width           = 0.45f;
+        v.feedrate        = 60.0f;
+        v.actual_feedrate = 55.0f;
+        v.fan_speed       = float(layer_id % 100);
+        v.temperature     = 210.0f;
+        v.layer_id        = layer_id;
+        v.times           = { 0.01f, 0.02f };
+
+        v.type     = EMoveType::Travel;
+        v.position = { 10.0f, 0.0f, z };
+        out.emplace_back(v);
+
+        v.type       = EMoveType::Extrude;
+        v.role       = (layer_id % 2 == 0) ? EGCodeExtrusionRole::ExternalPerimeter : EGCodeExtrusionRole::Perimeter;
+        v.mm3_per_mm = 0.05f + 0.001f * float(layer_id % 10);
+        for (size_t i = 1; i <= segments_per_layer; ++i) {
+            const float angle = 2.0f * float(M_PI) * float(i) / float(segments_per_layer);
+            v.position = { 10.0f * std::cos(angle), 10.0f * std::sin(angle), z };
+            out.emplace_back(v);
+        }
+    }
+    return out;
+}
+
+static void load_in_chunks(Viewer& viewer, uint32_t layers_count, uint32_t layers_per_chunk, size_t segments_per_layer)
+{
+    GCodeInputData data;
+    data.vertices = make_layers(0, std::min(layers_per_chunk, layers_count), segments_per_layer);
+    viewer.load(std::move(data));
+    viewer.reserve(size_t(layers_count) * (segments_per_layer + 1));
+    for (uint32_t layer_id = layers_per_chunk; layer_id < layers_count; layer_id += layers_per_chunk)
+        viewer.append(make_layers(layer_id, std::min(layer_id + layers_per_chunk, layers_count), segments_per_layer));
+}
+
+// The viewers are not initialized, so only the cpu side of the loading is exercised and no OpenGL context is needed.
+TEST_CASE("Toolpaths loaded in chunks of layers match the toolpaths loaded at once", "[libvgcode]")
+{
+    Viewer viewer;
+    GCodeInputData data;
+    data.vertices = make_layers(0, 30, 100);
+    viewer.load(std::move(data));
+
+    Viewer viewer_chunks;
+    load_in_chunks(viewer_chunks, 30, 7, 100);
+
+    REQUIRE(viewer_chunks.get_vertices_count() == viewer.get_vertices_count());
+    REQUIRE(viewer_chunks.get_layers_count() == 30);
+    REQUIRE(viewer_chunks.get_estimated_time() == Catch::Approx(viewer.get_estimated_time()));
+    REQUIRE(viewer_chunks.get_layers_estimated_times() == viewer.get_layers_estimated_times());
+    REQUIRE(viewer_chunks.get_extrusion_roles() == viewer.get_extrusion_roles());
+    REQUIRE(viewer_chunks.get_options() == viewer.get_options());
+    REQUIRE(viewer_chunks.get_view_full_range() == viewer.get_view_full_range());
+    for (size_t i = 0; i < viewer.get_vertices_count(); ++i)
+        REQUIRE(viewer_chunks.get_vertex_at(i).layer_duration == viewer.get_vertex_at(i).layer_duration);
+}
+
+TEST_CASE("Quantized toolpaths match the float toolpaths", "[libvgcode]")
+{
+    Viewer viewer;
+    load_in_chunks(viewer, 30, 7, 100);
+
+    Viewer viewer_quantized;
+    viewer_quantized.set_vertices_encoding(EVerticesEncoding::Quantized);
+    load_in_chunks(viewer_quantized, 30, 7, 100);
+    REQUIRE(viewer_quantized.get_vertices_encoding() == EVerticesEncoding::Quantized);
+
+    REQUIRE(viewer_quantized.get_vertices_count() == viewer.get_vertices_count());
+    REQUIRE(viewer_quantized.get_layers_count() == viewer.get_layers_count());
+    REQUIRE(viewer_quantized.get_estimated_time() == Catch::Approx(viewer.get_estimated_time()));
+    REQUIRE(viewer_quantized.get_extrusion_roles() == viewer.get_extrusion_roles());
+    REQUIRE(viewer_quantized.get_options() == viewer.get_options());
+    REQUIRE(viewer_quantized.get_view_full_range() == viewer.get_view_full_range());
+
+    // blocks spanning less than 64 mm are stored on a grid of 1/1024 mm
+    const float position_tolerance = 0.5f / 1024.0f + 1e-5f;
+    for (size_t i = 0; i < viewer.get_vertices_count(); ++i) {
+        const PathVertex v = viewer.get_vertex_at(i);
+        const PathVertex q = viewer_quantized.get_vertex_at(i);
+        for (size_t c = 0; c < 3; ++c) {
+            REQUIRE(std::abs(q.position[c] - v.position[c]) <= position_tolerance);
+        }
+        REQUIRE(q.height == Catch::Approx(v.height));
+        REQUIRE(q.width == Catch::Approx(v.width));
+        REQUIRE(q.feedrate == Catch::Approx(v.feedrate));
+        REQUIRE(q.mm3_per_mm == Catch::Approx(v.mm3_per_mm).margin(1e-6));
+        REQUIRE(q.fan_speed == Catch::Approx(v.fan_speed).margin(1e-3));
+        REQUIRE(q.times[0] == Catch::Approx(v.times[0]));
+        REQUIRE(q.layer_duration == v.layer_duration);
+        REQUIRE(q.layer_id == v.layer_id);
+        REQUIRE(q.type == v.type);
+        REQUIRE(q.role == v.role);
+    }
+
+    const size_t memory = viewer.get_used_cpu_memory();
+    const size_t memory_quantized = viewer_quantized.get_used_cpu_memory();
+    WARN("Viewer cpu memory of " << viewer.get_vertices_count() << " vertices: float " << memory << " bytes, quantized "
+         << memory_quantized << " bytes");
+    REQUIRE(memory_quantized < memory * 2 / 3);
+}
+
+TEST_CASE("Quantized toolpaths keep the accuracy of attributes spanning a wide range within a block", "[libvgcode]")
+{
+    // The first block mixes short moves with a long dwell, slow with rapid moves and thin with thick extrusions,
+    // the second block contains a single outlier.
+    std::vector<PathVertex> vertices = make_layers(0, 3, 200);
+    for (size_t i = 0; i < 256; ++i) {
+        PathVertex& v = vertices[i];
+        // the small values differ, otherwise they would all be decoded exactly as the minimum of the block
+        const bool small = i % 2 == 0;
+        const float f = float(1 + i % 10);
+        v.times           = small ? std::array<float, TIME_MODES_COUNT>{ 0.001f * f, 0.002f * f } : std::array<float, TIME_MODES_COUNT>{ 3600.0f, 7200.0f };
+        v.feedrate        = small ? f : 100000.0f;
+        v.actual_feedrate = small ? 0.5f * f : 50000.0f;
+        v.mm3_per_mm      = small ? 0.0001f * f : 50.0f;
+        v.width           = small ? 0.01f * f : 100.0f;
+    }
+    vertices[300].times = { 86400.0f, 86400.0f };
+    vertices[301].feedrate = 0.01f;
+
+    Viewer viewer;
+    GCodeInputData data;
+    data.vertices = vertices;
+    viewer.load(std::move(data));
+
+    Viewer viewer_quantized;
+    viewer_quantized.set_vertices_encoding(EVerticesEncoding::Quantized);
+    GCodeInputData data_quantized;
+    data_quantized.vertices = vertices;
+    viewer_quantized.load(std::move(data_quantized));
+
+    REQUIRE(viewer_quantized.get_vertices_count() == viewer.get_vertices_count());
+    REQUIRE(viewer_quantized.get_estimated_time() == Catch::Approx(viewer.get_estimated_time()).epsilon(1e-6));
+    auto approx = [](float value) { return Catch::Approx(value).epsilon(1e-3).margin(1e-6); };
+    for (size_t i = 0; i < viewer.get_vertices_count(); ++i) {
+        const PathVertex v = viewer.get_vertex_at(i);
+        const PathVertex q = viewer_quantized.get_vertex_at(i);
+        REQUIRE(q.times[0] == approx(v.times[0]));
+        REQUIRE(q.times[1] == approx(v.times[1]));
+        REQUIRE(q.feedrate == approx(v.feedrate));
+        REQUIRE(q.actual_feedrate == approx(v.actual_feedrate));
+        REQUIRE(q.mm3_per_mm == approx(v.mm3_per_mm));
+        REQUIRE(q.width == approx(v.width));
+        REQUIRE(q.height == approx(v.height));
+        REQUIRE(q.fan_speed == approx(v.fan_speed));
+    }
+}
+
+#ifdef TEST_PERFORMANCE
+TEST_CASE("Toolpaths loading performance", "[libvgcode]")
+{
+    // about 10M vertices, as for a large gcode file
+    const uint32_t layers_count       = 1000;
+    const size_t   segments_per_layer = 10000;
+
+    auto benchmark = [&](uint32_t layers_per_chunk, EVerticesEncoding encoding) {
+        Viewer viewer;
+        viewer.set_vertices_encoding(encoding);
+        auto t_start = std::chrono::high_resolution_clock::now();
+        load_in_chunks(viewer, layers_count, layers_per_chunk, segments_per_layer);
+        auto t_end = std::chrono::high_resolution_clock::now();
+        const double time_ms = std::chrono::duration<double, std::milli>(t_end - t_start).count();
+        WARN("Loading " << viewer.get_vertices_count() << " vertices in chunks of " << layers_per_chunk << " layers"
+             << ((encoding == EVerticesEncoding::Quantized) ? " (quantized): " : ": ") << time_ms << " ms, viewer cpu memory "
+             << viewer.get_used_cpu_memory() / (1024 * 1024) << " MB");
+        REQUIRE(viewer.get_layers_count() == layers_count);
+    };
+
+    benchmark(layers_count, EVerticesEncoding::Float);
+    benchmark(50, EVerticesEncoding::Float);
+    benchmark(50, EVerticesEncoding::Quantized);
+}
+#endif // TEST_PERFORMANCE